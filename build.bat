@@ -11,6 +11,11 @@ preprocessor.exe ..\tokeniser.h >> ..\generation\generated.h
 preprocessor.exe ..\typing.h >> ..\generation\generated.h
 cl %CommonCompilerFlags% ..\main.cpp %CommonLinkerFlags%
 
+rem the stubs are read relative to where main runs from
+pushd ".."
+build\main.exe --write-snapshot
+popd
+
 IF (%1 == "test") (
         cl %CommonCompilerFlags% ..\tests.cpp %CommonLinkerFlags%
 )
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diagnostics.h"
+
+Diagnostics *Diagnostics::create(Arena *arena, uint32_t max_errors)
+{
+        Diagnostics *diagnostics =
+                (Diagnostics *)arena->alloc(sizeof(*diagnostics));
+        new (diagnostics) Diagnostics();
+
+        diagnostics->entries = Arena::init(MEGABYTES(64));
+        diagnostics->max_errors = max_errors;
+        InitializeSRWLock(&diagnostics->lock);
+
+        return diagnostics;
+}
+
+static int diagnostic_compare(const void *a, const void *b)
+{
+        const Diagnostic *lhs = (const Diagnostic *)a;
+        const Diagnostic *rhs = (const Diagnostic *)b;
+
+        int file_order = strcmp(lhs->filename, rhs->filename);
+        if (file_order != 0)
+                return file_order;
+        if (lhs->line != rhs->line)
+                return lhs->line < rhs->line ? -1 : 1;
+        if (lhs->column != rhs->column)
+                return lhs->column < rhs->column ? -1 : 1;
+
+        return 0;
+}
+
+void Diagnostics::report(const char *filename, uint32_t line, uint32_t column,
+                         const char *message)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        if (this->stopped) {
+                ReleaseSRWLockExclusive(&this->lock);
+                return;
+        }
+
+        Diagnostic *diagnostic =
+                (Diagnostic *)this->entries.alloc(sizeof(*diagnostic));
+        diagnostic->filename = filename ? filename : "";
+        diagnostic->line = line;
+        diagnostic->column = column;
+        snprintf(diagnostic->message, sizeof(diagnostic->message), "%s",
+                 message);
+
+        // some nodes are typed more than once, a capped sink holds at most
+        // max_errors entries so looking for the same one is cheap
+        if (this->max_errors) {
+                Diagnostic *list = (Diagnostic *)this->entries.memory;
+                for (uint32_t i = 0; i < this->count; ++i) {
+                        if (diagnostic_compare(&list[i], diagnostic) == 0 &&
+                            strcmp(list[i].message, diagnostic->message) == 0) {
+                                this->entries.offset -= sizeof(*diagnostic);
+                                ReleaseSRWLockExclusive(&this->lock);
+                                return;
+                        }
+                }
+        }
+
+        ++this->count;
+        if (this->max_errors && this->count >= this->max_errors) {
+                this->stopped = true;
+        }
+
+        ReleaseSRWLockExclusive(&this->lock);
+}
+
+void Diagnostics::merge(Diagnostics *other)
+{
+        Diagnostic *list = (Diagnostic *)other->entries.memory;
+        for (uint32_t i = 0; i < other->count; ++i) {
+                this->report(list[i].filename, list[i].line, list[i].column,
+                             list[i].message);
+        }
+
+        other->entries.offset = 0;
+        other->count = 0;
+}
+
+void Diagnostics::remove_file(const char *filename)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        Diagnostic *list = (Diagnostic *)this->entries.memory;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < this->count; ++i) {
+                if (list[i].filename != filename) {
+                        list[kept++] = list[i];
+                }
+        }
+
+        this->count = kept;
+        this->entries.offset = kept * sizeof(Diagnostic);
+
+        ReleaseSRWLockExclusive(&this->lock);
+}
+
+void Diagnostics::remove_reported(Diagnostic *list, uint32_t count)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        Diagnostic *entries = (Diagnostic *)this->entries.memory;
+        for (uint32_t i = 0; i < count; ++i) {
+                for (uint32_t j = 0; j < this->count; ++j) {
+                        if (entries[j].filename == list[i].filename &&
+                            diagnostic_compare(&entries[j], &list[i]) == 0 &&
+                            strcmp(entries[j].message, list[i].message) == 0) {
+                                entries[j] = entries[--this->count];
+                                break;
+                        }
+                }
+        }
+
+        this->entries.offset = this->count * sizeof(Diagnostic);
+
+        ReleaseSRWLockExclusive(&this->lock);
+}
+
+uint32_t Diagnostics::print(FILE *stream)
+{
+        Diagnostic *list = (Diagnostic *)this->entries.memory;
+        qsort(list, this->count, sizeof(*list), diagnostic_compare);
+
+        uint32_t printed = 0;
+        for (uint32_t i = 0; i < this->count; ++i) {
+                // some nodes are typed more than once, only report an error
+                // at a location once
+                if (i > 0 && diagnostic_compare(&list[i - 1], &list[i]) == 0 &&
+                    strcmp(list[i - 1].message, list[i].message) == 0) {
+                        continue;
+                }
+
+                fprintf(stream, "File: %s, TypeError: line: %d, col: %d\n%s\n",
+                        list[i].filename, list[i].line, list[i].column,
+                        list[i].message);
+                ++printed;
+        }
+
+        return printed;
+}
+
+void Diagnostics::destroy()
+{
+        this->entries.destroy();
+}
@@ -0,0 +1,56 @@
+#ifndef DIAGNOSTICS_H_
+#define DIAGNOSTICS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "utils.h"
+
+#define DIAGNOSTIC_MESSAGE_SIZE 512
+#define DEFAULT_MAX_ERRORS 100
+
+struct Diagnostic {
+        // points at the module's filename which outlives the diagnostics
+        const char *filename;
+        uint32_t line;
+        uint32_t column;
+        char message[DIAGNOSTIC_MESSAGE_SIZE];
+};
+
+// Type errors are recorded here instead of exiting so a single run reports
+// every error it can find. The node that failed is typed as ANY so checking
+// carries on without cascading errors from the same mistake
+struct Diagnostics {
+        // contiguous array of Diagnostic
+        Arena entries;
+        uint32_t count;
+        // 0 means no cap, with one an error already reported at the same
+        // place isn't kept so count is the number of distinct errors
+        uint32_t max_errors;
+        // set once the cap is reached, later reports are dropped and the
+        // driver prints what was found and exits
+        volatile bool stopped;
+        // type workers on every thread report into the same sink
+        SRWLOCK lock;
+
+        static Diagnostics *create(Arena *arena, uint32_t max_errors);
+        void report(const char *filename, uint32_t line, uint32_t column,
+                    const char *message);
+        // moves everything other has into this one, other is left empty
+        void merge(Diagnostics *other);
+        // drops everything reported against filename, compared by pointer
+        void remove_file(const char *filename);
+        // drops one entry for each of list, e.g. what one function body
+        // reported before it's typed again
+        void remove_reported(Diagnostic *list, uint32_t count);
+        // sorts by file, line then column so output doesn't depend on which
+        // thread got to a module first, returns the number printed
+        uint32_t print(FILE *stream);
+        void destroy();
+};
+
+#endif // DIAGNOSTICS_H_
@@ -44,57 +44,233 @@ EnumMemberDefinition  AstNodeTypeEnumMembers[] =
 {"LAMBDA", 42},
 {"TYPE_PARAM", 43},
 {"INVALID", 44},
+{"KWARG", 45},
 };
+static void serialize_AstNodeType(Serializer *serializer, AstNodeType *value)
+{
+        uint8_t raw = (uint8_t)*value;
+        serialize_uint8_t(serializer, &raw);
+}
+static void deserialize_AstNodeType(Deserializer *deserializer, AstNodeType *value)
+{
+        uint8_t raw = 0;
+        deserialize_uint8_t(deserializer, &raw);
+        if (raw > 45)
+                deserializer->failed = true;
+        *value = (AstNodeType)raw;
+}
 StructMemberDefinition AstNodeUnaryStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "child", (uint64_t)&((AstNodeUnary *)0)->child},
 };
+static void serialize_AstNodeUnary(Serializer *serializer, AstNodeUnary *value)
+{
+        serialize_AstNode_PTR(serializer, &value->child);
+}
+static void deserialize_AstNodeUnary(Deserializer *deserializer, AstNodeUnary *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->child);
+}
+uint16_t AstNodeUnaryChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeUnary *)0)->child,
+};
+StructMemberDefinition AstNodeIdentifierStructMembers[] = 
+{
+{TYPE_SymbolTableEntry_PTR, "symbol", (uint64_t)&((AstNodeIdentifier *)0)->symbol},
+};
+static void serialize_AstNodeIdentifier(Serializer *serializer, AstNodeIdentifier *value)
+{
+        serialize_SymbolTableEntry_PTR(serializer, &value->symbol);
+}
+static void deserialize_AstNodeIdentifier(Deserializer *deserializer, AstNodeIdentifier *value)
+{
+        deserialize_SymbolTableEntry_PTR(deserializer, &value->symbol);
+}
 StructMemberDefinition AstNodeNaryStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeNary *)0)->children},
 };
+static void serialize_AstNodeNary(Serializer *serializer, AstNodeNary *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeNary(Deserializer *deserializer, AstNodeNary *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeNaryChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeNary *)0)->children,
+};
 StructMemberDefinition AstNodeBinaryExprStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "left", (uint64_t)&((AstNodeBinaryExpr *)0)->left},
 {TYPE_AstNode_PTR, "right", (uint64_t)&((AstNodeBinaryExpr *)0)->right},
 };
+static void serialize_AstNodeBinaryExpr(Serializer *serializer, AstNodeBinaryExpr *value)
+{
+        serialize_AstNode_PTR(serializer, &value->left);
+        serialize_AstNode_PTR(serializer, &value->right);
+}
+static void deserialize_AstNodeBinaryExpr(Deserializer *deserializer, AstNodeBinaryExpr *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->left);
+        deserialize_AstNode_PTR(deserializer, &value->right);
+}
+uint16_t AstNodeBinaryExprChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeBinaryExpr *)0)->left,
+(uint16_t)(uint64_t)&((AstNodeBinaryExpr *)0)->right,
+};
 StructMemberDefinition AstNodeAssignmentStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "left", (uint64_t)&((AstNodeAssignment *)0)->left},
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeAssignment *)0)->expression},
 };
+static void serialize_AstNodeAssignment(Serializer *serializer, AstNodeAssignment *value)
+{
+        serialize_AstNode_PTR(serializer, &value->left);
+        serialize_AstNode_PTR(serializer, &value->expression);
+}
+static void deserialize_AstNodeAssignment(Deserializer *deserializer, AstNodeAssignment *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->left);
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+}
+uint16_t AstNodeAssignmentChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeAssignment *)0)->left,
+(uint16_t)(uint64_t)&((AstNodeAssignment *)0)->expression,
+};
 StructMemberDefinition AstNodeDeclarationStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "name", (uint64_t)&((AstNodeDeclaration *)0)->name},
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeDeclaration *)0)->expression},
 {TYPE_AstNode_PTR, "annotation", (uint64_t)&((AstNodeDeclaration *)0)->annotation},
 };
+static void serialize_AstNodeDeclaration(Serializer *serializer, AstNodeDeclaration *value)
+{
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->annotation);
+}
+static void deserialize_AstNodeDeclaration(Deserializer *deserializer, AstNodeDeclaration *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->annotation);
+}
+uint16_t AstNodeDeclarationChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeDeclaration *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeDeclaration *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeDeclaration *)0)->annotation,
+};
 StructMemberDefinition AstNodeTypeAnnotStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "type", (uint64_t)&((AstNodeTypeAnnot *)0)->type},
 {TYPE_AstNode_PTR, "parameters", (uint64_t)&((AstNodeTypeAnnot *)0)->parameters},
 };
+static void serialize_AstNodeTypeAnnot(Serializer *serializer, AstNodeTypeAnnot *value)
+{
+        serialize_AstNode_PTR(serializer, &value->type);
+        serialize_AstNode_PTR(serializer, &value->parameters);
+}
+static void deserialize_AstNodeTypeAnnot(Deserializer *deserializer, AstNodeTypeAnnot *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->type);
+        deserialize_AstNode_PTR(deserializer, &value->parameters);
+}
+uint16_t AstNodeTypeAnnotChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeTypeAnnot *)0)->type,
+(uint16_t)(uint64_t)&((AstNodeTypeAnnot *)0)->parameters,
+};
 StructMemberDefinition AstNodeUnionStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "left", (uint64_t)&((AstNodeUnion *)0)->left},
 {TYPE_AstNode_PTR, "right", (uint64_t)&((AstNodeUnion *)0)->right},
 };
+static void serialize_AstNodeUnion(Serializer *serializer, AstNodeUnion *value)
+{
+        serialize_AstNode_PTR(serializer, &value->left);
+        serialize_AstNode_PTR(serializer, &value->right);
+}
+static void deserialize_AstNodeUnion(Deserializer *deserializer, AstNodeUnion *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->left);
+        deserialize_AstNode_PTR(deserializer, &value->right);
+}
+uint16_t AstNodeUnionChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeUnion *)0)->left,
+(uint16_t)(uint64_t)&((AstNodeUnion *)0)->right,
+};
 StructMemberDefinition AstNodeIfStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "condition", (uint64_t)&((AstNodeIf *)0)->condition},
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeIf *)0)->block},
 {TYPE_AstNode_PTR, "or_else", (uint64_t)&((AstNodeIf *)0)->or_else},
 };
+static void serialize_AstNodeIf(Serializer *serializer, AstNodeIf *value)
+{
+        serialize_AstNode_PTR(serializer, &value->condition);
+        serialize_AstNode_PTR(serializer, &value->block);
+        serialize_AstNode_PTR(serializer, &value->or_else);
+}
+static void deserialize_AstNodeIf(Deserializer *deserializer, AstNodeIf *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->condition);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+        deserialize_AstNode_PTR(deserializer, &value->or_else);
+}
+uint16_t AstNodeIfChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeIf *)0)->condition,
+(uint16_t)(uint64_t)&((AstNodeIf *)0)->block,
+(uint16_t)(uint64_t)&((AstNodeIf *)0)->or_else,
+};
 StructMemberDefinition AstNodeIfExprStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "true_expression", (uint64_t)&((AstNodeIfExpr *)0)->true_expression},
 {TYPE_AstNode_PTR, "condition", (uint64_t)&((AstNodeIfExpr *)0)->condition},
 {TYPE_AstNode_PTR, "false_expression", (uint64_t)&((AstNodeIfExpr *)0)->false_expression},
 };
+static void serialize_AstNodeIfExpr(Serializer *serializer, AstNodeIfExpr *value)
+{
+        serialize_AstNode_PTR(serializer, &value->true_expression);
+        serialize_AstNode_PTR(serializer, &value->condition);
+        serialize_AstNode_PTR(serializer, &value->false_expression);
+}
+static void deserialize_AstNodeIfExpr(Deserializer *deserializer, AstNodeIfExpr *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->true_expression);
+        deserialize_AstNode_PTR(deserializer, &value->condition);
+        deserialize_AstNode_PTR(deserializer, &value->false_expression);
+}
+uint16_t AstNodeIfExprChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeIfExpr *)0)->true_expression,
+(uint16_t)(uint64_t)&((AstNodeIfExpr *)0)->condition,
+(uint16_t)(uint64_t)&((AstNodeIfExpr *)0)->false_expression,
+};
 StructMemberDefinition AstNodeElseStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeElse *)0)->block},
 };
+static void serialize_AstNodeElse(Serializer *serializer, AstNodeElse *value)
+{
+        serialize_AstNode_PTR(serializer, &value->block);
+}
+static void deserialize_AstNodeElse(Deserializer *deserializer, AstNodeElse *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->block);
+}
+uint16_t AstNodeElseChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeElse *)0)->block,
+};
 StructMemberDefinition AstNodeForLoopStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "targets", (uint64_t)&((AstNodeForLoop *)0)->targets},
@@ -102,18 +278,75 @@ StructMemberDefinition AstNodeForLoopStructMembers[] =
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeForLoop *)0)->block},
 {TYPE_AstNode_PTR, "or_else", (uint64_t)&((AstNodeForLoop *)0)->or_else},
 };
+static void serialize_AstNodeForLoop(Serializer *serializer, AstNodeForLoop *value)
+{
+        serialize_AstNode_PTR(serializer, &value->targets);
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->block);
+        serialize_AstNode_PTR(serializer, &value->or_else);
+}
+static void deserialize_AstNodeForLoop(Deserializer *deserializer, AstNodeForLoop *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->targets);
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+        deserialize_AstNode_PTR(deserializer, &value->or_else);
+}
+uint16_t AstNodeForLoopChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeForLoop *)0)->targets,
+(uint16_t)(uint64_t)&((AstNodeForLoop *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeForLoop *)0)->block,
+(uint16_t)(uint64_t)&((AstNodeForLoop *)0)->or_else,
+};
 StructMemberDefinition AstNodeForIfClauseStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "targets", (uint64_t)&((AstNodeForIfClause *)0)->targets},
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeForIfClause *)0)->expression},
 {TYPE_AstNode_PTR, "if_clause", (uint64_t)&((AstNodeForIfClause *)0)->if_clause},
 };
+static void serialize_AstNodeForIfClause(Serializer *serializer, AstNodeForIfClause *value)
+{
+        serialize_AstNode_PTR(serializer, &value->targets);
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->if_clause);
+}
+static void deserialize_AstNodeForIfClause(Deserializer *deserializer, AstNodeForIfClause *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->targets);
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->if_clause);
+}
+uint16_t AstNodeForIfClauseChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeForIfClause *)0)->targets,
+(uint16_t)(uint64_t)&((AstNodeForIfClause *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeForIfClause *)0)->if_clause,
+};
 StructMemberDefinition AstNodeWhileStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "condition", (uint64_t)&((AstNodeWhile *)0)->condition},
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeWhile *)0)->block},
 {TYPE_AstNode_PTR, "or_else", (uint64_t)&((AstNodeWhile *)0)->or_else},
 };
+static void serialize_AstNodeWhile(Serializer *serializer, AstNodeWhile *value)
+{
+        serialize_AstNode_PTR(serializer, &value->condition);
+        serialize_AstNode_PTR(serializer, &value->block);
+        serialize_AstNode_PTR(serializer, &value->or_else);
+}
+static void deserialize_AstNodeWhile(Deserializer *deserializer, AstNodeWhile *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->condition);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+        deserialize_AstNode_PTR(deserializer, &value->or_else);
+}
+uint16_t AstNodeWhileChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeWhile *)0)->condition,
+(uint16_t)(uint64_t)&((AstNodeWhile *)0)->block,
+(uint16_t)(uint64_t)&((AstNodeWhile *)0)->or_else,
+};
 StructMemberDefinition AstNodeTypeParamStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "name", (uint64_t)&((AstNodeTypeParam *)0)->name},
@@ -121,6 +354,25 @@ StructMemberDefinition AstNodeTypeParamStructMembers[] =
 {TYPE_bool, "star", (uint64_t)&((AstNodeTypeParam *)0)->star},
 {TYPE_bool, "double_star", (uint64_t)&((AstNodeTypeParam *)0)->double_star},
 };
+static void serialize_AstNodeTypeParam(Serializer *serializer, AstNodeTypeParam *value)
+{
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->bound);
+        serialize_bool(serializer, &value->star);
+        serialize_bool(serializer, &value->double_star);
+}
+static void deserialize_AstNodeTypeParam(Deserializer *deserializer, AstNodeTypeParam *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->bound);
+        deserialize_bool(deserializer, &value->star);
+        deserialize_bool(deserializer, &value->double_star);
+}
+uint16_t AstNodeTypeParamChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeTypeParam *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeTypeParam *)0)->bound,
+};
 StructMemberDefinition AstNodeClassDefStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "decarators", (uint64_t)&((AstNodeClassDef *)0)->decarators},
@@ -129,6 +381,30 @@ StructMemberDefinition AstNodeClassDefStructMembers[] =
 {TYPE_AstNode_PTR, "arguments", (uint64_t)&((AstNodeClassDef *)0)->arguments},
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeClassDef *)0)->block},
 };
+static void serialize_AstNodeClassDef(Serializer *serializer, AstNodeClassDef *value)
+{
+        serialize_AstNode_PTR(serializer, &value->decarators);
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->type_params);
+        serialize_AstNode_PTR(serializer, &value->arguments);
+        serialize_AstNode_PTR(serializer, &value->block);
+}
+static void deserialize_AstNodeClassDef(Deserializer *deserializer, AstNodeClassDef *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->decarators);
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->type_params);
+        deserialize_AstNode_PTR(deserializer, &value->arguments);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+}
+uint16_t AstNodeClassDefChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeClassDef *)0)->decarators,
+(uint16_t)(uint64_t)&((AstNodeClassDef *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeClassDef *)0)->type_params,
+(uint16_t)(uint64_t)&((AstNodeClassDef *)0)->arguments,
+(uint16_t)(uint64_t)&((AstNodeClassDef *)0)->block,
+};
 StructMemberDefinition AstNodeFunctionDefStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "decarators", (uint64_t)&((AstNodeFunctionDef *)0)->decarators},
@@ -142,6 +418,43 @@ StructMemberDefinition AstNodeFunctionDefStructMembers[] =
 {TYPE_int, "star_pos", (uint64_t)&((AstNodeFunctionDef *)0)->star_pos},
 {TYPE_int, "slash_pos", (uint64_t)&((AstNodeFunctionDef *)0)->slash_pos},
 };
+static void serialize_AstNodeFunctionDef(Serializer *serializer, AstNodeFunctionDef *value)
+{
+        serialize_AstNode_PTR(serializer, &value->decarators);
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->type_params);
+        serialize_AstNode_PTR(serializer, &value->arguments);
+        serialize_AstNode_PTR(serializer, &value->block);
+        serialize_AstNode_PTR(serializer, &value->star);
+        serialize_AstNode_PTR(serializer, &value->double_star);
+        serialize_AstNode_PTR(serializer, &value->return_type);
+        serialize_int(serializer, &value->star_pos);
+        serialize_int(serializer, &value->slash_pos);
+}
+static void deserialize_AstNodeFunctionDef(Deserializer *deserializer, AstNodeFunctionDef *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->decarators);
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->type_params);
+        deserialize_AstNode_PTR(deserializer, &value->arguments);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+        deserialize_AstNode_PTR(deserializer, &value->star);
+        deserialize_AstNode_PTR(deserializer, &value->double_star);
+        deserialize_AstNode_PTR(deserializer, &value->return_type);
+        deserialize_int(deserializer, &value->star_pos);
+        deserialize_int(deserializer, &value->slash_pos);
+}
+uint16_t AstNodeFunctionDefChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->decarators,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->type_params,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->arguments,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->block,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->star,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->double_star,
+(uint16_t)(uint64_t)&((AstNodeFunctionDef *)0)->return_type,
+};
 StructMemberDefinition AstNodeLambdaDefStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "arguments", (uint64_t)&((AstNodeLambdaDef *)0)->arguments},
@@ -149,26 +462,107 @@ StructMemberDefinition AstNodeLambdaDefStructMembers[] =
 {TYPE_AstNode_PTR, "star", (uint64_t)&((AstNodeLambdaDef *)0)->star},
 {TYPE_AstNode_PTR, "double_star", (uint64_t)&((AstNodeLambdaDef *)0)->double_star},
 };
+static void serialize_AstNodeLambdaDef(Serializer *serializer, AstNodeLambdaDef *value)
+{
+        serialize_AstNode_PTR(serializer, &value->arguments);
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->star);
+        serialize_AstNode_PTR(serializer, &value->double_star);
+}
+static void deserialize_AstNodeLambdaDef(Deserializer *deserializer, AstNodeLambdaDef *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->arguments);
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->star);
+        deserialize_AstNode_PTR(deserializer, &value->double_star);
+}
+uint16_t AstNodeLambdaDefChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeLambdaDef *)0)->arguments,
+(uint16_t)(uint64_t)&((AstNodeLambdaDef *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeLambdaDef *)0)->star,
+(uint16_t)(uint64_t)&((AstNodeLambdaDef *)0)->double_star,
+};
 StructMemberDefinition AstNodeFunctionCallStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeFunctionCall *)0)->expression},
 {TYPE_AstNode_PTR, "args", (uint64_t)&((AstNodeFunctionCall *)0)->args},
 };
+static void serialize_AstNodeFunctionCall(Serializer *serializer, AstNodeFunctionCall *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->args);
+}
+static void deserialize_AstNodeFunctionCall(Deserializer *deserializer, AstNodeFunctionCall *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->args);
+}
+uint16_t AstNodeFunctionCallChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeFunctionCall *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeFunctionCall *)0)->args,
+};
 StructMemberDefinition AstNodeKwargStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "name", (uint64_t)&((AstNodeKwarg *)0)->name},
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeKwarg *)0)->expression},
 };
+static void serialize_AstNodeKwarg(Serializer *serializer, AstNodeKwarg *value)
+{
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->expression);
+}
+static void deserialize_AstNodeKwarg(Deserializer *deserializer, AstNodeKwarg *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+}
+uint16_t AstNodeKwargChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeKwarg *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeKwarg *)0)->expression,
+};
 StructMemberDefinition AstNodeKvPairStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "key", (uint64_t)&((AstNodeKvPair *)0)->key},
 {TYPE_AstNode_PTR, "value", (uint64_t)&((AstNodeKvPair *)0)->value},
 };
+static void serialize_AstNodeKvPair(Serializer *serializer, AstNodeKvPair *value)
+{
+        serialize_AstNode_PTR(serializer, &value->key);
+        serialize_AstNode_PTR(serializer, &value->value);
+}
+static void deserialize_AstNodeKvPair(Deserializer *deserializer, AstNodeKvPair *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->key);
+        deserialize_AstNode_PTR(deserializer, &value->value);
+}
+uint16_t AstNodeKvPairChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeKvPair *)0)->key,
+(uint16_t)(uint64_t)&((AstNodeKvPair *)0)->value,
+};
 StructMemberDefinition AstNodeSubscriptStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeSubscript *)0)->expression},
 {TYPE_AstNode_PTR, "slices", (uint64_t)&((AstNodeSubscript *)0)->slices},
 };
+static void serialize_AstNodeSubscript(Serializer *serializer, AstNodeSubscript *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->slices);
+}
+static void deserialize_AstNodeSubscript(Deserializer *deserializer, AstNodeSubscript *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->slices);
+}
+uint16_t AstNodeSubscriptChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeSubscript *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeSubscript *)0)->slices,
+};
 StructMemberDefinition AstNodeSliceStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "start", (uint64_t)&((AstNodeSlice *)0)->start},
@@ -176,6 +570,27 @@ StructMemberDefinition AstNodeSliceStructMembers[] =
 {TYPE_AstNode_PTR, "step", (uint64_t)&((AstNodeSlice *)0)->step},
 {TYPE_AstNode_PTR, "named_expr", (uint64_t)&((AstNodeSlice *)0)->named_expr},
 };
+static void serialize_AstNodeSlice(Serializer *serializer, AstNodeSlice *value)
+{
+        serialize_AstNode_PTR(serializer, &value->start);
+        serialize_AstNode_PTR(serializer, &value->end);
+        serialize_AstNode_PTR(serializer, &value->step);
+        serialize_AstNode_PTR(serializer, &value->named_expr);
+}
+static void deserialize_AstNodeSlice(Deserializer *deserializer, AstNodeSlice *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->start);
+        deserialize_AstNode_PTR(deserializer, &value->end);
+        deserialize_AstNode_PTR(deserializer, &value->step);
+        deserialize_AstNode_PTR(deserializer, &value->named_expr);
+}
+uint16_t AstNodeSliceChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeSlice *)0)->start,
+(uint16_t)(uint64_t)&((AstNodeSlice *)0)->end,
+(uint16_t)(uint64_t)&((AstNodeSlice *)0)->step,
+(uint16_t)(uint64_t)&((AstNodeSlice *)0)->named_expr,
+};
 StructMemberDefinition AstNodeTryStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeTry *)0)->block},
@@ -183,91 +598,687 @@ StructMemberDefinition AstNodeTryStructMembers[] =
 {TYPE_AstNode_PTR, "or_else", (uint64_t)&((AstNodeTry *)0)->or_else},
 {TYPE_AstNode_PTR, "finally", (uint64_t)&((AstNodeTry *)0)->finally},
 };
+static void serialize_AstNodeTry(Serializer *serializer, AstNodeTry *value)
+{
+        serialize_AstNode_PTR(serializer, &value->block);
+        serialize_AstNode_PTR(serializer, &value->handlers);
+        serialize_AstNode_PTR(serializer, &value->or_else);
+        serialize_AstNode_PTR(serializer, &value->finally);
+}
+static void deserialize_AstNodeTry(Deserializer *deserializer, AstNodeTry *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->block);
+        deserialize_AstNode_PTR(deserializer, &value->handlers);
+        deserialize_AstNode_PTR(deserializer, &value->or_else);
+        deserialize_AstNode_PTR(deserializer, &value->finally);
+}
+uint16_t AstNodeTryChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeTry *)0)->block,
+(uint16_t)(uint64_t)&((AstNodeTry *)0)->handlers,
+(uint16_t)(uint64_t)&((AstNodeTry *)0)->or_else,
+(uint16_t)(uint64_t)&((AstNodeTry *)0)->finally,
+};
 StructMemberDefinition AstNodeWithItemStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeWithItem *)0)->expression},
 {TYPE_AstNode_PTR, "target", (uint64_t)&((AstNodeWithItem *)0)->target},
 };
+static void serialize_AstNodeWithItem(Serializer *serializer, AstNodeWithItem *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->target);
+}
+static void deserialize_AstNodeWithItem(Deserializer *deserializer, AstNodeWithItem *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->target);
+}
+uint16_t AstNodeWithItemChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeWithItem *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeWithItem *)0)->target,
+};
 StructMemberDefinition AstNodeWithStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "items", (uint64_t)&((AstNodeWith *)0)->items},
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeWith *)0)->block},
 };
+static void serialize_AstNodeWith(Serializer *serializer, AstNodeWith *value)
+{
+        serialize_AstNode_PTR(serializer, &value->items);
+        serialize_AstNode_PTR(serializer, &value->block);
+}
+static void deserialize_AstNodeWith(Deserializer *deserializer, AstNodeWith *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->items);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+}
+uint16_t AstNodeWithChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeWith *)0)->items,
+(uint16_t)(uint64_t)&((AstNodeWith *)0)->block,
+};
 StructMemberDefinition AstNodeExceptStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeExcept *)0)->expression},
 {TYPE_AstNode_PTR, "block", (uint64_t)&((AstNodeExcept *)0)->block},
 };
+static void serialize_AstNodeExcept(Serializer *serializer, AstNodeExcept *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->block);
+}
+static void deserialize_AstNodeExcept(Deserializer *deserializer, AstNodeExcept *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->block);
+}
+uint16_t AstNodeExceptChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeExcept *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeExcept *)0)->block,
+};
 StructMemberDefinition AstNodeStarExpressionStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeStarExpression *)0)->expression},
 };
+static void serialize_AstNodeStarExpression(Serializer *serializer, AstNodeStarExpression *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+}
+static void deserialize_AstNodeStarExpression(Deserializer *deserializer, AstNodeStarExpression *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+}
+uint16_t AstNodeStarExpressionChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeStarExpression *)0)->expression,
+};
 StructMemberDefinition AstNodeImportTargetStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "dotted_name", (uint64_t)&((AstNodeImportTarget *)0)->dotted_name},
 {TYPE_AstNode_PTR, "as", (uint64_t)&((AstNodeImportTarget *)0)->as},
+{TYPE_SymbolTableEntry_PTR, "module", (uint64_t)&((AstNodeImportTarget *)0)->module},
+};
+static void serialize_AstNodeImportTarget(Serializer *serializer, AstNodeImportTarget *value)
+{
+        serialize_AstNode_PTR(serializer, &value->dotted_name);
+        serialize_AstNode_PTR(serializer, &value->as);
+        serialize_SymbolTableEntry_PTR(serializer, &value->module);
+}
+static void deserialize_AstNodeImportTarget(Deserializer *deserializer, AstNodeImportTarget *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->dotted_name);
+        deserialize_AstNode_PTR(deserializer, &value->as);
+        deserialize_SymbolTableEntry_PTR(deserializer, &value->module);
+}
+uint16_t AstNodeImportTargetChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeImportTarget *)0)->dotted_name,
+(uint16_t)(uint64_t)&((AstNodeImportTarget *)0)->as,
 };
 StructMemberDefinition AstNodeFromImportTargetStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "name", (uint64_t)&((AstNodeFromImportTarget *)0)->name},
 {TYPE_AstNode_PTR, "as", (uint64_t)&((AstNodeFromImportTarget *)0)->as},
 };
+static void serialize_AstNodeFromImportTarget(Serializer *serializer, AstNodeFromImportTarget *value)
+{
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->as);
+}
+static void deserialize_AstNodeFromImportTarget(Deserializer *deserializer, AstNodeFromImportTarget *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->as);
+}
+uint16_t AstNodeFromImportTargetChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeFromImportTarget *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeFromImportTarget *)0)->as,
+};
 StructMemberDefinition AstNodeRaiseStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeRaise *)0)->expression},
 {TYPE_AstNode_PTR, "from_expression", (uint64_t)&((AstNodeRaise *)0)->from_expression},
 };
+static void serialize_AstNodeRaise(Serializer *serializer, AstNodeRaise *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->from_expression);
+}
+static void deserialize_AstNodeRaise(Deserializer *deserializer, AstNodeRaise *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->from_expression);
+}
+uint16_t AstNodeRaiseChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeRaise *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeRaise *)0)->from_expression,
+};
 StructMemberDefinition AstNodeFromStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "dotted_name", (uint64_t)&((AstNodeFrom *)0)->dotted_name},
 {TYPE_AstNode_PTR, "targets", (uint64_t)&((AstNodeFrom *)0)->targets},
 {TYPE_bool, "is_wildcard", (uint64_t)&((AstNodeFrom *)0)->is_wildcard},
 };
+static void serialize_AstNodeFrom(Serializer *serializer, AstNodeFrom *value)
+{
+        serialize_AstNode_PTR(serializer, &value->dotted_name);
+        serialize_AstNode_PTR(serializer, &value->targets);
+        serialize_bool(serializer, &value->is_wildcard);
+}
+static void deserialize_AstNodeFrom(Deserializer *deserializer, AstNodeFrom *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->dotted_name);
+        deserialize_AstNode_PTR(deserializer, &value->targets);
+        deserialize_bool(deserializer, &value->is_wildcard);
+}
+uint16_t AstNodeFromChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeFrom *)0)->dotted_name,
+(uint16_t)(uint64_t)&((AstNodeFrom *)0)->targets,
+};
 StructMemberDefinition AstNodeMatchStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "subject", (uint64_t)&((AstNodeMatch *)0)->subject},
 {TYPE_AstNode_PTR, "case_block", (uint64_t)&((AstNodeMatch *)0)->case_block},
 };
+static void serialize_AstNodeMatch(Serializer *serializer, AstNodeMatch *value)
+{
+        serialize_AstNode_PTR(serializer, &value->subject);
+        serialize_AstNode_PTR(serializer, &value->case_block);
+}
+static void deserialize_AstNodeMatch(Deserializer *deserializer, AstNodeMatch *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->subject);
+        deserialize_AstNode_PTR(deserializer, &value->case_block);
+}
+uint16_t AstNodeMatchChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeMatch *)0)->subject,
+(uint16_t)(uint64_t)&((AstNodeMatch *)0)->case_block,
+};
 StructMemberDefinition AstNodeAttributeRefStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "name", (uint64_t)&((AstNodeAttributeRef *)0)->name},
 {TYPE_AstNode_PTR, "attribute", (uint64_t)&((AstNodeAttributeRef *)0)->attribute},
 };
+static void serialize_AstNodeAttributeRef(Serializer *serializer, AstNodeAttributeRef *value)
+{
+        serialize_AstNode_PTR(serializer, &value->name);
+        serialize_AstNode_PTR(serializer, &value->attribute);
+}
+static void deserialize_AstNodeAttributeRef(Deserializer *deserializer, AstNodeAttributeRef *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->name);
+        deserialize_AstNode_PTR(deserializer, &value->attribute);
+}
+uint16_t AstNodeAttributeRefChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeAttributeRef *)0)->name,
+(uint16_t)(uint64_t)&((AstNodeAttributeRef *)0)->attribute,
+};
 StructMemberDefinition AstNodeFileStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeFile *)0)->children},
 };
+static void serialize_AstNodeFile(Serializer *serializer, AstNodeFile *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeFile(Deserializer *deserializer, AstNodeFile *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeFileChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeFile *)0)->children,
+};
 StructMemberDefinition AstNodeBlockStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeBlock *)0)->children},
 };
+static void serialize_AstNodeBlock(Serializer *serializer, AstNodeBlock *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeBlock(Deserializer *deserializer, AstNodeBlock *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeBlockChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeBlock *)0)->children,
+};
 StructMemberDefinition AstNodeTupleStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeTuple *)0)->children},
 };
+static void serialize_AstNodeTuple(Serializer *serializer, AstNodeTuple *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeTuple(Deserializer *deserializer, AstNodeTuple *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeTupleChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeTuple *)0)->children,
+};
 StructMemberDefinition AstNodeGenExprStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "expression", (uint64_t)&((AstNodeGenExpr *)0)->expression},
 {TYPE_AstNode_PTR, "for_if_clauses", (uint64_t)&((AstNodeGenExpr *)0)->for_if_clauses},
 };
+static void serialize_AstNodeGenExpr(Serializer *serializer, AstNodeGenExpr *value)
+{
+        serialize_AstNode_PTR(serializer, &value->expression);
+        serialize_AstNode_PTR(serializer, &value->for_if_clauses);
+}
+static void deserialize_AstNodeGenExpr(Deserializer *deserializer, AstNodeGenExpr *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->expression);
+        deserialize_AstNode_PTR(deserializer, &value->for_if_clauses);
+}
+uint16_t AstNodeGenExprChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeGenExpr *)0)->expression,
+(uint16_t)(uint64_t)&((AstNodeGenExpr *)0)->for_if_clauses,
+};
 StructMemberDefinition AstNodeImportStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeImport *)0)->children},
 };
+static void serialize_AstNodeImport(Serializer *serializer, AstNodeImport *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeImport(Deserializer *deserializer, AstNodeImport *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeImportChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeImport *)0)->children,
+};
 StructMemberDefinition AstNodeListStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeList *)0)->children},
 };
+static void serialize_AstNodeList(Serializer *serializer, AstNodeList *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeList(Deserializer *deserializer, AstNodeList *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeListChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeList *)0)->children,
+};
 StructMemberDefinition AstNodeDictStructMembers[] = 
 {
 {TYPE_AstNode_PTR, "children", (uint64_t)&((AstNodeDict *)0)->children},
 };
+static void serialize_AstNodeDict(Serializer *serializer, AstNodeDict *value)
+{
+        serialize_AstNode_PTR(serializer, &value->children);
+}
+static void deserialize_AstNodeDict(Deserializer *deserializer, AstNodeDict *value)
+{
+        deserialize_AstNode_PTR(deserializer, &value->children);
+}
+uint16_t AstNodeDictChildOffsets[] = 
+{
+(uint16_t)(uint64_t)&((AstNodeDict *)0)->children,
+};
 EnumMemberDefinition  ParseErrorTypeEnumMembers[] =
 {
 {"NONE", 0},
 {"INVALID_SYNTAX", 2},
 {"GENERAL", 3},
 };
+static void serialize_ParseErrorType(Serializer *serializer, ParseErrorType *value)
+{
+        uint8_t raw = (uint8_t)*value;
+        serialize_uint8_t(serializer, &raw);
+}
+static void deserialize_ParseErrorType(Deserializer *deserializer, ParseErrorType *value)
+{
+        uint8_t raw = 0;
+        deserialize_uint8_t(deserializer, &raw);
+        if (raw > 3)
+                deserializer->failed = true;
+        *value = (ParseErrorType)raw;
+}
+static void serialize_AstNodeType_payload(Serializer *serializer, AstNodeType tag, void *payload)
+{
+        switch (tag) {
+        case AstNodeType::NARY:
+                serialize_AstNodeNary(serializer, (AstNodeNary *)payload);
+                break;
+        case AstNodeType::IDENTIFIER:
+                serialize_AstNodeIdentifier(serializer, (AstNodeIdentifier *)payload);
+                break;
+        case AstNodeType::FILE:
+                serialize_AstNodeFile(serializer, (AstNodeFile *)payload);
+                break;
+        case AstNodeType::BLOCK:
+                serialize_AstNodeBlock(serializer, (AstNodeBlock *)payload);
+                break;
+        case AstNodeType::BINARYEXPR:
+                serialize_AstNodeBinaryExpr(serializer, (AstNodeBinaryExpr *)payload);
+                break;
+        case AstNodeType::UNARY:
+                serialize_AstNodeUnary(serializer, (AstNodeUnary *)payload);
+                break;
+        case AstNodeType::DECLARATION:
+                serialize_AstNodeDeclaration(serializer, (AstNodeDeclaration *)payload);
+                break;
+        case AstNodeType::ASSIGNMENT:
+                serialize_AstNodeAssignment(serializer, (AstNodeAssignment *)payload);
+                break;
+        case AstNodeType::TYPE_ANNOTATION:
+                serialize_AstNodeTypeAnnot(serializer, (AstNodeTypeAnnot *)payload);
+                break;
+        case AstNodeType::IF:
+                serialize_AstNodeIf(serializer, (AstNodeIf *)payload);
+                break;
+        case AstNodeType::ELSE:
+                serialize_AstNodeElse(serializer, (AstNodeElse *)payload);
+                break;
+        case AstNodeType::WHILE:
+                serialize_AstNodeWhile(serializer, (AstNodeWhile *)payload);
+                break;
+        case AstNodeType::FOR_LOOP:
+                serialize_AstNodeForLoop(serializer, (AstNodeForLoop *)payload);
+                break;
+        case AstNodeType::FOR_IF:
+                serialize_AstNodeForIfClause(serializer, (AstNodeForIfClause *)payload);
+                break;
+        case AstNodeType::FUNCTION_DEF:
+                serialize_AstNodeFunctionDef(serializer, (AstNodeFunctionDef *)payload);
+                break;
+        case AstNodeType::FUNCTION_CALL:
+                serialize_AstNodeFunctionCall(serializer, (AstNodeFunctionCall *)payload);
+                break;
+        case AstNodeType::CLASS_DEF:
+                serialize_AstNodeClassDef(serializer, (AstNodeClassDef *)payload);
+                break;
+        case AstNodeType::SUBSCRIPT:
+                serialize_AstNodeSubscript(serializer, (AstNodeSubscript *)payload);
+                break;
+        case AstNodeType::SLICE:
+                serialize_AstNodeSlice(serializer, (AstNodeSlice *)payload);
+                break;
+        case AstNodeType::ATTRIBUTE_REF:
+                serialize_AstNodeAttributeRef(serializer, (AstNodeAttributeRef *)payload);
+                break;
+        case AstNodeType::TRY:
+                serialize_AstNodeTry(serializer, (AstNodeTry *)payload);
+                break;
+        case AstNodeType::WITH_ITEM:
+                serialize_AstNodeWithItem(serializer, (AstNodeWithItem *)payload);
+                break;
+        case AstNodeType::WITH:
+                serialize_AstNodeWith(serializer, (AstNodeWith *)payload);
+                break;
+        case AstNodeType::EXCEPT:
+                serialize_AstNodeExcept(serializer, (AstNodeExcept *)payload);
+                break;
+        case AstNodeType::STARRED:
+                serialize_AstNodeStarExpression(serializer, (AstNodeStarExpression *)payload);
+                break;
+        case AstNodeType::KWARG:
+                serialize_AstNodeKwarg(serializer, (AstNodeKwarg *)payload);
+                break;
+        case AstNodeType::KVPAIR:
+                serialize_AstNodeKvPair(serializer, (AstNodeKvPair *)payload);
+                break;
+        case AstNodeType::IMPORT:
+                serialize_AstNodeImport(serializer, (AstNodeImport *)payload);
+                break;
+        case AstNodeType::IMPORT_TARGET:
+                serialize_AstNodeImportTarget(serializer, (AstNodeImportTarget *)payload);
+                break;
+        case AstNodeType::FROM:
+                serialize_AstNodeFrom(serializer, (AstNodeFrom *)payload);
+                break;
+        case AstNodeType::FROM_TARGET:
+                serialize_AstNodeFromImportTarget(serializer, (AstNodeFromImportTarget *)payload);
+                break;
+        case AstNodeType::TUPLE:
+                serialize_AstNodeTuple(serializer, (AstNodeTuple *)payload);
+                break;
+        case AstNodeType::LIST:
+                serialize_AstNodeList(serializer, (AstNodeList *)payload);
+                break;
+        case AstNodeType::LISTCOMP:
+                serialize_AstNodeList(serializer, (AstNodeList *)payload);
+                break;
+        case AstNodeType::DICT:
+                serialize_AstNodeDict(serializer, (AstNodeDict *)payload);
+                break;
+        case AstNodeType::DICTCOMP:
+                serialize_AstNodeDict(serializer, (AstNodeDict *)payload);
+                break;
+        case AstNodeType::UNION:
+                serialize_AstNodeUnion(serializer, (AstNodeUnion *)payload);
+                break;
+        case AstNodeType::MATCH:
+                serialize_AstNodeMatch(serializer, (AstNodeMatch *)payload);
+                break;
+        case AstNodeType::RAISE:
+                serialize_AstNodeRaise(serializer, (AstNodeRaise *)payload);
+                break;
+        case AstNodeType::IF_EXPR:
+                serialize_AstNodeIfExpr(serializer, (AstNodeIfExpr *)payload);
+                break;
+        case AstNodeType::GEN_EXPR:
+                serialize_AstNodeGenExpr(serializer, (AstNodeGenExpr *)payload);
+                break;
+        case AstNodeType::LAMBDA:
+                serialize_AstNodeLambdaDef(serializer, (AstNodeLambdaDef *)payload);
+                break;
+        case AstNodeType::TYPE_PARAM:
+                serialize_AstNodeTypeParam(serializer, (AstNodeTypeParam *)payload);
+                break;
+        default:
+                break;
+        }
+}
+static void deserialize_AstNodeType_payload(Deserializer *deserializer, AstNodeType tag, void *payload)
+{
+        switch (tag) {
+        case AstNodeType::NARY:
+                deserialize_AstNodeNary(deserializer, (AstNodeNary *)payload);
+                break;
+        case AstNodeType::IDENTIFIER:
+                deserialize_AstNodeIdentifier(deserializer, (AstNodeIdentifier *)payload);
+                break;
+        case AstNodeType::FILE:
+                deserialize_AstNodeFile(deserializer, (AstNodeFile *)payload);
+                break;
+        case AstNodeType::BLOCK:
+                deserialize_AstNodeBlock(deserializer, (AstNodeBlock *)payload);
+                break;
+        case AstNodeType::BINARYEXPR:
+                deserialize_AstNodeBinaryExpr(deserializer, (AstNodeBinaryExpr *)payload);
+                break;
+        case AstNodeType::UNARY:
+                deserialize_AstNodeUnary(deserializer, (AstNodeUnary *)payload);
+                break;
+        case AstNodeType::DECLARATION:
+                deserialize_AstNodeDeclaration(deserializer, (AstNodeDeclaration *)payload);
+                break;
+        case AstNodeType::ASSIGNMENT:
+                deserialize_AstNodeAssignment(deserializer, (AstNodeAssignment *)payload);
+                break;
+        case AstNodeType::TYPE_ANNOTATION:
+                deserialize_AstNodeTypeAnnot(deserializer, (AstNodeTypeAnnot *)payload);
+                break;
+        case AstNodeType::IF:
+                deserialize_AstNodeIf(deserializer, (AstNodeIf *)payload);
+                break;
+        case AstNodeType::ELSE:
+                deserialize_AstNodeElse(deserializer, (AstNodeElse *)payload);
+                break;
+        case AstNodeType::WHILE:
+                deserialize_AstNodeWhile(deserializer, (AstNodeWhile *)payload);
+                break;
+        case AstNodeType::FOR_LOOP:
+                deserialize_AstNodeForLoop(deserializer, (AstNodeForLoop *)payload);
+                break;
+        case AstNodeType::FOR_IF:
+                deserialize_AstNodeForIfClause(deserializer, (AstNodeForIfClause *)payload);
+                break;
+        case AstNodeType::FUNCTION_DEF:
+                deserialize_AstNodeFunctionDef(deserializer, (AstNodeFunctionDef *)payload);
+                break;
+        case AstNodeType::FUNCTION_CALL:
+                deserialize_AstNodeFunctionCall(deserializer, (AstNodeFunctionCall *)payload);
+                break;
+        case AstNodeType::CLASS_DEF:
+                deserialize_AstNodeClassDef(deserializer, (AstNodeClassDef *)payload);
+                break;
+        case AstNodeType::SUBSCRIPT:
+                deserialize_AstNodeSubscript(deserializer, (AstNodeSubscript *)payload);
+                break;
+        case AstNodeType::SLICE:
+                deserialize_AstNodeSlice(deserializer, (AstNodeSlice *)payload);
+                break;
+        case AstNodeType::ATTRIBUTE_REF:
+                deserialize_AstNodeAttributeRef(deserializer, (AstNodeAttributeRef *)payload);
+                break;
+        case AstNodeType::TRY:
+                deserialize_AstNodeTry(deserializer, (AstNodeTry *)payload);
+                break;
+        case AstNodeType::WITH_ITEM:
+                deserialize_AstNodeWithItem(deserializer, (AstNodeWithItem *)payload);
+                break;
+        case AstNodeType::WITH:
+                deserialize_AstNodeWith(deserializer, (AstNodeWith *)payload);
+                break;
+        case AstNodeType::EXCEPT:
+                deserialize_AstNodeExcept(deserializer, (AstNodeExcept *)payload);
+                break;
+        case AstNodeType::STARRED:
+                deserialize_AstNodeStarExpression(deserializer, (AstNodeStarExpression *)payload);
+                break;
+        case AstNodeType::KWARG:
+                deserialize_AstNodeKwarg(deserializer, (AstNodeKwarg *)payload);
+                break;
+        case AstNodeType::KVPAIR:
+                deserialize_AstNodeKvPair(deserializer, (AstNodeKvPair *)payload);
+                break;
+        case AstNodeType::IMPORT:
+                deserialize_AstNodeImport(deserializer, (AstNodeImport *)payload);
+                break;
+        case AstNodeType::IMPORT_TARGET:
+                deserialize_AstNodeImportTarget(deserializer, (AstNodeImportTarget *)payload);
+                break;
+        case AstNodeType::FROM:
+                deserialize_AstNodeFrom(deserializer, (AstNodeFrom *)payload);
+                break;
+        case AstNodeType::FROM_TARGET:
+                deserialize_AstNodeFromImportTarget(deserializer, (AstNodeFromImportTarget *)payload);
+                break;
+        case AstNodeType::TUPLE:
+                deserialize_AstNodeTuple(deserializer, (AstNodeTuple *)payload);
+                break;
+        case AstNodeType::LIST:
+                deserialize_AstNodeList(deserializer, (AstNodeList *)payload);
+                break;
+        case AstNodeType::LISTCOMP:
+                deserialize_AstNodeList(deserializer, (AstNodeList *)payload);
+                break;
+        case AstNodeType::DICT:
+                deserialize_AstNodeDict(deserializer, (AstNodeDict *)payload);
+                break;
+        case AstNodeType::DICTCOMP:
+                deserialize_AstNodeDict(deserializer, (AstNodeDict *)payload);
+                break;
+        case AstNodeType::UNION:
+                deserialize_AstNodeUnion(deserializer, (AstNodeUnion *)payload);
+                break;
+        case AstNodeType::MATCH:
+                deserialize_AstNodeMatch(deserializer, (AstNodeMatch *)payload);
+                break;
+        case AstNodeType::RAISE:
+                deserialize_AstNodeRaise(deserializer, (AstNodeRaise *)payload);
+                break;
+        case AstNodeType::IF_EXPR:
+                deserialize_AstNodeIfExpr(deserializer, (AstNodeIfExpr *)payload);
+                break;
+        case AstNodeType::GEN_EXPR:
+                deserialize_AstNodeGenExpr(deserializer, (AstNodeGenExpr *)payload);
+                break;
+        case AstNodeType::LAMBDA:
+                deserialize_AstNodeLambdaDef(deserializer, (AstNodeLambdaDef *)payload);
+                break;
+        case AstNodeType::TYPE_PARAM:
+                deserialize_AstNodeTypeParam(deserializer, (AstNodeTypeParam *)payload);
+                break;
+        default:
+                break;
+        }
+}
+PayloadDefinition AstNodeTypePayloads[] =
+{
+{nullptr, 0, nullptr, 0},
+{AstNodeFileStructMembers, 1, AstNodeFileChildOffsets, 1},
+{AstNodeBinaryExprStructMembers, 2, AstNodeBinaryExprChildOffsets, 2},
+{AstNodeUnaryStructMembers, 1, AstNodeUnaryChildOffsets, 1},
+{AstNodeNaryStructMembers, 1, AstNodeNaryChildOffsets, 1},
+{AstNodeTupleStructMembers, 1, AstNodeTupleChildOffsets, 1},
+{AstNodeDictStructMembers, 1, AstNodeDictChildOffsets, 1},
+{AstNodeDictStructMembers, 1, AstNodeDictChildOffsets, 1},
+{AstNodeListStructMembers, 1, AstNodeListChildOffsets, 1},
+{AstNodeListStructMembers, 1, AstNodeListChildOffsets, 1},
+{nullptr, 0, nullptr, 0},
+{AstNodeIdentifierStructMembers, 1, nullptr, 0},
+{AstNodeAssignmentStructMembers, 2, AstNodeAssignmentChildOffsets, 2},
+{AstNodeBlockStructMembers, 1, AstNodeBlockChildOffsets, 1},
+{AstNodeDeclarationStructMembers, 3, AstNodeDeclarationChildOffsets, 3},
+{AstNodeTypeAnnotStructMembers, 2, AstNodeTypeAnnotChildOffsets, 2},
+{AstNodeIfStructMembers, 3, AstNodeIfChildOffsets, 3},
+{AstNodeElseStructMembers, 1, AstNodeElseChildOffsets, 1},
+{AstNodeWhileStructMembers, 3, AstNodeWhileChildOffsets, 3},
+{AstNodeForLoopStructMembers, 4, AstNodeForLoopChildOffsets, 4},
+{AstNodeForIfClauseStructMembers, 3, AstNodeForIfClauseChildOffsets, 3},
+{AstNodeFunctionDefStructMembers, 10, AstNodeFunctionDefChildOffsets, 8},
+{AstNodeClassDefStructMembers, 5, AstNodeClassDefChildOffsets, 5},
+{AstNodeFunctionCallStructMembers, 2, AstNodeFunctionCallChildOffsets, 2},
+{AstNodeSubscriptStructMembers, 2, AstNodeSubscriptChildOffsets, 2},
+{AstNodeSliceStructMembers, 4, AstNodeSliceChildOffsets, 4},
+{AstNodeAttributeRefStructMembers, 2, AstNodeAttributeRefChildOffsets, 2},
+{AstNodeTryStructMembers, 4, AstNodeTryChildOffsets, 4},
+{AstNodeWithStructMembers, 2, AstNodeWithChildOffsets, 2},
+{AstNodeWithItemStructMembers, 2, AstNodeWithItemChildOffsets, 2},
+{AstNodeExceptStructMembers, 2, AstNodeExceptChildOffsets, 2},
+{AstNodeStarExpressionStructMembers, 1, AstNodeStarExpressionChildOffsets, 1},
+{AstNodeKvPairStructMembers, 2, AstNodeKvPairChildOffsets, 2},
+{AstNodeImportStructMembers, 1, AstNodeImportChildOffsets, 1},
+{AstNodeImportTargetStructMembers, 3, AstNodeImportTargetChildOffsets, 2},
+{AstNodeFromStructMembers, 3, AstNodeFromChildOffsets, 2},
+{AstNodeFromImportTargetStructMembers, 2, AstNodeFromImportTargetChildOffsets, 2},
+{AstNodeUnionStructMembers, 2, AstNodeUnionChildOffsets, 2},
+{AstNodeMatchStructMembers, 2, AstNodeMatchChildOffsets, 2},
+{AstNodeRaiseStructMembers, 2, AstNodeRaiseChildOffsets, 2},
+{AstNodeIfExprStructMembers, 3, AstNodeIfExprChildOffsets, 3},
+{AstNodeGenExprStructMembers, 2, AstNodeGenExprChildOffsets, 2},
+{AstNodeLambdaDefStructMembers, 4, AstNodeLambdaDefChildOffsets, 4},
+{AstNodeTypeParamStructMembers, 4, AstNodeTypeParamChildOffsets, 2},
+{nullptr, 0, nullptr, 0},
+{AstNodeKwargStructMembers, 2, AstNodeKwargChildOffsets, 2},
+};
+#define PARSER_H_SCHEMA_HASH 0xad529be4c0dda118ull
+#define TOKENISER_H_SCHEMA_HASH 0x681158c231934cb1ull
 EnumMemberDefinition  TypeInfoTypeEnumMembers[] =
 {
 {"ANY", 0},
@@ -287,35 +1298,182 @@ EnumMemberDefinition  TypeInfoTypeEnumMembers[] =
 {"UNKNOWN", 14},
 {"SIZE", 15},
 };
+static void serialize_TypeInfoType(Serializer *serializer, TypeInfoType *value)
+{
+        uint8_t raw = (uint8_t)*value;
+        serialize_uint8_t(serializer, &raw);
+}
+static void deserialize_TypeInfoType(Deserializer *deserializer, TypeInfoType *value)
+{
+        uint8_t raw = 0;
+        deserialize_uint8_t(deserializer, &raw);
+        if (raw > 15)
+                deserializer->failed = true;
+        *value = (TypeInfoType)raw;
+}
 StructMemberDefinition TypeInfoListStructMembers[] = 
 {
 {TYPE_TypeInfo_PTR, "item_type", (uint64_t)&((TypeInfoList *)0)->item_type},
 };
+static void serialize_TypeInfoList(Serializer *serializer, TypeInfoList *value)
+{
+        serialize_TypeInfo_PTR(serializer, &value->item_type);
+}
+static void deserialize_TypeInfoList(Deserializer *deserializer, TypeInfoList *value)
+{
+        deserialize_TypeInfo_PTR(deserializer, &value->item_type);
+}
 StructMemberDefinition TypeInfoParameterisedStructMembers[] = 
 {
 {TYPE_TypeInfo_PTR, "parameters", (uint64_t)&((TypeInfoParameterised *)0)->parameters},
 };
+static void serialize_TypeInfoParameterised(Serializer *serializer, TypeInfoParameterised *value)
+{
+        serialize_TypeInfo_PTR(serializer, &value->parameters);
+}
+static void deserialize_TypeInfoParameterised(Deserializer *deserializer, TypeInfoParameterised *value)
+{
+        deserialize_TypeInfo_PTR(deserializer, &value->parameters);
+}
 StructMemberDefinition TypeInfoDictStructMembers[] = 
 {
 {TYPE_TypeInfo_PTR, "key_type", (uint64_t)&((TypeInfoDict *)0)->key_type},
 {TYPE_TypeInfo_PTR, "val_type", (uint64_t)&((TypeInfoDict *)0)->val_type},
 };
+static void serialize_TypeInfoDict(Serializer *serializer, TypeInfoDict *value)
+{
+        serialize_TypeInfo_PTR(serializer, &value->key_type);
+        serialize_TypeInfo_PTR(serializer, &value->val_type);
+}
+static void deserialize_TypeInfoDict(Deserializer *deserializer, TypeInfoDict *value)
+{
+        deserialize_TypeInfo_PTR(deserializer, &value->key_type);
+        deserialize_TypeInfo_PTR(deserializer, &value->val_type);
+}
 StructMemberDefinition TypeInfoKVpairStructMembers[] = 
 {
 {TYPE_TypeInfo_PTR, "val_type", (uint64_t)&((TypeInfoKVpair *)0)->val_type},
 {TYPE_TypeInfo_PTR, "key_type", (uint64_t)&((TypeInfoKVpair *)0)->key_type},
 };
+static void serialize_TypeInfoKVpair(Serializer *serializer, TypeInfoKVpair *value)
+{
+        serialize_TypeInfo_PTR(serializer, &value->val_type);
+        serialize_TypeInfo_PTR(serializer, &value->key_type);
+}
+static void deserialize_TypeInfoKVpair(Deserializer *deserializer, TypeInfoKVpair *value)
+{
+        deserialize_TypeInfo_PTR(deserializer, &value->val_type);
+        deserialize_TypeInfo_PTR(deserializer, &value->key_type);
+}
 StructMemberDefinition TypeInfoUnionStructMembers[] = 
 {
 {TYPE_TypeInfo_PTR, "left", (uint64_t)&((TypeInfoUnion *)0)->left},
 {TYPE_TypeInfo_PTR, "right", (uint64_t)&((TypeInfoUnion *)0)->right},
 };
+static void serialize_TypeInfoUnion(Serializer *serializer, TypeInfoUnion *value)
+{
+        serialize_TypeInfo_PTR(serializer, &value->left);
+        serialize_TypeInfo_PTR(serializer, &value->right);
+}
+static void deserialize_TypeInfoUnion(Deserializer *deserializer, TypeInfoUnion *value)
+{
+        deserialize_TypeInfo_PTR(deserializer, &value->left);
+        deserialize_TypeInfo_PTR(deserializer, &value->right);
+}
 StructMemberDefinition TypeInfoClassStructMembers[] = 
 {
 {TYPE_SymbolTableEntry_PTR, "custom_symbol", (uint64_t)&((TypeInfoClass *)0)->custom_symbol},
 };
+static void serialize_TypeInfoClass(Serializer *serializer, TypeInfoClass *value)
+{
+        serialize_SymbolTableEntry_PTR(serializer, &value->custom_symbol);
+}
+static void deserialize_TypeInfoClass(Deserializer *deserializer, TypeInfoClass *value)
+{
+        deserialize_SymbolTableEntry_PTR(deserializer, &value->custom_symbol);
+}
 StructMemberDefinition TypeInfoFunctionStructMembers[] = 
 {
 {TYPE_TypeInfo_PTR, "return_type", (uint64_t)&((TypeInfoFunction *)0)->return_type},
 {TYPE_SymbolTableEntry_PTR, "custom_symbol", (uint64_t)&((TypeInfoFunction *)0)->custom_symbol},
 };
+static void serialize_TypeInfoFunction(Serializer *serializer, TypeInfoFunction *value)
+{
+        serialize_TypeInfo_PTR(serializer, &value->return_type);
+        serialize_SymbolTableEntry_PTR(serializer, &value->custom_symbol);
+}
+static void deserialize_TypeInfoFunction(Deserializer *deserializer, TypeInfoFunction *value)
+{
+        deserialize_TypeInfo_PTR(deserializer, &value->return_type);
+        deserialize_SymbolTableEntry_PTR(deserializer, &value->custom_symbol);
+}
+static void serialize_TypeInfoType_payload(Serializer *serializer, TypeInfoType tag, void *payload)
+{
+        switch (tag) {
+        case TypeInfoType::LIST:
+                serialize_TypeInfoList(serializer, (TypeInfoList *)payload);
+                break;
+        case TypeInfoType::UNION:
+                serialize_TypeInfoUnion(serializer, (TypeInfoUnion *)payload);
+                break;
+        case TypeInfoType::DICT:
+                serialize_TypeInfoDict(serializer, (TypeInfoDict *)payload);
+                break;
+        case TypeInfoType::KVPAIR:
+                serialize_TypeInfoKVpair(serializer, (TypeInfoKVpair *)payload);
+                break;
+        case TypeInfoType::CLASS:
+                serialize_TypeInfoClass(serializer, (TypeInfoClass *)payload);
+                break;
+        case TypeInfoType::FUNCTION:
+                serialize_TypeInfoFunction(serializer, (TypeInfoFunction *)payload);
+                break;
+        default:
+                break;
+        }
+}
+static void deserialize_TypeInfoType_payload(Deserializer *deserializer, TypeInfoType tag, void *payload)
+{
+        switch (tag) {
+        case TypeInfoType::LIST:
+                deserialize_TypeInfoList(deserializer, (TypeInfoList *)payload);
+                break;
+        case TypeInfoType::UNION:
+                deserialize_TypeInfoUnion(deserializer, (TypeInfoUnion *)payload);
+                break;
+        case TypeInfoType::DICT:
+                deserialize_TypeInfoDict(deserializer, (TypeInfoDict *)payload);
+                break;
+        case TypeInfoType::KVPAIR:
+                deserialize_TypeInfoKVpair(deserializer, (TypeInfoKVpair *)payload);
+                break;
+        case TypeInfoType::CLASS:
+                deserialize_TypeInfoClass(deserializer, (TypeInfoClass *)payload);
+                break;
+        case TypeInfoType::FUNCTION:
+                deserialize_TypeInfoFunction(deserializer, (TypeInfoFunction *)payload);
+                break;
+        default:
+                break;
+        }
+}
+PayloadDefinition TypeInfoTypePayloads[] =
+{
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{TypeInfoListStructMembers, 1, nullptr, 0},
+{TypeInfoDictStructMembers, 2, nullptr, 0},
+{TypeInfoKVpairStructMembers, 2, nullptr, 0},
+{TypeInfoUnionStructMembers, 2, nullptr, 0},
+{TypeInfoClassStructMembers, 1, nullptr, 0},
+{TypeInfoFunctionStructMembers, 2, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+{nullptr, 0, nullptr, 0},
+};
+#define TYPING_H_SCHEMA_HASH 0xe90cb7d2087ef01eull
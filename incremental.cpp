@@ -0,0 +1,637 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "incremental.h"
+#include "pipeline.h"
+#include "parser.h"
+#include "typing.h"
+#include "traversal.h"
+#include "serialize.h"
+#include "resolve.h"
+
+// FNV-1a a word at a time
+#define FINGERPRINT_SEED 14695981039346656037ull
+
+static inline uint64_t fingerprint_mix(uint64_t fingerprint, uint64_t value)
+{
+        fingerprint ^= value;
+        return fingerprint * 1099511628211ull;
+}
+
+static inline bool arena_contains(Arena *arena, void *pointer)
+{
+        char *memory = (char *)arena->memory;
+        return memory && (char *)pointer >= memory &&
+               (char *)pointer < memory + arena->offset;
+}
+
+// 0 when the file can't be read, e.g. while an editor replaces it
+static uint64_t file_last_write_time(const char *filename)
+{
+        WIN32_FILE_ATTRIBUTE_DATA data = {};
+        if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &data)) {
+                return 0;
+        }
+
+        return ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) |
+               data.ftLastWriteTime.dwLowDateTime;
+}
+
+static bool body_fingerprint_visit(AstNode *node, uint32_t depth,
+                                   void *user_data)
+{
+        uint64_t *fingerprint = (uint64_t *)user_data;
+        std::string &value = node->token.value;
+
+        *fingerprint = fingerprint_mix(*fingerprint,
+                                       ((uint64_t)node->type << 32) |
+                                               (uint32_t)node->token.type);
+        *fingerprint = fingerprint_mix(
+                *fingerprint,
+                ((uint64_t)depth << 32) |
+                        atom_hash(value.c_str(), (uint32_t)value.size()));
+
+        return true;
+}
+
+// The same for any two functions that differ only in where they are, the
+// depth keeps the shape of the tree in it
+static uint64_t body_fingerprint(AstNode *function_def, Arena *stack)
+{
+        uint64_t fingerprint = FINGERPRINT_SEED;
+        ast_visit(function_def, stack, body_fingerprint_visit, &fingerprint);
+
+        return fingerprint;
+}
+
+static int symbol_pointer_compare(const void *a, const void *b)
+{
+        uintptr_t lhs = (uintptr_t) * (SymbolTableEntry *const *)a;
+        uintptr_t rhs = (uintptr_t) * (SymbolTableEntry *const *)b;
+
+        if (lhs == rhs)
+                return 0;
+
+        return lhs < rhs ? -1 : 1;
+}
+
+// Called once task's body is typed with tables->symbol_reads and
+// tables->diagnostics holding only what the body read and reported
+static void record_body(BodyRecord *record, BodyTask *task, Tables *tables,
+                        Arena *arena, Arena *stack)
+{
+        AstNode *function_def = task->function_def;
+        record->function = tables->symbol_table->lookup(
+                function_def->function_def.name->token.value, task->scope);
+        record->fingerprint = body_fingerprint(function_def, stack);
+        record->line = function_def->token.line;
+
+        SymbolTableEntry **reads =
+                (SymbolTableEntry **)tables->symbol_reads->memory;
+        uint64_t read_count = tables->symbol_reads->offset / sizeof(*reads);
+        qsort(reads, read_count, sizeof(*reads), symbol_pointer_compare);
+
+        record->reads = (SymbolTableEntry **)arena->alloc(read_count *
+                                                          sizeof(*reads));
+        record->read_count = 0;
+        for (uint64_t i = 0; i < read_count; ++i) {
+                if (i == 0 || reads[i] != reads[i - 1]) {
+                        record->reads[record->read_count++] = reads[i];
+                }
+        }
+
+        Diagnostics *diagnostics = tables->diagnostics;
+        record->diagnostic_count = diagnostics->count;
+        record->diagnostics = (Diagnostic *)arena->alloc(
+                diagnostics->count * sizeof(Diagnostic));
+        memcpy(record->diagnostics, diagnostics->entries.memory,
+               diagnostics->count * sizeof(Diagnostic));
+}
+
+static uint64_t signature_fingerprint(Tables *tables, SymbolTableEntry *symbol)
+{
+        TypeInfo *type = &symbol->value.static_type;
+        AstNode *node = symbol->value.node;
+        uint64_t fingerprint =
+                fingerprint_mix(FINGERPRINT_SEED, (uint64_t)type->type);
+
+        // interned types are compared by pointer
+        if (type->type == TypeInfoType::FUNCTION &&
+            node->type == AstNodeType::FUNCTION_DEF) {
+                fingerprint = fingerprint_mix(
+                        fingerprint, (uint64_t)type->function.return_type);
+
+                for (AstNode *argument = node->function_def.arguments; argument;
+                     argument = argument->adjacent_child) {
+                        std::string &name = argument->token.value;
+                        fingerprint = fingerprint_mix(
+                                fingerprint,
+                                (uint64_t)type_intern(tables,
+                                                      argument->static_type));
+                        fingerprint = fingerprint_mix(
+                                fingerprint,
+                                atom_hash(name.c_str(), (uint32_t)name.size()));
+                }
+
+                return fingerprint;
+        }
+
+        if (type->type == TypeInfoType::CLASS &&
+            node->type == AstNodeType::CLASS_DEF) {
+                for (AstNode *base = node->class_def.arguments; base;
+                     base = base->adjacent_child) {
+                        fingerprint = fingerprint_mix(
+                                fingerprint,
+                                (uint64_t)type_intern(tables,
+                                                      base->static_type));
+                }
+
+                return fingerprint;
+        }
+
+        return fingerprint_mix(fingerprint, (uint64_t)type_intern(tables, *type));
+}
+
+static void record_scope_signatures(Module *module, Tables *tables,
+                                    SymbolTableEntry *scope)
+{
+        ScopeSymbols *symbols = tables->symbol_table->scope_symbols(scope);
+        if (!symbols) {
+                return;
+        }
+
+        // the module's scope can be shared with the builtins, only what this
+        // module's tree declares is its own
+        for (SymbolTableEntry *symbol = symbols->first; symbol;
+             symbol = symbol->next_in_scope) {
+                if (!arena_contains(&module->arena, symbol->value.node)) {
+                        continue;
+                }
+
+                SignatureRecord *record =
+                        (SignatureRecord *)module->records.arena.alloc(
+                                sizeof(SignatureRecord));
+                record->symbol = symbol;
+                record->fingerprint = signature_fingerprint(tables, symbol);
+                ++module->records.signature_count;
+
+                if (symbol->value.node->type == AstNodeType::CLASS_DEF) {
+                        record_scope_signatures(module, tables, symbol);
+                }
+        }
+}
+
+// Everything another body can see of the module, its top level names and
+// the members of its classes. Call once the module's top level is typed
+static void record_signatures(Module *module, Tables *tables)
+{
+        module->records.signatures =
+                (SignatureRecord *)((char *)module->records.arena.memory +
+                                    module->records.arena.offset);
+        module->records.signature_count = 0;
+        record_scope_signatures(module, tables, module->scope);
+}
+
+// A re-parse declares into the same entries so a name the new tree still
+// declares keeps its symbol, the ones it doesn't would be left pointing into
+// the old tree. They stay declared but are typed as ANY. The new tree's
+// classes are bound again as their bases may have changed and its functions'
+// signatures compiled again. The classes that were bound are kept in rebound
+struct ReboundClass {
+        SymbolTableEntry *symbol;
+        // what it was bound as, its derived classes have this ancestor
+        uint32_t id;
+        // it or one of its members did
+        bool changed;
+};
+
+static void recheck_release_symbols(Pipeline *pipeline, SymbolTableEntry *scope,
+                                    Arena *old_arena, Arena *new_arena,
+                                    Arena *rebound)
+{
+        ScopeSymbols *symbols =
+                pipeline->tables->symbol_table->scope_symbols(scope);
+        if (!symbols) {
+                return;
+        }
+
+        for (SymbolTableEntry *symbol = symbols->first; symbol;
+             symbol = symbol->next_in_scope) {
+                AstNode *node = symbol->value.node;
+                bool stale = arena_contains(old_arena, node);
+
+                if (!stale && !arena_contains(new_arena, node)) {
+                        continue;
+                }
+
+                recheck_release_symbols(pipeline, symbol, old_arena, new_arena,
+                                        rebound);
+
+                ClassInfo *info = symbol->class_info;
+                if (info && info != &class_info_binding) {
+                        ReboundClass *class_symbol = (ReboundClass *)
+                                rebound->alloc(sizeof(ReboundClass));
+                        class_symbol->symbol = symbol;
+                        class_symbol->id = info->id;
+                        class_symbol->changed = false;
+                }
+
+                if (stale) {
+                        symbol->value = {};
+                        symbol->value.static_type.type = TypeInfoType::ANY;
+                        symbol->value.node = pipeline->module_node;
+                        symbol->class_info = nullptr;
+                        symbol->call_signature = nullptr;
+                } else if (node->type == AstNodeType::CLASS_DEF) {
+                        symbol->class_info = nullptr;
+                } else if (node->type == AstNodeType::FUNCTION_DEF) {
+                        symbol->call_signature = nullptr;
+                }
+        }
+}
+
+// A class of another checked module that derives from one bound again has
+// the old class's members flattened into it so it's bound again too. If the
+// class it derives from or a member of that class changed, both count as
+// changed for the bodies that read them
+static void recheck_release_derived_classes(Pipeline *pipeline, Module *module,
+                                            ReboundClass *rebound,
+                                            uint64_t rebound_count,
+                                            PointerIndex *changed)
+{
+        if (!rebound_count) {
+                return;
+        }
+
+        for (uint64_t i = 0; i < changed->capacity; ++i) {
+                SymbolTableEntry *symbol = (SymbolTableEntry *)changed->keys[i];
+                if (!symbol) {
+                        continue;
+                }
+
+                for (uint64_t j = 0; j < rebound_count; ++j) {
+                        if (rebound[j].symbol == symbol ||
+                            rebound[j].symbol == symbol->key.scope) {
+                                rebound[j].changed = true;
+                        }
+                }
+        }
+
+        // inserted after the walk as inserting can grow changed
+        for (uint64_t i = 0; i < rebound_count; ++i) {
+                if (rebound[i].changed) {
+                        changed->insert(rebound[i].symbol, 1);
+                }
+        }
+
+        Arena released = Arena::init(MEGABYTES(1));
+        for (uint32_t i = 0; i < pipeline->input_module_count; ++i) {
+                Module *other = pipeline->modules[i];
+                if (other == module) {
+                        continue;
+                }
+
+                for (uint32_t j = 0; j < other->records.signature_count; ++j) {
+                        SymbolTableEntry *symbol =
+                                other->records.signatures[j].symbol;
+                        ClassInfo *info = symbol->class_info;
+                        if (!info || info == &class_info_binding) {
+                                continue;
+                        }
+
+                        bool derived = false;
+                        bool affected = false;
+                        for (uint64_t k = 0; k < rebound_count; ++k) {
+                                if (class_info_has_ancestor(info,
+                                                            rebound[k].id)) {
+                                        derived = true;
+                                        affected |= rebound[k].changed;
+                                }
+                        }
+
+                        if (derived) {
+                                symbol->class_info = nullptr;
+                                *(SymbolTableEntry **)released.alloc(
+                                        sizeof(SymbolTableEntry *)) = symbol;
+                        }
+                        if (affected) {
+                                changed->insert(symbol, 1);
+                        }
+                }
+        }
+
+        // bound again once they're all released so the next recheck still
+        // knows what they derive from
+        SymbolTableEntry **symbols = (SymbolTableEntry **)released.memory;
+        for (uint64_t i = 0; i < released.offset / sizeof(*symbols); ++i) {
+                pipeline->tables->class_hierarchy->info(symbols[i]);
+        }
+        released.destroy();
+}
+
+static bool recheck_body_is_affected(BodyRecord *record, PointerIndex *changed,
+                                     uint64_t *changed_atoms,
+                                     uint64_t changed_atom_count)
+{
+        for (uint32_t i = 0; i < record->read_count; ++i) {
+                SymbolTableEntry *read = record->reads[i];
+                if (changed->find(read)) {
+                        return true;
+                }
+
+                // a name that appeared or went away can change what another
+                // one with the same name resolves to
+                for (uint64_t j = 0; j < changed_atom_count; ++j) {
+                        if (read->key.atom == changed_atoms[j]) {
+                                return true;
+                        }
+                }
+        }
+
+        return false;
+}
+
+// types task's body again and replaces its record
+static void recheck_type_body(Pipeline *pipeline, BodyTask *task,
+                              BodyRecord *record, Tables *body_tables,
+                              Arena *scope_stack, Arena *records_arena)
+{
+        Tables *tables = pipeline->tables;
+        Module *module = task->module;
+
+        pipeline_body_scope_stack(pipeline, task, scope_stack);
+        body_tables->symbol_reads->clear();
+        type_parse_tree(task->function_def, &module->arena, scope_stack,
+                        body_tables, module->filename);
+
+        record_body(record, task, body_tables, records_arena,
+                    tables->type_stack);
+        tables->diagnostics->merge(body_tables->diagnostics);
+}
+
+// Re-parses module and types its top level again, which is where its
+// signatures come from. A function body is only typed again if its tree
+// changed or it read a symbol whose signature did, the others keep the
+// diagnostics they had moved to where the function is now. The bodies of
+// the other checked modules that read a changed symbol are typed again too.
+// Runs on the calling thread once the pipeline's workers are done
+static RecheckStats pipeline_recheck(Pipeline *pipeline, Module *module)
+{
+        RecheckStats stats = {};
+        Tables *tables = pipeline->tables;
+
+        InputStream input_stream = InputStream::create_from_file(module->filename);
+        if (!input_stream.contents) {
+                return stats;
+        }
+
+        Arena old_arena = module->arena;
+        ModuleRecords old_records = module->records;
+        module->import_list->destroy();
+
+        module->arena = Arena::init(GIGABYTES(2));
+        module->token_array = token_array_create_from_input_stream(
+                &module->arena, &input_stream);
+        module->token_array.filename = module->filename;
+        module->line_count = input_stream.line;
+        input_stream.destroy();
+
+        module->import_list = ImportList::create(&module->arena);
+        Tables module_tables = *tables;
+        module_tables.import_list = module->import_list;
+
+        Parser parser = {};
+        parser.token_arr = &module->token_array;
+        parser.ast_arena = &module->arena;
+        parser.scope = module->scope;
+        parser.tables = &module_tables;
+        parser.symbol_table_arena = pipeline->symbol_table_arena;
+        module->root = parse_statements(&parser).node;
+
+        // an import that wasn't there before isn't loaded until the next
+        // full check
+        module->imports = (Module **)module->arena.alloc(
+                module->import_list->list_index * sizeof(Module *));
+        module->import_count = 0;
+        for (uint64_t i = 0; i < module->import_list->list_index; ++i) {
+                AstNode *import_target = module->import_list->list[i];
+                std::string name;
+                pipeline_dotted_name(import_target->import_target.dotted_name,
+                                     &name);
+
+                Module *imported = pipeline->registry.find(
+                        name, atom_hash(name.c_str(), (uint32_t)name.size()));
+                if (!imported)
+                        continue;
+
+                module->imports[module->import_count++] = imported;
+                if (pipeline->lazy &&
+                    imported->position >= pipeline->input_module_count)
+                        import_target->import_target.module = imported->scope;
+        }
+
+        Arena rebound = Arena::init(MEGABYTES(1));
+        recheck_release_symbols(pipeline, module->scope, &old_arena,
+                                &module->arena, &rebound);
+        tables->subtype_cache->clear();
+        tables->diagnostics->remove_file(module->filename);
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        Arena deferred_bodies = Arena::init(MEGABYTES(64));
+        Arena symbol_reads = Arena::init(MEGABYTES(64));
+
+        scope_stack_push(&scope_stack, pipeline->main_scope);
+        if (module->scope != pipeline->main_scope)
+                scope_stack_push(&scope_stack, module->scope);
+
+        resolve_names(module->root, &scope_stack, tables->type_stack,
+                      tables->symbol_table);
+        type_signatures(module->root, &module->arena, &scope_stack,
+                        &module_tables, module->filename);
+
+        module_tables.deferred_bodies = &deferred_bodies;
+        type_parse_tree(module->root, &module->arena, &scope_stack,
+                        &module_tables, module->filename);
+        module_tables.deferred_bodies = nullptr;
+
+        module->records = {};
+        module->records.arena = Arena::init(MEGABYTES(64));
+        module->records.last_write_time = old_records.last_write_time;
+        record_signatures(module, tables);
+
+        // diff the signatures, a symbol is changed if its fingerprint is
+        // different or it's only in one of them
+        PointerIndex old_signatures =
+                PointerIndex::init(old_records.signature_count * 2);
+        for (uint32_t i = 0; i < old_records.signature_count; ++i) {
+                old_signatures.insert(old_records.signatures[i].symbol, i + 1);
+        }
+
+        PointerIndex changed = PointerIndex::init(16);
+        PointerIndex declared =
+                PointerIndex::init(module->records.signature_count * 2);
+        Arena changed_atoms = Arena::init(MEGABYTES(1));
+
+        for (uint32_t i = 0; i < module->records.signature_count; ++i) {
+                SignatureRecord *signature = &module->records.signatures[i];
+                uint32_t old = old_signatures.find(signature->symbol);
+                declared.insert(signature->symbol, 1);
+
+                if (old && old_records.signatures[old - 1].fingerprint ==
+                                   signature->fingerprint) {
+                        continue;
+                }
+
+                changed.insert(signature->symbol, 1);
+                if (!old) {
+                        uint64_t *atom = (uint64_t *)changed_atoms.alloc(
+                                sizeof(*atom));
+                        *atom = signature->symbol->key.atom;
+                }
+        }
+
+        for (uint32_t i = 0; i < old_records.signature_count; ++i) {
+                SymbolTableEntry *symbol = old_records.signatures[i].symbol;
+                if (declared.find(symbol)) {
+                        continue;
+                }
+
+                changed.insert(symbol, 1);
+                uint64_t *atom = (uint64_t *)changed_atoms.alloc(sizeof(*atom));
+                *atom = symbol->key.atom;
+        }
+
+        stats.changed_signatures = (uint32_t)changed.count;
+        recheck_release_derived_classes(pipeline, module,
+                                        (ReboundClass *)rebound.memory,
+                                        rebound.offset / sizeof(ReboundClass),
+                                        &changed);
+
+        PointerIndex old_bodies = PointerIndex::init(old_records.body_count * 2);
+        for (uint32_t i = 0; i < old_records.body_count; ++i) {
+                old_bodies.insert(old_records.bodies[i].function, i + 1);
+        }
+
+        DeferredBody *deferred = (DeferredBody *)deferred_bodies.memory;
+        uint32_t body_count =
+                (uint32_t)(deferred_bodies.offset / sizeof(DeferredBody));
+        Arena *records_arena = &module->records.arena;
+        module->records.bodies = (BodyRecord *)records_arena->alloc(
+                body_count * sizeof(BodyRecord));
+        module->records.body_count = body_count;
+        stats.body_count = body_count;
+
+        Tables body_tables = module_tables;
+        body_tables.symbol_reads = &symbol_reads;
+        body_tables.diagnostics = Diagnostics::create(records_arena, 0);
+
+        for (uint32_t i = 0; i < body_count; ++i) {
+                BodyTask task = {};
+                task.module = module;
+                task.function_def = deferred[i].function_def;
+                task.scope = deferred[i].scope;
+
+                BodyRecord *record = &module->records.bodies[i];
+                AstNode *function_def = task.function_def;
+                SymbolTableEntry *function = tables->symbol_table->lookup(
+                        function_def->function_def.name->token.value,
+                        task.scope);
+                uint64_t fingerprint =
+                        body_fingerprint(function_def, tables->type_stack);
+
+                uint32_t old = old_bodies.find(function);
+                BodyRecord *old_record =
+                        old ? &old_records.bodies[old - 1] : nullptr;
+
+                if (old_record && old_record->fingerprint == fingerprint &&
+                    !recheck_body_is_affected(
+                            old_record, &changed,
+                            (uint64_t *)changed_atoms.memory,
+                            changed_atoms.offset / sizeof(uint64_t))) {
+                        uint32_t line = function_def->token.line;
+
+                        *record = *old_record;
+                        record->line = line;
+                        record->reads = (SymbolTableEntry **)
+                                records_arena->alloc(record->read_count *
+                                                     sizeof(*record->reads));
+                        memcpy(record->reads, old_record->reads,
+                               record->read_count * sizeof(*record->reads));
+                        record->diagnostics = (Diagnostic *)records_arena->alloc(
+                                record->diagnostic_count * sizeof(Diagnostic));
+
+                        for (uint32_t j = 0; j < record->diagnostic_count; ++j) {
+                                Diagnostic *diagnostic = &record->diagnostics[j];
+                                *diagnostic = old_record->diagnostics[j];
+                                diagnostic->line += line - old_record->line;
+                                tables->diagnostics->report(
+                                        diagnostic->filename, diagnostic->line,
+                                        diagnostic->column,
+                                        diagnostic->message);
+                        }
+
+                        continue;
+                }
+
+                recheck_type_body(pipeline, &task, record, &body_tables,
+                                  &scope_stack, records_arena);
+                ++stats.bodies_typed;
+        }
+
+        // a module's scope can be shared so the other checked modules'
+        // bodies may read what this one declares
+        for (uint32_t i = 0; i < pipeline->input_module_count; ++i) {
+                Module *other = pipeline->modules[i];
+                if (other == module) {
+                        continue;
+                }
+
+                stats.body_count += other->records.body_count;
+                for (uint32_t j = 0; j < other->records.body_count; ++j) {
+                        BodyRecord *record = &other->records.bodies[j];
+                        if (!record->function ||
+                            !recheck_body_is_affected(
+                                    record, &changed,
+                                    (uint64_t *)changed_atoms.memory,
+                                    changed_atoms.offset / sizeof(uint64_t))) {
+                                continue;
+                        }
+
+                        // declared over by this module in a shared scope
+                        AstNode *function_def = record->function->value.node;
+                        if (!arena_contains(&other->arena, function_def)) {
+                                continue;
+                        }
+
+                        BodyTask task = {};
+                        task.module = other;
+                        task.function_def = function_def;
+                        task.scope = record->function->key.scope;
+                        task.index = j;
+
+                        tables->diagnostics->remove_reported(
+                                record->diagnostics, record->diagnostic_count);
+                        recheck_type_body(pipeline, &task, record,
+                                          &body_tables, &scope_stack,
+                                          &other->records.arena);
+                        ++stats.bodies_typed;
+                }
+        }
+
+        body_tables.diagnostics->destroy();
+        rebound.destroy();
+        changed_atoms.destroy();
+        declared.destroy();
+        changed.destroy();
+        old_bodies.destroy();
+        old_signatures.destroy();
+        symbol_reads.destroy();
+        deferred_bodies.destroy();
+        scope_stack.destroy();
+
+        if (old_records.arena.memory)
+                old_records.arena.destroy();
+        old_arena.destroy();
+
+        return stats;
+}
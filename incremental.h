@@ -0,0 +1,65 @@
+#ifndef INCREMENTAL_H_
+#define INCREMENTAL_H_
+
+#include <stdint.h>
+
+#include "utils.h"
+#include "tables.h"
+#include "diagnostics.h"
+
+struct AstNode;
+struct Module;
+struct Pipeline;
+struct BodyTask;
+
+#define WATCH_POLL_INTERVAL_MS 100
+
+// What typing one function body read and reported, kept between checks so
+// an edit only re-types the bodies whose outcome it can change
+struct BodyRecord {
+        // a re-parse declares the function into the same entry so this is
+        // what finds the body again
+        SymbolTableEntry *function;
+        // of the function's tree, positions aren't part of it
+        uint64_t fingerprint;
+        // where the function started when the diagnostics were reported
+        uint32_t line;
+        uint32_t read_count;
+        // sorted and unique
+        SymbolTableEntry **reads;
+        uint32_t diagnostic_count;
+        Diagnostic *diagnostics;
+};
+
+// What a symbol the module declares looked like to everything using it, a
+// function's parameter and return types, a class's bases, otherwise the type
+struct SignatureRecord {
+        SymbolTableEntry *symbol;
+        uint64_t fingerprint;
+};
+
+// Kept for each checked module when checking incrementally, a recheck builds
+// new records and frees the old ones
+struct ModuleRecords {
+        Arena arena;
+        BodyRecord *bodies;
+        uint32_t body_count;
+        SignatureRecord *signatures;
+        uint32_t signature_count;
+        uint64_t last_write_time;
+};
+
+struct RecheckStats {
+        uint32_t body_count;
+        uint32_t bodies_typed;
+        uint32_t changed_signatures;
+};
+
+static uint64_t file_last_write_time(const char *filename);
+static uint64_t body_fingerprint(AstNode *function_def, Arena *stack);
+static void record_body(BodyRecord *record, BodyTask *task, Tables *tables,
+                        Arena *arena, Arena *stack);
+static void record_signatures(Module *module, Tables *tables);
+static RecheckStats pipeline_recheck(Pipeline *pipeline, Module *module);
+
+#endif // INCREMENTAL_H_
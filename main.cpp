@@ -12,6 +12,13 @@
 #include "typing.cpp"
 #include "tables.cpp"
 #include "debug.cpp"
+#include "pipeline.cpp"
+#include "diagnostics.cpp"
+#include "traversal.cpp"
+#include "serialize.cpp"
+#include "resolve.cpp"
+#include "incremental.cpp"
+#include "summary.cpp"
 
 #if 0
 static inline void write_code_and_inc_offset(FILE *file, std::string string,
@@ -147,195 +154,96 @@ static inline double get_time_in_seconds_from_marker(uint64_t marker)
 }
 #endif
 
-static void python_path_overwrite_filepart(PythonPath *path, const char *filename, size_t filename_length)
+// every .py file under the directory becomes its own module
+static void pipeline_submit_directory(Pipeline *pipeline, const char *directory)
 {
-        memset(path->file_part, 0, path->length_from_file_part);
-        strncpy_s(path->file_part, path->length_from_file_part, filename,
-                  filename_length);
-}
-
-static bool name_is_in_import_list(ImportList *list, AstNode *target)
-{
-        if (!target) {
-               return false;
-        }
+        char search_path[MAX_PATH] = {};
+        snprintf(search_path, sizeof(search_path), "%s\\*", directory);
 
-        for (int i = 0; i < list->list_index; ++i) {
-                AstNode *node = list->list[i];
-
-                if (!node) {
-                        continue;
-                }
-
-                if (node->import_target.dotted_name->token.value ==
-                    target->import_target.dotted_name->token.value) {
-                        return true;
-
-                }
-        }
-
-        return false;
-}
+        WIN32_FIND_DATAA find_data = {};
+        HANDLE find_handle = FindFirstFileA(search_path, &find_data);
 
-void parse_and_type_import_files_recursively(
-        PythonPath *path, Arena *parse_arena, AstNode **node_in_list,
-        Tables *tables, Arena *symbol_table_arena, Arena *scope_stack)
-{
-        if (!(*node_in_list)) {
+        if (find_handle == INVALID_HANDLE_VALUE) {
                 return;
         }
 
-        std::string filename =
-                (*node_in_list)->import_target.dotted_name->token.value;
-
-        SymbolTableValue symbol_value = {};
-        symbol_value.static_type.type = TypeInfoType::INTEGER;
-        symbol_value.node = *node_in_list;
-        SymbolTableEntry *scope = tables->symbol_table->insert(
-                symbol_table_arena, filename, 0, &symbol_value);
-
-        InputStream input_stream;
-
-        if (filename == "sys") {
-                input_stream = InputStream::create_from_file("sysmodule.tpy");
-        } else if (filename == "import_test") {
-                input_stream = InputStream::create_from_file("import_test.py");
-        } else {
-                filename += ".py";
-                python_path_overwrite_filepart(path, filename.c_str(),
-                                               filename.length());
-                input_stream = InputStream::create_from_file(path->path_buffer);
-        }
-
-        if (!input_stream.contents) {
-                perror("Error reading import file");
-                exit(1);
-        }
-
-        // initilise tokeniser
-        TokenArray token_array = token_array_create_from_input_stream(parse_arena, &input_stream);
-        Parser parser =  {};
-        parser.token_arr = &token_array;
-        parser.ast_arena = parse_arena;
-        parser.tables = tables;
-        parser.symbol_table_arena = symbol_table_arena;
-        ParseResult result = parse_statements(&parser);
-        AstNode *root = result.node;
-
+        do {
+                const char *name = find_data.cFileName;
+                if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+                        continue;
+                }
 
-        *node_in_list = nullptr;
+                char file_path[MAX_PATH] = {};
+                snprintf(file_path, sizeof(file_path), "%s\\%s", directory,
+                         name);
 
-        for (int i = 0; i < tables->import_list->list_index; ++i) {
-                AstNode **node = &tables->import_list->list[i];
-                if (name_is_in_import_list(tables->import_list, *node)) {
+                if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                        pipeline_submit_directory(pipeline, file_path);
                         continue;
                 }
 
-                parse_and_type_import_files_recursively(path, parse_arena, node,
-                                                        tables,
-                                                        symbol_table_arena,
-                                                        scope_stack);
-        }
+                size_t length = strlen(name);
+                if (length > 3 && strcmp(name + length - 3, ".py") == 0) {
+                        pipeline->submit(file_path, file_path, nullptr);
+                }
+        } while (FindNextFileA(find_handle, &find_data));
 
-        scope_stack_push(scope_stack, scope);
-        type_parse_tree(root, parse_arena, scope_stack, tables, filename.c_str());
-        input_stream.destroy();
+        FindClose(find_handle);
 }
 
-int main(int argc, char *argv[])
+static void check_builtin_stubs(Tables *tables, Arena *parse_arena,
+                                Arena *symbol_table_arena,
+                                SymbolTableEntry *main_scope, AstNode *main_node)
 {
-
-        uint64_t start = set_marker();
-        if (argc != 2) {
-                perror("Please specify a file");
-                return EXIT_FAILURE;
-        }
-
+        // parse builtin definitions to pull into symbol table
         InputStream builtin_input_stream =
                 InputStream::create_from_file("builtins.tpy");
-        //initilise input stream
-        InputStream input_stream = InputStream::create_from_file(argv[1]);
-        if (!input_stream.contents) {
-                return EXIT_FAILURE;
-        }
-
-        PythonPath path = {};
-        SearchPathA(0, "python.exe", 0, sizeof(path.path_buffer),
-                    path.path_buffer, &path.file_part);
-
-        path.length_from_file_part =
-                path.path_buffer + sizeof(path.path_buffer) - path.file_part;
-
-        // write over the pymthon.exe part with zeros
-        memset(path.file_part, 0, path.length_from_file_part);
-        char lib_dir[] = "Lib\\";
-        for (int i = 0;
-             i < sizeof(lib_dir) - 1 && i < path.length_from_file_part; ++i) {
-                *(path.file_part++) = lib_dir[i];
-        }
-        // recompute length
-        path.length_from_file_part =
-                path.path_buffer + sizeof(path.path_buffer) - path.file_part;
-
-        Arena parse_arena = Arena::init(GIGABYTES(8));
-        Arena symbol_table_arena = Arena::init(GIGABYTES(2));
-        Tables tables = Tables::init(&symbol_table_arena);
-        SymbolTableValue main_symbol_value = {};
-        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
-
-        // all entries in symbol table require a reference to a node
-        AstNode main_node = {};
-        main_symbol_value.node = &main_node;
-
-        SymbolTableEntry *main_scope = tables.symbol_table->insert(
-                &symbol_table_arena, "main", 0, &main_symbol_value);
-
-        // initilise a stack for scopes when typing
-        // parse builtin definitions to pull into symbol table
         TokenArray builtin_token_array = token_array_create_from_input_stream(
-                &parse_arena, &builtin_input_stream);
+                parse_arena, &builtin_input_stream);
 
         Parser parser = {};
         parser.token_arr = &builtin_token_array;
-        parser.ast_arena = &parse_arena;
-        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = parse_arena;
+        parser.symbol_table_arena = symbol_table_arena;
         parser.scope = main_scope;
-        parser.tables = &tables;
+        parser.tables = tables;
 
         ParseResult builtin_result = parse_statements(&parser);
         AstNode *builtin_root = builtin_result.node;
 
         Arena scope_stack = Arena::init(sizeof(void *) * 1000);
         scope_stack_push(&scope_stack, main_scope);
-        type_parse_tree(builtin_root, &parse_arena, &scope_stack, &tables,
-                        input_stream.filename);
+        resolve_names(builtin_root, &scope_stack, tables->type_stack,
+                      tables->symbol_table);
+        type_parse_tree(builtin_root, parse_arena, &scope_stack, tables,
+                        builtin_input_stream.filename);
 
         // ==== BUILTIN TYPES ====
         SymbolTableValue builtin_value = {};
-        builtin_value.node = &main_node;
+        builtin_value.node = main_node;
         builtin_value.static_type.type = TypeInfoType::INTEGER;
-        tables.symbol_table->insert(&symbol_table_arena, "int", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "int", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::FLOAT;
-        tables.symbol_table->insert(&symbol_table_arena, "float", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "float", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::STRING;
-        tables.symbol_table->insert(&symbol_table_arena, "str", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "str", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::BOOLEAN;
-        tables.symbol_table->insert(&symbol_table_arena, "bool", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "bool", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::COMPLEX;
-        tables.symbol_table->insert(&symbol_table_arena, "complex", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "complex", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::LIST;
-        tables.symbol_table->insert(&symbol_table_arena, "list", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "list", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::DICT;
-        tables.symbol_table->insert(&symbol_table_arena, "dict", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "dict", main_scope,
                                     &builtin_value);
         builtin_value.static_type.type = TypeInfoType::NONE;
-        tables.symbol_table->insert(&symbol_table_arena, "None", main_scope,
+        tables->symbol_table->insert(symbol_table_arena, "None", main_scope,
                                     &builtin_value);
 
         builtin_value.static_type.type = TypeInfoType::ANY;
@@ -411,37 +319,349 @@ int main(int argc, char *argv[])
         Py_DecRef(builtins_list);
         Py_DecRef(builtins_list);
 #endif
-        uint64_t parser_mark = set_marker();
-        TokenArray token_array = token_array_create_from_input_stream(
-                &parse_arena, &input_stream);
+
+        scope_stack.destroy();
+}
+
+// sys is otherwise checked as a module the first time it's imported, this
+// checks it the same way the pipeline would
+static SymbolTableEntry *check_sys_stub(Tables *tables, Arena *parse_arena,
+                                        Arena *symbol_table_arena,
+                                        SymbolTableEntry *main_scope,
+                                        AstNode *main_node)
+{
+        InputStream input_stream =
+                InputStream::create_from_file("sysmodule.tpy");
+        TokenArray token_array =
+                token_array_create_from_input_stream(parse_arena, &input_stream);
+        token_array.filename = input_stream.filename;
+
+        SymbolTableValue symbol_value = {};
+        symbol_value.static_type.type = TypeInfoType::INTEGER;
+        symbol_value.node = main_node;
+        SymbolTableEntry *sys_scope = tables->symbol_table->insert(
+                symbol_table_arena, "sys", 0, &symbol_value);
+
+        Parser parser = {};
         parser.token_arr = &token_array;
+        parser.ast_arena = parse_arena;
+        parser.symbol_table_arena = symbol_table_arena;
+        parser.scope = sys_scope;
+        parser.tables = tables;
 
         ParseResult result = parse_statements(&parser);
-        AstNode *root = result.node;
-
-        for (int i = 0; i < tables.import_list->list_index; ++i) {
-                AstNode **node = &tables.import_list->list[i];
-                parse_and_type_import_files_recursively(&path, &parse_arena,
-                                                        node, &tables,
-                                                        &symbol_table_arena,
-                                                        &scope_stack);
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        scope_stack_push(&scope_stack, sys_scope);
+        resolve_names(result.node, &scope_stack, tables->type_stack,
+                      tables->symbol_table);
+        type_parse_tree(result.node, parse_arena, &scope_stack, tables,
+                        input_stream.filename);
+
+        scope_stack.destroy();
+        return sys_scope;
+}
+
+// what a snapshot was written from, it's stale once either stub changes
+static uint64_t builtin_stubs_hash()
+{
+        const char *stubs[] = {"builtins.tpy", "sysmodule.tpy"};
+        uint64_t hash = 0;
+        for (int i = 0; i < array_count(stubs); ++i) {
+                InputStream input_stream =
+                        InputStream::create_from_file(stubs[i]);
+                hash = (hash ^ summary_hash_bytes(input_stream.contents,
+                                                  input_stream.size)) *
+                       1099511628211ull;
+                input_stream.destroy();
         }
 
-        printf("Finished Parsing, time elasped: %fs\n",
-               get_time_in_seconds_from_marker(parser_mark));
+        return hash;
+}
 
+// The snapshot is mapped rather than read and every symbol in it declared
+// in symbol_table, returns false when there's no snapshot or it's stale.
+// This saves lexing, parsing and typing the stubs but each symbol is still
+// decoded and inserted, so loading is linear in the stubs' size
+static bool load_builtins_snapshot(const char *filename, Tables *tables,
+                                   Arena *parse_arena,
+                                   Arena *symbol_table_arena)
+{
+        HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (file == INVALID_HANDLE_VALUE) {
+                return false;
+        }
 
-        debug_print_parse_tree(root, 0);
+        LARGE_INTEGER file_size = {};
+        HANDLE mapping = nullptr;
+        const void *data = nullptr;
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart) {
+                mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+        }
+        if (mapping) {
+                data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
 
-        //type
-        uint64_t type_checking_mark = set_marker();
-        type_parse_tree(root, &parse_arena, &scope_stack, &tables,
-                        input_stream.filename);
+        bool loaded = data &&
+                      serialized_scopes_source_hash(data, file_size.QuadPart) ==
+                              builtin_stubs_hash() &&
+                      deserialize_scopes(data, file_size.QuadPart, parse_arena,
+                                         symbol_table_arena,
+                                         tables->symbol_table);
+
+        if (data)
+                UnmapViewOfFile(data);
+        if (mapping)
+                CloseHandle(mapping);
+        CloseHandle(file);
+
+        return loaded;
+}
+
+static bool parse_command_line(int argc, char *argv[], CheckerOptions *options)
+{
+        for (int i = 1; i < argc; ++i) {
+                if (strcmp(argv[i], "--print-ast") == 0) {
+                        options->print_ast = true;
+                } else if (strcmp(argv[i], "--write-snapshot") == 0) {
+                        options->write_snapshot = true;
+                } else if (strcmp(argv[i], "--lazy") == 0) {
+                        options->lazy = true;
+                } else if (strcmp(argv[i], "--watch") == 0) {
+                        options->watch = true;
+                } else if (strcmp(argv[i], "--cache-dir") == 0 &&
+                           i + 1 < argc) {
+                        options->cache_directory = argv[++i];
+                } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+                        options->workers_per_stage = atoi(argv[++i]);
+                } else if (strcmp(argv[i], "--max-errors") == 0 && i + 1 < argc) {
+                        options->max_errors = atoi(argv[++i]);
+                } else if (argv[i][0] == '-') {
+                        fprintf(stderr, "Unknown option %s\n", argv[i]);
+                        return false;
+                } else if (!options->input_path) {
+                        options->input_path = argv[i];
+                } else {
+                        fprintf(stderr, "Only one file or directory can be checked at a time\n");
+                        return false;
+                }
+        }
+
+        if (!options->input_path && !options->write_snapshot) {
+                fprintf(stderr, "Please specify a file or directory\n");
+                return false;
+        }
+
+        return true;
+}
+
+// Polls the checked modules and rechecks any that's written to, only the
+// function bodies an edit can affect are typed again, in whichever checked
+// module they are. Never returns
+static void watch_modules(Pipeline *pipeline)
+{
+        for (uint32_t i = 0; i < pipeline->input_module_count; ++i) {
+                Module *module = pipeline->modules[i];
+                record_signatures(module, pipeline->tables);
+                module->records.last_write_time =
+                        file_last_write_time(module->filename);
+        }
+
+        printf("Watching %d modules for changes\n",
+               pipeline->input_module_count);
+        fflush(stdout);
+
+        while (true) {
+                Sleep(WATCH_POLL_INTERVAL_MS);
+
+                for (uint32_t i = 0; i < pipeline->input_module_count; ++i) {
+                        Module *module = pipeline->modules[i];
+                        uint64_t write_time =
+                                file_last_write_time(module->filename);
+                        if (!write_time ||
+                            write_time == module->records.last_write_time) {
+                                continue;
+                        }
+
+                        module->records.last_write_time = write_time;
+
+                        uint64_t recheck_mark = set_marker();
+                        RecheckStats stats = pipeline_recheck(pipeline, module);
+                        printf("Rechecked %s, %d changed signatures, typed %d of %d function bodies, time elapsed: %fs\n",
+                               module->filename, stats.changed_signatures,
+                               stats.bodies_typed, stats.body_count,
+                               get_time_in_seconds_from_marker(recheck_mark));
+
+                        uint32_t error_count =
+                                pipeline->tables->diagnostics->print(stderr);
+                        if (error_count)
+                                fprintf(stderr, "Found %d errors\n",
+                                        error_count);
+
+                        fflush(stdout);
+                }
+        }
+}
+
+int main(int argc, char *argv[])
+{
+
+        uint64_t start = set_marker();
+        CheckerOptions options = {};
+        options.max_errors = DEFAULT_MAX_ERRORS;
+        if (!parse_command_line(argc, argv, &options)) {
+                fprintf(stderr, "usage: %s [--print-ast] [--lazy] [--watch] [--cache-dir directory] [--jobs n] [--max-errors n] file|directory\n"
+                                "       %s --write-snapshot\n",
+                        argv[0], argv[0]);
+                return EXIT_FAILURE;
+        }
+
+        DWORD input_attributes = options.input_path ?
+                                         GetFileAttributesA(options.input_path) :
+                                         0;
+        if (input_attributes == INVALID_FILE_ATTRIBUTES) {
+                perror("Couldn't open file");
+                return EXIT_FAILURE;
+        }
+
+        if (!options.workers_per_stage) {
+                options.workers_per_stage = pipeline_default_workers_per_stage();
+        }
+
+        if (options.cache_directory &&
+            !CreateDirectoryA(options.cache_directory, 0) &&
+            GetLastError() != ERROR_ALREADY_EXISTS) {
+                perror("Couldn't create the cache directory");
+                return EXIT_FAILURE;
+        }
+
+        PythonPath path = {};
+        SearchPathA(0, "python.exe", 0, sizeof(path.path_buffer),
+                    path.path_buffer, &path.file_part);
+
+        path.length_from_file_part =
+                path.path_buffer + sizeof(path.path_buffer) - path.file_part;
 
-        printf("Finished Type checking, time elasped: %fs\n",
-               get_time_in_seconds_from_marker(type_checking_mark));
+        // write over the pymthon.exe part with zeros
+        memset(path.file_part, 0, path.length_from_file_part);
+        char lib_dir[] = "Lib\\";
+        for (int i = 0;
+             i < sizeof(lib_dir) - 1 && i < path.length_from_file_part; ++i) {
+                *(path.file_part++) = lib_dir[i];
+        }
+        // recompute length
+        path.length_from_file_part =
+                path.path_buffer + sizeof(path.path_buffer) - path.file_part;
 
-        debug_print_parse_tree(root, 0);
+        Arena parse_arena = Arena::init(GIGABYTES(8));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(2));
+        Tables tables = Tables::init(&symbol_table_arena);
+        // a recheck replaces a module's errors so none can be fatal
+        tables.diagnostics->max_errors = options.watch ? 0 : options.max_errors;
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+
+        // all entries in symbol table require a reference to a node
+        AstNode main_node = {};
+        main_symbol_value.node = &main_node;
+
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, "main", 0, &main_symbol_value);
+
+        // the stubs are checked once by --write-snapshot and every run after
+        // that declares them from the snapshot
+        bool snapshot_loaded =
+                !options.write_snapshot &&
+                load_builtins_snapshot(BUILTINS_SNAPSHOT_FILENAME, &tables,
+                                       &parse_arena, &symbol_table_arena);
+        if (!snapshot_loaded) {
+                check_builtin_stubs(&tables, &parse_arena, &symbol_table_arena,
+                                    main_scope, &main_node);
+        }
+
+        if (options.write_snapshot) {
+                SymbolTableEntry *scopes[] = {
+                        main_scope,
+                        check_sys_stub(&tables, &parse_arena,
+                                       &symbol_table_arena, main_scope,
+                                       &main_node),
+                };
+
+                Arena snapshot = Arena::init(GIGABYTES(1));
+                uint64_t size = serialize_scopes(tables.symbol_table, scopes,
+                                                 array_count(scopes),
+                                                 builtin_stubs_hash(),
+                                                 &snapshot);
+
+                FILE *snapshot_file = nullptr;
+                fopen_s(&snapshot_file, BUILTINS_SNAPSHOT_FILENAME, "wb");
+                if (!snapshot_file ||
+                    fwrite(snapshot.memory, 1, size, snapshot_file) != size) {
+                        perror("Couldn't write " BUILTINS_SNAPSHOT_FILENAME);
+                        return EXIT_FAILURE;
+                }
+
+                fclose(snapshot_file);
+                printf("Wrote %llu bytes to %s\n", (unsigned long long)size,
+                       BUILTINS_SNAPSHOT_FILENAME);
+
+                snapshot.destroy();
+                return tables.diagnostics->print(stderr) ? EXIT_FAILURE : 0;
+        }
+
+        // lex, parse and type every module on the pipeline, imports are
+        // submitted by the parse workers as they are found
+        uint64_t pipeline_mark = set_marker();
+        Pipeline *pipeline = Pipeline::create(&parse_arena, &tables,
+                                              &symbol_table_arena, main_scope,
+                                              &main_node, &path,
+                                              options.workers_per_stage);
+        pipeline->lazy = options.lazy;
+        pipeline->incremental = options.watch;
+        pipeline->cache_directory = options.cache_directory;
+
+        std::string sys_name = "sys";
+        SymbolTableEntry *sys_scope =
+                snapshot_loaded ?
+                        tables.symbol_table->lookup(sys_name, nullptr) :
+                        nullptr;
+        if (sys_scope) {
+                pipeline->add_loaded(sys_name, sys_scope);
+        }
+
+        if (input_attributes & FILE_ATTRIBUTE_DIRECTORY) {
+                pipeline_submit_directory(pipeline, options.input_path);
+        } else {
+                pipeline->submit(options.input_path, options.input_path,
+                                 main_scope);
+        }
+
+        uint32_t input_module_count = pipeline->module_count;
+        pipeline->run();
+
+        // the workers stop typing once the cap is reached
+        if (tables.diagnostics->stopped) {
+                tables.diagnostics->print(stderr);
+                fprintf(stderr, "Stopping after %d errors\n",
+                        tables.diagnostics->count);
+                return EXIT_FAILURE;
+        }
+
+        printf("Finished Parsing & Type checking %d modules with %d workers per stage, time elasped: %fs\n",
+               pipeline->module_count, pipeline->workers_per_stage,
+               get_time_in_seconds_from_marker(pipeline_mark));
+
+        uint32_t line_count = 0;
+        for (uint32_t i = 0; i < input_module_count; ++i) {
+                Module *module = pipeline->modules[i];
+                line_count += module->line_count;
+
+                // modules loaded from the cache have no tree
+                if (options.print_ast && module->root)
+                        debug_print_parse_tree(module->root, 0);
+        }
 
         //FILE *output_f;
         //fopen_s(&output_f, "out.c", "w");
@@ -449,11 +669,43 @@ int main(int argc, char *argv[])
         //fprintf_s(output_f, "return 0;}");
         //fclose(output_f);
 
-        printf("Finished Parsing & Typechecking %d lines time elasped: %fs",
-               input_stream.line, get_time_in_seconds_from_marker(start));
+        printf("Finished Parsing & Typechecking %d lines time elasped: %fs\n",
+               line_count, get_time_in_seconds_from_marker(start));
+        printf("Subtype cache: %ld hits, %ld misses\n",
+               (long)tables.subtype_cache->hits,
+               (long)tables.subtype_cache->misses);
+        if (options.lazy) {
+                printf("Typed %ld of %ld imported declarations on demand\n",
+                       (long)tables.lazy_declarations->typed,
+                       (long)tables.lazy_declarations->declared);
+        }
+        if (options.cache_directory) {
+                uint32_t summaries_written = pipeline_write_summaries(pipeline);
+                printf("Loaded %ld module summaries from %s, wrote %d\n",
+                       (long)pipeline->summaries_loaded,
+                       options.cache_directory, summaries_written);
+        }
+
+        // filenames in the diagnostics point into the modules so print
+        // before they're freed
+        uint32_t error_count = tables.diagnostics->print(stderr);
+        if (error_count)
+                fprintf(stderr, "Found %d errors\n", error_count);
+
+        if (options.watch) {
+                watch_modules(pipeline);
+        }
+
         // free
+        pipeline->destroy();
+        tables.type_stack->destroy();
+        tables.diagnostics->destroy();
+        tables.subtype_cache->destroy();
+        tables.call_signatures->destroy();
+        tables.lazy_declarations->destroy();
+        tables.type_interner->destroy();
         symbol_table_arena.destroy();
         parse_arena.destroy();
 
-        return 0;
+        return error_count ? EXIT_FAILURE : 0;
 }
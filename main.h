@@ -2,11 +2,38 @@
 #define TPYTHON_H_
 
 #define introspect
+#define payload(...)
+#define schema
 #define array_count(arr) sizeof(arr)/sizeof(arr[0])
+// the checked builtins.tpy and sysmodule.tpy, written by --write-snapshot
+#define BUILTINS_SNAPSHOT_FILENAME "builtins.tpysnap"
 
 //TODO remove dependency look into std::string performance potentially remove dependancy
 //or make useage more performant and idomatic
 
+struct CheckerOptions {
+        // a single file or a directory that is searched for .py files
+        const char *input_path;
+        // dumping the tree is recursive and prints every node twice which
+        // dominates runtime on large generated inputs so it is opt in
+        bool print_ast;
+        // 0 picks a default from the processor count
+        uint32_t workers_per_stage;
+        // stop once this many errors have been found, 0 reports them all
+        uint32_t max_errors;
+        // only type the declarations of imported modules that the checked
+        // ones use
+        bool lazy;
+        // keep running and recheck a checked file whenever it's saved
+        bool watch;
+        // load the summaries of unchanged modules from this directory
+        // instead of checking them and write the ones that were checked
+        const char *cache_directory;
+        // check the stubs and write them to BUILTINS_SNAPSHOT_FILENAME
+        // instead of checking input_path
+        bool write_snapshot;
+};
+
 struct PythonPath {
         char path_buffer[2048];
         char *file_part;
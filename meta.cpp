@@ -1,3 +1,4 @@
 #include <stdint.h>
 #include "meta.h"
+#include "serialize.h"
 #include "generation/generated.h"
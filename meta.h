@@ -2,6 +2,10 @@
 #define META_H_
 #include <stdint.h>
 #define introspect
+// marks the union member holding a struct for the listed tag values
+#define payload(...)
+// marks something serialized by hand so it's covered by the schema hash
+#define schema
 
 enum MetaType {
         TYPE_int,
@@ -19,6 +23,16 @@ struct StructMemberDefinition {
         uint64_t offset;
 };
 
+// What a tagged union holds for one tag value, the generated tables are
+// indexed by the tag
+struct PayloadDefinition {
+        StructMemberDefinition *members;
+        uint32_t member_count;
+        // offsets of just the members pointing at child nodes
+        uint16_t *child_offsets;
+        uint32_t child_count;
+};
+
 struct EnumMemberDefinition {
         const char *name;
         int value;
@@ -236,6 +236,8 @@ static ParseResult parse_list_of_names_and_return_modifier(Parser *parser,
         AstNode *parent = node_alloc(parser->ast_arena);
         parent->type = AstNodeType::NARY;
         parent->token = token;
+        // skip the global or nonlocal keyword
+        parser->token_arr->next_token();
         ParseResult result =
                 parse_name(parser, false); 
 
@@ -317,25 +319,28 @@ static ParseResult parse_type_annotation(Parser *parser)
                 return result;
         }
 
-        AstNode *left = result.node;
+        AstNode *head = result.node;
+        AstNode **right = &head;
 
-        if (parser->token_arr->current.type == TokenType::BWOR) {
+        // unions are right leaning: a | b | c becomes a | (b | c)
+        while (parser->token_arr->current.type == TokenType::BWOR) {
                 AstNode *union_type = node_alloc(parser->ast_arena);
                 union_type->type = AstNodeType::UNION;
                 union_type->token = parser->token_arr->current;
-                union_type->union_type.left = left;
+                union_type->union_type.left = *right;
+                *right = union_type;
+                right = &union_type->union_type.right;
                 parser->token_arr->next_token();
-                result = parse_type_annotation(parser);
+
+                result = parse_type_expression(parser);
 
                 if (result.error.type != ParseErrorType::NONE)
                         return result;
 
-                union_type->union_type.right = result.node;
-
-                return ParseResult{.node = union_type};
-        } else {
-                return ParseResult{.node = left};
+                *right = result.node;
         }
+
+        return ParseResult{.node = head};
 }
 
 static ParseResult 
@@ -583,6 +588,7 @@ static ParseResult parse_function_call_arguments(Parser *parser)
                                 return assert_result;
 
                         AstNode *kwarg = node_alloc(parser->ast_arena);
+                        kwarg->type = AstNodeType::KWARG;
                         kwarg->token = parser->token_arr->current;
                         // FIXME add to symbol table
                         ParseResult result = parse_name(parser, true);
@@ -824,7 +830,8 @@ static ParseResult parse_sub_primary(Parser *parser, AstNode *left, bool add_to_
                 call->function_call.args = result.node;
                 call->function_call.expression = left;
 
-                return parse_sub_primary(parser, call, false);
+                // callers loop over sub primaries so chained calls don't recurse
+                return ParseResult{.node = call};
 
         } else if (current_token.type == TokenType::SQUARE_OPEN_PAREN) {
                 parser->token_arr->next_token();
@@ -851,7 +858,7 @@ static ParseResult parse_sub_primary(Parser *parser, AstNode *left, bool add_to_
                         return assert_result;
                 parser->token_arr->next_token();
 
-                return parse_sub_primary(parser, subscript, add_to_symbol_table);
+                return ParseResult{.node = subscript};
         } else {
                 return ParseResult{.node = left};
         }
@@ -1058,6 +1065,8 @@ static ParseResult parse_function_def_arguments(Parser *parser, AstNodeFunctionD
         AstNode **arg = &arg_head;
         int arg_position = 0;
         bool defaults_only = false;
+        function->star_pos = -1;
+        function->slash_pos = -1;
 
         while (parser->token_arr->current.type != TokenType::CLOSED_PAREN) {
                 Token current_token = parser->token_arr->current;
@@ -1083,6 +1092,9 @@ static ParseResult parse_function_def_arguments(Parser *parser, AstNodeFunctionD
                         }
 
                         function->star_pos = arg_position++;
+                        // keyword only arguments can go without a default
+                        // whatever comes before
+                        defaults_only = false;
                         if (parser->token_arr->current.type ==
                             TokenType::CLOSED_PAREN)
                                 break;
@@ -1603,59 +1615,74 @@ static ParseResult parse_tuple_or_genxpr_from_first_child(Parser *parser,
         return ParseResult{.node = node};
 }
 
-static ParseResult parse_atom(Parser *parser, bool add_to_symbol_table)
+// NOTE: the common '{key: value, ...}' form is handled by the expression
+// stack, this covers everything else that can follow the first expression
+static ParseResult parse_set_or_dict_from_first_expression(Parser *parser,
+                                                           AstNode *node,
+                                                           AstNode *expression,
+                                                           AstNode *first_child)
 {
-        if (parser->token_arr->current.type == TokenType::SQUARE_OPEN_PAREN) {
-                //parse list
-                AstNode *node = node_alloc(parser->ast_arena);
-                node->token = parser->token_arr->current;
-                node->type = AstNodeType::LIST;
+        if (parser->token_arr->current.type == TokenType::EXPONENTIATION) {
+                ParseResult result = parse_double_starred_kvpairs(parser);
 
-                parser->token_arr->next_token();
+                if (result.error.type != ParseErrorType::NONE)
+                        return result;
 
-                if (parser->token_arr->current.type ==
-                    TokenType::SQUARE_CLOSED_PAREN) {
-                        parser->token_arr->next_token();
-                        return ParseResult{.node = node};
-                }
+                node->dict.children = result.node;
+                return ParseResult{.node = node};
+        }
 
-                ParseResult result = parse_single_assignment_star_expression(parser);
+        if (parser->token_arr->current.type == TokenType::COLON_EQUAL) {
+                ParseResult result = parse_assignment_or_declaration(parser,
+                                                                     expression);
 
                 if (result.error.type != ParseErrorType::NONE)
                         return result;
 
-                node->list.children = result.node;
+                node->dict.children = result.node;
+                return ParseResult{.node = node};
+        }
 
-                if (parser->token_arr->current.type == TokenType::FOR) {
-                        parser->token_arr->next_token();
-                        node->type = AstNodeType::LISTCOMP;
-                        result = parse_for_if_clauses(parser);
+        // parse set definition
+        if (parser->token_arr->current.type == TokenType::FOR) {
+                parser->token_arr->next_token();
+                ParseResult result = parse_single_for_if_clause(parser);
 
-                        if (result.error.type != ParseErrorType::NONE)
-                                return result;
+                if (result.error.type != ParseErrorType::NONE)
+                        return result;
 
-                        node->list.children = result.node;
-                }
+                first_child->adjacent_child = result.node;
+        }
 
-                if (parser->token_arr->current.type == TokenType::COMMA) {
-                        parser->token_arr->next_token();
-                        result =
-                                parse_assignment_star_expressions(parser, false);
+        else {
+                parser->token_arr->next_token();
+                ParseResult result =
+                        parse_assignment_star_expressions(parser, false);
 
-                        if (result.error.type != ParseErrorType::NONE)
-                                return result;
+                if (result.error.type != ParseErrorType::NONE)
+                        return result;
 
-                        node->list.children->adjacent_child = result.node;
-                }
+                first_child->adjacent_child = result.node;
+        }
 
-                ParseResult assert_result = assert_token_and_print_debug(
-                        parser, TokenType::SQUARE_CLOSED_PAREN,
-                        "Mismatched parenthesis in list");
+        ParseResult assert_result = assert_token_and_print_debug(
+                parser, TokenType::CURLY_CLOSED_PAREN,
+                "Mismatched '}' in set definition");
 
-                if (assert_result.error.type != ParseErrorType::NONE)
-                        return assert_result;
-                parser->token_arr->next_token();
-                return ParseResult{.node = node};
+        if (assert_result.error.type != ParseErrorType::NONE)
+                return assert_result;
+        parser->token_arr->next_token();
+
+        return ParseResult{.node = node};
+}
+
+static ParseResult parse_atom(Parser *parser, bool add_to_symbol_table)
+{
+        if (parser->token_arr->current.type == TokenType::SQUARE_OPEN_PAREN ||
+            parser->token_arr->current.type == TokenType::CURLY_OPEN_PAREN) {
+                // list and dict displays nest arbitrarily deep in data files
+                return parse_expression_with_stack(
+                        parser, ExpressionAction::ENTER_DISPLAY, 0);
         } else if (parser->token_arr->current.type == TokenType::OPEN_PAREN) {
                 // parse tuple
                 Token token = parser->token_arr->current;
@@ -1680,125 +1707,6 @@ static ParseResult parse_atom(Parser *parser, bool add_to_symbol_table)
                 return parse_tuple_or_genxpr_from_first_child(parser, 
                                                               first_child);
 
-        } else if (parser->token_arr->current.type ==
-                   TokenType::CURLY_OPEN_PAREN) {
-                AstNode *node = node_alloc(parser->ast_arena);
-                node->token = parser->token_arr->current;
-                parser->token_arr->next_token();
-
-                if (parser->token_arr->current.type ==
-                    TokenType::CURLY_CLOSED_PAREN) {
-                        parser->token_arr->next_token();
-                        node->type = AstNodeType::DICT;
-                        return ParseResult{.node = node};
-                }
-
-                AstNode maybe_first_child = {};
-                maybe_first_child.token = parser->token_arr->current;
-                ParseResult result = parse_expression(parser, 0);
-
-                if (result.error.type != ParseErrorType::NONE)
-                        return result;
-
-                AstNode *expression = result.node;
-
-                node->type = AstNodeType::DICT;
-                if (parser->token_arr->current.type ==
-                    TokenType::EXPONENTIATION) {
-                        result = parse_double_starred_kvpairs(parser);
-
-                        if (result.error.type != ParseErrorType::NONE)
-                                return result;
-
-                        node->dict.children = result.node;
-                        return ParseResult{.node = node};
-                }
-
-                if (parser->token_arr->current.type == TokenType::COLON_EQUAL) {
-                        result = parse_assignment_or_declaration(parser, 
-                                                                 expression);
-
-                        if (result.error.type != ParseErrorType::NONE)
-                                return result;
-
-                        node->dict.children = result.node;
-                        return ParseResult{.node = node};
-                }
-
-                AstNode *first_child = node_alloc(parser->ast_arena);
-                first_child->token = maybe_first_child.token;
-
-                if (parser->token_arr->current.type == TokenType::COLON) {
-                        node->dict.children = first_child;
-                        parser->token_arr->next_token();
-                        first_child->type = AstNodeType::KVPAIR;
-                        AstNodeKvPair *kvpair = &first_child->kvpair;
-
-                        kvpair->key = expression;
-                        result = parse_expression(parser, 0);
-
-                        if (result.error.type != ParseErrorType::NONE)
-                                return result;
-
-                        kvpair->value = result.node;
-
-                        if (parser->token_arr->current.type == TokenType::FOR) {
-                                parser->token_arr->next_token();
-                                result =
-                                        parse_single_for_if_clause(parser);
-
-                                if (result.error.type != ParseErrorType::NONE)
-                                        return result;
-
-                                first_child->adjacent_child = result.node;
-                        }
-
-                        if (parser->token_arr->current.type == TokenType::COMMA) {
-                                parser->token_arr->next_token();
-                                result =
-                                        parse_double_starred_kvpairs(parser);
-
-                                if (result.error.type != ParseErrorType::NONE)
-                                        return result;
-
-                                first_child->adjacent_child = result.node;
-                        }
-
-                } else {
-                        // parse set definition
-                        if (parser->token_arr->current.type == TokenType::FOR) {
-                                parser->token_arr->next_token();
-                                result =
-                                        parse_single_for_if_clause(parser);
-
-                                if (result.error.type != ParseErrorType::NONE)
-                                        return result;
-
-                                first_child->adjacent_child = result.node;
-                        }
-
-                        else {
-                                parser->token_arr->next_token();
-                                result =
-                                        parse_assignment_star_expressions(
-                                                parser, false);
-
-                                if (result.error.type != ParseErrorType::NONE)
-                                        return result;
-
-                                first_child->adjacent_child = result.node;
-                        }
-                }
-
-                ParseResult assert_result = assert_token_and_print_debug(
-                        parser, TokenType::CURLY_CLOSED_PAREN,
-                        "Mismatched '}' in set definition");
-
-                if (assert_result.error.type != ParseErrorType::NONE)
-                        return assert_result;
-                parser->token_arr->next_token();
-
-                return ParseResult{.node = node};
         } else if (parser->token_arr->current.is_literal()) {
                 AstNode *node = node_alloc(parser->ast_arena);
 
@@ -2045,75 +1953,505 @@ static ParseResult parse_increasing_precedence(Parser *parser,
         }
 }
 
-static ParseResult parse_disjunction(Parser *parser, int min_precedence)
+static ExpressionFrame *expression_frame_push(Parser *parser,
+                                              ExpressionFrameState state,
+                                              int min_precedence,
+                                              AstNode *node)
 {
-        ParseResult result = parse_left(parser);
+        ExpressionFrame *frame = (ExpressionFrame *)parser->expression_stack.alloc(
+                sizeof(ExpressionFrame));
+        frame->state = state;
+        frame->min_precedence = min_precedence;
+        frame->node = node;
+        frame->last_child = nullptr;
+        frame->first_child = true;
 
-        if (result.error.type != ParseErrorType::NONE)
-                return result;
+        return frame;
+}
 
-        AstNode *left = result.node;
-        // parse star primary
+static inline ExpressionFrame *expression_frame_peek(Parser *parser)
+{
+        return (ExpressionFrame *)((char *)parser->expression_stack.memory +
+                                   parser->expression_stack.offset -
+                                   sizeof(ExpressionFrame));
+}
+
+static inline void expression_frame_pop(Parser *parser)
+{
+        parser->expression_stack.offset -= sizeof(ExpressionFrame);
+}
+
+static inline ParseResult expression_stack_unwind(Parser *parser,
+                                                  uint64_t base,
+                                                  ParseResult result)
+{
+        parser->expression_stack.offset = base;
+        --parser->expression_depth;
+
+        return result;
+}
+
+static ParseResult parse_expression_with_stack(Parser *parser,
+                                               ExpressionAction action,
+                                               int min_precedence)
+{
+        if (parser->expression_depth >= MAX_EXPRESSION_NESTING) {
+                return parser_create_error_from_msg(
+                        parser, "Too many nested parentheses");
+        }
+
+        ++parser->expression_depth;
+        uint64_t base = parser->expression_stack.offset;
+        TokenArray *token_arr = parser->token_arr;
+        AstNode *value = nullptr;
 
         while (true) {
-                result = parse_increasing_precedence(parser, left, min_precedence);
+                switch (action) {
+                case ExpressionAction::ENTER_EXPRESSION: {
+                        expression_frame_push(
+                                parser,
+                                ExpressionFrameState::EXPRESSION_AFTER_DISJUNCTION,
+                                min_precedence, nullptr);
+                        action = ExpressionAction::ENTER_DISJUNCTION;
+                } break;
 
-                if (result.error.type != ParseErrorType::NONE)
-                        return result;
+                case ExpressionAction::ENTER_DISJUNCTION: {
+                        expression_frame_push(
+                                parser,
+                                ExpressionFrameState::DISJUNCTION_AFTER_OPERAND,
+                                min_precedence, nullptr);
+                        action = ExpressionAction::ENTER_OPERAND;
+                } break;
+
+                case ExpressionAction::ENTER_OPERAND: {
+                        while (token_arr->current.is_unary_op()) {
+                                AstNode *unary = node_alloc(parser->ast_arena);
+                                unary->type = AstNodeType::UNARY;
+                                unary->token = token_arr->current;
+                                expression_frame_push(
+                                        parser,
+                                        ExpressionFrameState::UNARY_AFTER_OPERAND,
+                                        0, unary);
+                                token_arr->next_token();
+                        }
 
-                AstNode *node = result.node;
+                        if (token_arr->current.type == TokenType::SQUARE_OPEN_PAREN ||
+                            token_arr->current.type == TokenType::CURLY_OPEN_PAREN) {
+                                expression_frame_push(
+                                        parser,
+                                        ExpressionFrameState::PRIMARY_AFTER_DISPLAY,
+                                        0, nullptr);
+                                action = ExpressionAction::ENTER_DISPLAY;
+                                break;
+                        }
 
-                if (node == left) {
-                        break;
-                }
+                        ParseResult result;
+                        if (token_arr->current.type == TokenType::OPEN_PAREN)
+                                result = parse_left(parser);
+                        else
+                                result = parse_primary(parser);
 
-                left = node;
-        }
+                        if (result.error.type != ParseErrorType::NONE)
+                                return expression_stack_unwind(parser, base, result);
 
-        return ParseResult{.node = left};
-}
+                        value = result.node;
+                        action = ExpressionAction::RETURN_VALUE;
+                } break;
 
-static ParseResult parse_expression(Parser *parser, int min_precedence)
-{
-        ParseResult result = parse_disjunction(parser, min_precedence);
+                case ExpressionAction::ENTER_DISPLAY: {
+                        AstNode *node = node_alloc(parser->ast_arena);
+                        node->token = token_arr->current;
 
-        if (result.error.type != ParseErrorType::NONE)
-                return result;
+                        if (token_arr->current.type == TokenType::SQUARE_OPEN_PAREN) {
+                                node->type = AstNodeType::LIST;
+                                token_arr->next_token();
 
-        AstNode *expr = result.node;
+                                if (token_arr->current.type ==
+                                    TokenType::SQUARE_CLOSED_PAREN) {
+                                        token_arr->next_token();
+                                        value = node;
+                                        action = ExpressionAction::RETURN_VALUE;
+                                        break;
+                                }
 
-        if (parser->token_arr->current.type != TokenType::IF) {
-                return ParseResult{.node = expr};
-        }
+                                expression_frame_push(
+                                        parser,
+                                        ExpressionFrameState::LIST_AFTER_ELEMENT,
+                                        0, node);
+                                action = ExpressionAction::ENTER_LIST_ELEMENT;
+                                break;
+                        }
 
-        AstNode *if_expr = node_alloc(parser->ast_arena);
-        if_expr->type = AstNodeType::IF_EXPR;
-        if_expr->token = parser->token_arr->current;
-        if_expr->if_expr.true_expression = expr;
+                        token_arr->next_token();
 
-        parser->token_arr->next_token();
-        result = parse_disjunction(parser, 0);
-        if (result.error.type != ParseErrorType::NONE)
-                return result;
+                        if (token_arr->current.type == TokenType::CURLY_CLOSED_PAREN) {
+                                token_arr->next_token();
+                                node->type = AstNodeType::DICT;
+                                value = node;
+                                action = ExpressionAction::RETURN_VALUE;
+                                break;
+                        }
 
-        if_expr->if_expr.condition = result.node;
+                        // the first child is only a kvpair if a ':' follows
+                        ExpressionFrame *frame = expression_frame_push(
+                                parser, ExpressionFrameState::DICT_AFTER_KEY,
+                                0, node);
+                        frame->last_child = node_alloc(parser->ast_arena);
+                        frame->last_child->token = token_arr->current;
+                        min_precedence = 0;
+                        action = ExpressionAction::ENTER_EXPRESSION;
+                } break;
+
+                case ExpressionAction::ENTER_LIST_ELEMENT: {
+                        if (token_arr->current.type == TokenType::MULTIPLICATION ||
+                            (token_arr->current.type == TokenType::IDENTIFIER &&
+                             token_arr->lookahead.type == TokenType::COLON_EQUAL)) {
+                                ParseResult result =
+                                        parse_single_assignment_star_expression(parser);
 
-        ParseResult assert_result = assert_token_and_print_debug(
-                parser, TokenType::ELSE,
-                "In if expressions else is required");
+                                if (result.error.type != ParseErrorType::NONE)
+                                        return expression_stack_unwind(parser, base, result);
 
-        if (assert_result.error.type != ParseErrorType::NONE)
-                return assert_result;
-        parser->token_arr->next_token();
+                                value = result.node;
+                                action = ExpressionAction::RETURN_VALUE;
+                                break;
+                        }
 
-        result = parse_expression(parser, min_precedence);
+                        min_precedence = 0;
+                        action = ExpressionAction::ENTER_EXPRESSION;
+                } break;
 
-        if (result.error.type != ParseErrorType::NONE)
-                return result;
+                case ExpressionAction::RETURN_VALUE: {
+                        if (parser->expression_stack.offset == base) {
+                                --parser->expression_depth;
+                                return ParseResult{.node = value};
+                        }
+
+                        ExpressionFrame *frame = expression_frame_peek(parser);
 
-        if_expr->if_expr.false_expression = result.node;
+                        switch (frame->state) {
+                        case ExpressionFrameState::EXPRESSION_AFTER_DISJUNCTION: {
+                                if (token_arr->current.type != TokenType::IF) {
+                                        expression_frame_pop(parser);
+                                        break;
+                                }
 
-        return ParseResult{.node = if_expr};
+                                AstNode *if_expr = node_alloc(parser->ast_arena);
+                                if_expr->type = AstNodeType::IF_EXPR;
+                                if_expr->token = token_arr->current;
+                                if_expr->if_expr.true_expression = value;
+                                frame->node = if_expr;
+                                frame->state = ExpressionFrameState::EXPRESSION_AFTER_CONDITION;
+
+                                token_arr->next_token();
+                                min_precedence = 0;
+                                action = ExpressionAction::ENTER_DISJUNCTION;
+                        } break;
+
+                        case ExpressionFrameState::EXPRESSION_AFTER_CONDITION: {
+                                frame->node->if_expr.condition = value;
+
+                                ParseResult assert_result = assert_token_and_print_debug(
+                                        parser, TokenType::ELSE,
+                                        "In if expressions else is required");
+
+                                if (assert_result.error.type != ParseErrorType::NONE)
+                                        return expression_stack_unwind(parser, base,
+                                                                       assert_result);
+                                token_arr->next_token();
+
+                                frame->state = ExpressionFrameState::EXPRESSION_AFTER_FALSE_EXPRESSION;
+                                min_precedence = frame->min_precedence;
+                                action = ExpressionAction::ENTER_EXPRESSION;
+                        } break;
+
+                        case ExpressionFrameState::EXPRESSION_AFTER_FALSE_EXPRESSION: {
+                                frame->node->if_expr.false_expression = value;
+                                value = frame->node;
+                                expression_frame_pop(parser);
+                        } break;
+
+                        case ExpressionFrameState::DISJUNCTION_AFTER_OPERAND: {
+                                // one step of precedence climbing with value as the left operand
+                                Token *current_token = &token_arr->current;
+
+                                if (current_token->type == TokenType::ENDFILE) {
+                                        expression_frame_pop(parser);
+                                        break;
+                                }
+
+                                if (current_token->type == TokenType::OPEN_PAREN) {
+                                        token_arr->next_token();
+                                        parse_expression(parser, 0);
+                                        expression_frame_pop(parser);
+                                        break;
+                                }
+
+                                if (!current_token->is_binary_op()) {
+                                        expression_frame_pop(parser);
+                                        break;
+                                }
+
+                                if (current_token->is_augassign_op() &&
+                                    token_arr->lookahead.type == TokenType::ASSIGN) {
+                                        token_arr->next_token();
+                                        ParseResult result =
+                                                parse_assignment_or_declaration(parser, value);
+
+                                        if (result.error.type != ParseErrorType::NONE)
+                                                return expression_stack_unwind(parser, base,
+                                                                               result);
+
+                                        AstNode *assign = result.node;
+
+                                        AstNode *binary = node_alloc(parser->ast_arena);
+                                        binary->binary.left = value;
+                                        binary->binary.right = assign->assignment.expression;
+                                        assign->assignment.expression = binary;
+
+                                        value = assign;
+                                        break;
+                                }
+
+                                int current_precedence = current_token->precedence();
+                                if (current_precedence <= frame->min_precedence) {
+                                        expression_frame_pop(parser);
+                                        break;
+                                }
+
+                                AstNode *binary_op_node = node_alloc(parser->ast_arena);
+                                *binary_op_node = AstNode::create_binary(*current_token,
+                                                                         value, nullptr);
+                                token_arr->next_token();
+
+                                frame->node = binary_op_node;
+                                frame->state = ExpressionFrameState::DISJUNCTION_AFTER_RIGHT_OPERAND;
+                                min_precedence = current_precedence;
+                                action = ExpressionAction::ENTER_EXPRESSION;
+                        } break;
+
+                        case ExpressionFrameState::DISJUNCTION_AFTER_RIGHT_OPERAND: {
+                                frame->node->binary.right = value;
+                                value = frame->node;
+                                frame->state = ExpressionFrameState::DISJUNCTION_AFTER_OPERAND;
+                        } break;
+
+                        case ExpressionFrameState::UNARY_AFTER_OPERAND: {
+                                frame->node->unary.child = value;
+                                value = frame->node;
+                                expression_frame_pop(parser);
+                        } break;
+
+                        case ExpressionFrameState::PRIMARY_AFTER_DISPLAY: {
+                                expression_frame_pop(parser);
+
+                                AstNode *prev = nullptr;
+                                while (value != prev) {
+                                        prev = value;
+                                        ParseResult result =
+                                                parse_sub_primary(parser, value, false);
+
+                                        if (result.error.type != ParseErrorType::NONE)
+                                                return expression_stack_unwind(parser, base,
+                                                                               result);
+
+                                        value = result.node;
+                                }
+                        } break;
+
+                        case ExpressionFrameState::LIST_AFTER_ELEMENT: {
+                                AstNode *list = frame->node;
+
+                                if (frame->first_child) {
+                                        frame->first_child = false;
+                                        list->list.children = value;
+                                        frame->last_child = value;
+
+                                        if (token_arr->current.type == TokenType::FOR) {
+                                                token_arr->next_token();
+                                                list->type = AstNodeType::LISTCOMP;
+                                                ParseResult result = parse_for_if_clauses(parser);
+
+                                                if (result.error.type != ParseErrorType::NONE)
+                                                        return expression_stack_unwind(
+                                                                parser, base, result);
+
+                                                list->list.children = result.node;
+
+                                                if (token_arr->current.type == TokenType::COMMA) {
+                                                        token_arr->next_token();
+                                                        result = parse_assignment_star_expressions(
+                                                                parser, false);
+
+                                                        if (result.error.type != ParseErrorType::NONE)
+                                                                return expression_stack_unwind(
+                                                                        parser, base, result);
+
+                                                        list->list.children->adjacent_child =
+                                                                result.node;
+                                                }
+                                        }
+
+                                        else if (token_arr->current.type == TokenType::COMMA) {
+                                                token_arr->next_token();
+                                                action = ExpressionAction::ENTER_LIST_ELEMENT;
+                                                break;
+                                        }
+                                } else {
+                                        frame->last_child->adjacent_child = value;
+                                        frame->last_child = value;
+
+                                        if (token_arr->current.type == TokenType::COMMA) {
+                                                token_arr->next_token();
+                                                action = ExpressionAction::ENTER_LIST_ELEMENT;
+                                                break;
+                                        }
+                                }
+
+                                ParseResult assert_result = assert_token_and_print_debug(
+                                        parser, TokenType::SQUARE_CLOSED_PAREN,
+                                        "Mismatched parenthesis in list");
+
+                                if (assert_result.error.type != ParseErrorType::NONE)
+                                        return expression_stack_unwind(parser, base,
+                                                                       assert_result);
+                                token_arr->next_token();
+
+                                value = list;
+                                expression_frame_pop(parser);
+                        } break;
+
+                        case ExpressionFrameState::DICT_AFTER_KEY: {
+                                AstNode *kvpair = frame->last_child;
+
+                                if (frame->first_child) {
+                                        frame->node->type = AstNodeType::DICT;
+
+                                        if (token_arr->current.type != TokenType::COLON) {
+                                                ParseResult result =
+                                                        parse_set_or_dict_from_first_expression(
+                                                                parser, frame->node, value, kvpair);
+
+                                                if (result.error.type != ParseErrorType::NONE)
+                                                        return expression_stack_unwind(
+                                                                parser, base, result);
+
+                                                value = result.node;
+                                                expression_frame_pop(parser);
+                                                break;
+                                        }
+
+                                        frame->node->dict.children = kvpair;
+                                } else {
+                                        ParseResult assert_result = assert_token_and_print_debug(
+                                                parser, TokenType::COLON,
+                                                "Key Value pairs must be seperated by ':'");
+
+                                        if (assert_result.error.type != ParseErrorType::NONE)
+                                                return expression_stack_unwind(
+                                                        parser, base, assert_result);
+                                }
+
+                                token_arr->next_token();
+                                kvpair->type = AstNodeType::KVPAIR;
+                                kvpair->kvpair.key = value;
+
+                                frame->state = ExpressionFrameState::DICT_AFTER_VALUE;
+                                min_precedence = 0;
+                                action = ExpressionAction::ENTER_EXPRESSION;
+                        } break;
+
+                        case ExpressionFrameState::DICT_AFTER_VALUE: {
+                                AstNode *dict = frame->node;
+                                frame->last_child->kvpair.value = value;
+
+                                if (frame->first_child &&
+                                    token_arr->current.type == TokenType::FOR) {
+                                        frame->first_child = false;
+                                        token_arr->next_token();
+                                        ParseResult result = parse_single_for_if_clause(parser);
+
+                                        if (result.error.type != ParseErrorType::NONE)
+                                                return expression_stack_unwind(parser, base,
+                                                                               result);
+
+                                        frame->last_child->adjacent_child = result.node;
+
+                                        if (token_arr->current.type == TokenType::COMMA) {
+                                                token_arr->next_token();
+                                                result = parse_double_starred_kvpairs(parser);
+
+                                                if (result.error.type != ParseErrorType::NONE)
+                                                        return expression_stack_unwind(
+                                                                parser, base, result);
+
+                                                frame->last_child->adjacent_child = result.node;
+                                        }
+                                }
+
+                                frame->first_child = false;
+
+                                bool next_kvpair = false;
+                                while (token_arr->current.type == TokenType::COMMA) {
+                                        token_arr->next_token();
+
+                                        if (token_arr->current.type != TokenType::EXPONENTIATION) {
+                                                next_kvpair = true;
+                                                break;
+                                        }
+
+                                        ParseResult result =
+                                                parse_single_double_starred_kvpair(parser);
+
+                                        if (result.error.type != ParseErrorType::NONE)
+                                                return expression_stack_unwind(parser, base,
+                                                                               result);
+
+                                        frame->last_child->adjacent_child = result.node;
+                                        frame->last_child = result.node;
+                                }
+
+                                if (next_kvpair) {
+                                        AstNode *kvpair = node_alloc(parser->ast_arena);
+                                        kvpair->type = AstNodeType::KVPAIR;
+                                        kvpair->token = token_arr->current;
+                                        frame->last_child->adjacent_child = kvpair;
+                                        frame->last_child = kvpair;
+
+                                        frame->state = ExpressionFrameState::DICT_AFTER_KEY;
+                                        min_precedence = 0;
+                                        action = ExpressionAction::ENTER_EXPRESSION;
+                                        break;
+                                }
+
+                                ParseResult assert_result = assert_token_and_print_debug(
+                                        parser, TokenType::CURLY_CLOSED_PAREN,
+                                        "Mismatched '}' in set definition");
+
+                                if (assert_result.error.type != ParseErrorType::NONE)
+                                        return expression_stack_unwind(parser, base,
+                                                                       assert_result);
+                                token_arr->next_token();
+
+                                value = dict;
+                                expression_frame_pop(parser);
+                        } break;
+                        }
+                } break;
+                }
+        }
+}
+
+static ParseResult parse_disjunction(Parser *parser, int min_precedence)
+{
+        return parse_expression_with_stack(
+                parser, ExpressionAction::ENTER_DISJUNCTION, min_precedence);
+}
+
+static ParseResult parse_expression(Parser *parser, int min_precedence)
+{
+        return parse_expression_with_stack(
+                parser, ExpressionAction::ENTER_EXPRESSION, min_precedence);
 }
 
 static ParseResult assert_single_subscript_attribute(Parser *parser, 
@@ -2466,8 +2804,7 @@ static ParseResult parse_dotted_as_name_import(Parser *parser)
 
         target_proper->dotted_name = result.node;
 
-        parser->tables->import_list->list[parser->tables->import_list->list_index++] =
-                import_target;
+        parser->tables->import_list->push(import_target);
 
         SymbolTableValue val = {};
         val.node = import_target;
@@ -2485,6 +2822,12 @@ static ParseResult parse_dotted_as_name_import(Parser *parser)
         }
 
         AstNode *names = target_proper->dotted_name;
+        if (!target_proper->as && names->type != AstNodeType::BINARYEXPR) {
+                parser->tables->symbol_table->insert(parser->symbol_table_arena,
+                                             names->token.value,
+                                             parser->scope, &val);
+        }
+
         while (names->type == AstNodeType::BINARYEXPR) {
                 parser->tables->symbol_table->insert(parser->symbol_table_arena,
                                              names->binary.right->token.value,
@@ -2493,7 +2836,7 @@ static ParseResult parse_dotted_as_name_import(Parser *parser)
                                              names->binary.left->token.value,
                                              parser->scope, &val);
                 // its a right leaning tree the left nodes will not have any children
-                names = target_proper->dotted_name->binary.right;
+                names = names->binary.right;
         }
 
         return ParseResult{.node = import_target};
@@ -3306,6 +3649,11 @@ static ParseResult parse_statement(Parser *parser)
 
 static ParseResult parse_statements(Parser *parser)
 {
+        bool owns_expression_stack = !parser->expression_stack.memory;
+        if (owns_expression_stack) {
+                parser->expression_stack = Arena::init(MEGABYTES(64));
+        }
+
         AstNode *file_node = node_alloc(parser->ast_arena);
         file_node->token = parser->token_arr->current;
         file_node->type = AstNodeType::FILE;
@@ -3329,6 +3677,11 @@ static ParseResult parse_statements(Parser *parser)
                 child = &((*child)->adjacent_child);
         }
 
+        if (owns_expression_stack) {
+                parser->expression_stack.destroy();
+                parser->expression_stack = {};
+        }
+
         return ParseResult{.node = file_node};
 }
 
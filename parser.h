@@ -61,12 +61,18 @@ introspect enum class AstNodeType {
         LAMBDA = 42,
         TYPE_PARAM = 43,
         INVALID = 44,
+        KWARG = 45,
 };
 
 introspect struct AstNodeUnary {
         AstNode *child;
 };
 
+introspect struct AstNodeIdentifier {
+        // bound by resolve_names, null when it couldn't be resolved
+        SymbolTableEntry *symbol;
+};
+
 introspect struct AstNodeNary {
         AstNode *children;
 };
@@ -156,6 +162,8 @@ introspect struct AstNodeFunctionDef {
         AstNode *star;
         AstNode *double_star;
         AstNode *return_type;
+        // positions among the arguments counting the / and * markers, -1
+        // when there's no marker
         int star_pos;
         int slash_pos;
 };
@@ -226,6 +234,9 @@ introspect struct AstNodeStarExpression {
 introspect struct AstNodeImportTarget {
         AstNode *dotted_name;
         AstNode *as;
+        // the scope of the module it names, only bound when that module is
+        // checked on demand
+        SymbolTableEntry *module;
 };
 
 introspect struct AstNodeFromImportTarget {
@@ -285,52 +296,55 @@ introspect struct AstNodeDict {
 // ASTNode are tree nodes each node contains a linked list of its children
 // each child node has a next pointer to the adjacent child of the same level
 //
-struct AstNode {
+schema struct AstNode {
         Token token;
         AstNodeType type = AstNodeType::TERMINAL;
         TypeInfo static_type;
 
+        // tagged by type, the tags a member is read for are listed so the
+        // preprocessor can build AstNodeTypePayloads
         union {
-                AstNodeNary nary;
-                AstNodeFile file;
-                AstNodeBlock block;
-                AstNodeBinaryExpr binary;
-                AstNodeUnary unary;
-                AstNodeDeclaration declaration;
-                AstNodeAssignment assignment;
-                AstNodeTypeAnnot type_annotation;
-                AstNodeIf if_stmt;
-                AstNodeElse else_stmt;
-                AstNodeWhile while_loop;
-                AstNodeForLoop for_loop;
-                AstNodeForIfClause for_if;
-                AstNodeFunctionDef function_def;
-                AstNodeFunctionCall function_call;
-                AstNodeClassDef class_def;
-                AstNodeSubscript subscript;
-                AstNodeSlice slice;
-                AstNodeAttributeRef attribute_ref;
-                AstNodeTry try_node;
-                AstNodeWithItem with_item;
-                AstNodeWith with_statement;
-                AstNodeExcept except;
-                AstNodeStarExpression star_expression;
-                AstNodeKwarg kwarg;
-                AstNodeKvPair kvpair;
-                AstNodeImport import;
-                AstNodeImportTarget import_target;
-                AstNodeFrom from;
-                AstNodeFromImportTarget from_target;
-                AstNodeTuple tuple;
-                AstNodeList list;
-                AstNodeDict dict;
-                AstNodeUnion union_type;
-                AstNodeMatch match;
-                AstNodeRaise raise;
-                AstNodeIfExpr if_expr;
-                AstNodeGenExpr gen_expr;
-                AstNodeLambdaDef lambda;
-                AstNodeTypeParam type_param;
+                payload(AstNodeType::NARY) AstNodeNary nary;
+                payload(AstNodeType::IDENTIFIER) AstNodeIdentifier identifier;
+                payload(AstNodeType::FILE) AstNodeFile file;
+                payload(AstNodeType::BLOCK) AstNodeBlock block;
+                payload(AstNodeType::BINARYEXPR) AstNodeBinaryExpr binary;
+                payload(AstNodeType::UNARY) AstNodeUnary unary;
+                payload(AstNodeType::DECLARATION) AstNodeDeclaration declaration;
+                payload(AstNodeType::ASSIGNMENT) AstNodeAssignment assignment;
+                payload(AstNodeType::TYPE_ANNOTATION) AstNodeTypeAnnot type_annotation;
+                payload(AstNodeType::IF) AstNodeIf if_stmt;
+                payload(AstNodeType::ELSE) AstNodeElse else_stmt;
+                payload(AstNodeType::WHILE) AstNodeWhile while_loop;
+                payload(AstNodeType::FOR_LOOP) AstNodeForLoop for_loop;
+                payload(AstNodeType::FOR_IF) AstNodeForIfClause for_if;
+                payload(AstNodeType::FUNCTION_DEF) AstNodeFunctionDef function_def;
+                payload(AstNodeType::FUNCTION_CALL) AstNodeFunctionCall function_call;
+                payload(AstNodeType::CLASS_DEF) AstNodeClassDef class_def;
+                payload(AstNodeType::SUBSCRIPT) AstNodeSubscript subscript;
+                payload(AstNodeType::SLICE) AstNodeSlice slice;
+                payload(AstNodeType::ATTRIBUTE_REF) AstNodeAttributeRef attribute_ref;
+                payload(AstNodeType::TRY) AstNodeTry try_node;
+                payload(AstNodeType::WITH_ITEM) AstNodeWithItem with_item;
+                payload(AstNodeType::WITH) AstNodeWith with_statement;
+                payload(AstNodeType::EXCEPT) AstNodeExcept except;
+                payload(AstNodeType::STARRED) AstNodeStarExpression star_expression;
+                payload(AstNodeType::KWARG) AstNodeKwarg kwarg;
+                payload(AstNodeType::KVPAIR) AstNodeKvPair kvpair;
+                payload(AstNodeType::IMPORT) AstNodeImport import;
+                payload(AstNodeType::IMPORT_TARGET) AstNodeImportTarget import_target;
+                payload(AstNodeType::FROM) AstNodeFrom from;
+                payload(AstNodeType::FROM_TARGET) AstNodeFromImportTarget from_target;
+                payload(AstNodeType::TUPLE) AstNodeTuple tuple;
+                payload(AstNodeType::LIST, AstNodeType::LISTCOMP) AstNodeList list;
+                payload(AstNodeType::DICT, AstNodeType::DICTCOMP) AstNodeDict dict;
+                payload(AstNodeType::UNION) AstNodeUnion union_type;
+                payload(AstNodeType::MATCH) AstNodeMatch match;
+                payload(AstNodeType::RAISE) AstNodeRaise raise;
+                payload(AstNodeType::IF_EXPR) AstNodeIfExpr if_expr;
+                payload(AstNodeType::GEN_EXPR) AstNodeGenExpr gen_expr;
+                payload(AstNodeType::LAMBDA) AstNodeLambdaDef lambda;
+                payload(AstNodeType::TYPE_PARAM) AstNodeTypeParam type_param;
         };
 
         AstNode *adjacent_child = nullptr;
@@ -358,12 +372,52 @@ struct ParseResult {
         ParseError error;
 };
 
+// Python caps bracket nesting at 200 levels, anything deeper is rejected
+// instead of overflowing the native stack
+#define MAX_EXPRESSION_NESTING 200
+
+// NOTE: expressions are parsed with an explicit stack of frames rather than
+// recursing once per operator, unary prefix or nested list/dict display.
+// Each frame is a suspended parse_expression/parse_disjunction or display
+// waiting on the value of its next operand
+enum class ExpressionFrameState {
+        EXPRESSION_AFTER_DISJUNCTION,
+        EXPRESSION_AFTER_CONDITION,
+        EXPRESSION_AFTER_FALSE_EXPRESSION,
+        DISJUNCTION_AFTER_OPERAND,
+        DISJUNCTION_AFTER_RIGHT_OPERAND,
+        UNARY_AFTER_OPERAND,
+        PRIMARY_AFTER_DISPLAY,
+        LIST_AFTER_ELEMENT,
+        DICT_AFTER_KEY,
+        DICT_AFTER_VALUE,
+};
+
+enum class ExpressionAction {
+        ENTER_EXPRESSION,
+        ENTER_DISJUNCTION,
+        ENTER_OPERAND,
+        ENTER_DISPLAY,
+        ENTER_LIST_ELEMENT,
+        RETURN_VALUE,
+};
+
+struct ExpressionFrame {
+        ExpressionFrameState state;
+        int min_precedence;
+        AstNode *node;
+        AstNode *last_child;
+        bool first_child;
+};
+
 struct Parser {
         TokenArray *token_arr;
         Arena *ast_arena;
         SymbolTableEntry *scope;
         Tables *tables;
         Arena *symbol_table_arena;
+        Arena expression_stack;
+        uint32_t expression_depth;
 };
 
 static AstNode *node_alloc(Arena *ast_arena);
@@ -389,6 +443,13 @@ static ParseResult parse_bitwise_or_minimum_precedence(Parser *parser,
 
 static ParseResult parse_expression(Parser *parser, int min_precedence);
 static ParseResult parse_disjunction(Parser *parser, int min_precedence);
+static ParseResult parse_expression_with_stack(Parser *parser,
+                                               ExpressionAction action,
+                                               int min_precedence);
+static ParseResult parse_set_or_dict_from_first_expression(Parser *parser,
+                                                           AstNode *node,
+                                                           AstNode *expression,
+                                                           AstNode *first_child);
 static ParseResult parse_increasing_precedence(Parser *parser);
 static ParseResult 
 parse_assignment_or_declaration(Parser *parser, AstNode *left);
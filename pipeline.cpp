@@ -0,0 +1,1208 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "pipeline.h"
+#include "parser.h"
+#include "typing.h"
+#include "resolve.h"
+
+void ModuleQueue::push(Module *module)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        while (this->count == MODULE_QUEUE_CAPACITY && !this->closed) {
+                SleepConditionVariableSRW(&this->not_full, &this->lock,
+                                          INFINITE, 0);
+        }
+
+        this->items[(this->head + this->count) % MODULE_QUEUE_CAPACITY] = module;
+        ++this->count;
+
+        ReleaseSRWLockExclusive(&this->lock);
+        WakeConditionVariable(&this->not_empty);
+}
+
+Module *ModuleQueue::pop()
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        while (this->count == 0 && !this->closed) {
+                SleepConditionVariableSRW(&this->not_empty, &this->lock,
+                                          INFINITE, 0);
+        }
+
+        Module *module = nullptr;
+        if (this->count) {
+                module = this->items[this->head];
+                this->head = (this->head + 1) % MODULE_QUEUE_CAPACITY;
+                --this->count;
+        }
+
+        ReleaseSRWLockExclusive(&this->lock);
+        WakeConditionVariable(&this->not_full);
+
+        return module;
+}
+
+void ModuleQueue::close()
+{
+        AcquireSRWLockExclusive(&this->lock);
+        this->closed = true;
+        ReleaseSRWLockExclusive(&this->lock);
+
+        WakeAllConditionVariable(&this->not_empty);
+        WakeAllConditionVariable(&this->not_full);
+}
+
+void BodyQueue::push(BodyTask *tasks, uint64_t count)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        BodyTask *slots =
+                (BodyTask *)this->arena.alloc(count * sizeof(BodyTask));
+        memcpy(slots, tasks, count * sizeof(BodyTask));
+        this->tail += count;
+
+        ReleaseSRWLockExclusive(&this->lock);
+}
+
+// the owner takes the newest, its module's data is the most likely to
+// still be in cache
+bool BodyQueue::pop(BodyTask *task)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        bool popped = this->head < this->tail;
+        if (popped) {
+                *task = this->items[--this->tail];
+                this->arena.offset -= sizeof(BodyTask);
+        }
+
+        if (this->head == this->tail) {
+                this->head = 0;
+                this->tail = 0;
+                this->arena.offset = 0;
+        }
+
+        ReleaseSRWLockExclusive(&this->lock);
+
+        return popped;
+}
+
+// thieves take the oldest so they don't contend with the owner's end
+bool BodyQueue::steal(BodyTask *task)
+{
+        if (!TryAcquireSRWLockExclusive(&this->lock)) {
+                return false;
+        }
+
+        bool stolen = this->head < this->tail;
+        if (stolen) {
+                *task = this->items[this->head++];
+        }
+
+        if (this->head == this->tail) {
+                this->head = 0;
+                this->tail = 0;
+                this->arena.offset = 0;
+        }
+
+        ReleaseSRWLockExclusive(&this->lock);
+
+        return stolen;
+}
+
+ModuleRegistry ModuleRegistry::init(uint64_t capacity)
+{
+        ModuleRegistry registry = {};
+
+        registry.capacity = MODULE_REGISTRY_INITIAL_CAPACITY;
+        while (registry.capacity < capacity) {
+                registry.capacity <<= 1;
+        }
+
+        registry.arena = Arena::init(registry.capacity * sizeof(Module *));
+        registry.slots =
+                (Module **)registry.arena.alloc(registry.capacity * sizeof(Module *));
+        memset(registry.slots, 0, registry.capacity * sizeof(Module *));
+
+        return registry;
+}
+
+Module *ModuleRegistry::find(std::string &name, uint32_t hash)
+{
+        uint64_t mask = this->capacity - 1;
+        for (uint64_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                Module *module = this->slots[slot];
+                if (!module)
+                        return nullptr;
+                if (module->name_hash == hash && module->name == name)
+                        return module;
+        }
+}
+
+// the module's name must not already be registered
+void ModuleRegistry::insert(Module *module)
+{
+        if ((this->count + 1) * 2 > this->capacity) {
+                ModuleRegistry grown = ModuleRegistry::init(this->capacity * 2);
+                for (uint64_t i = 0; i < this->capacity; ++i) {
+                        if (this->slots[i])
+                                grown.insert(this->slots[i]);
+                }
+
+                this->destroy();
+                *this = grown;
+        }
+
+        uint64_t mask = this->capacity - 1;
+        uint64_t slot = module->name_hash & mask;
+        while (this->slots[slot]) {
+                slot = (slot + 1) & mask;
+        }
+
+        this->slots[slot] = module;
+        ++this->count;
+}
+
+void ModuleRegistry::destroy()
+{
+        this->arena.destroy();
+}
+
+static uint32_t pipeline_default_workers_per_stage()
+{
+        SYSTEM_INFO system_info = {};
+        GetSystemInfo(&system_info);
+
+        uint32_t workers = system_info.dwNumberOfProcessors / 3;
+
+        if (workers < 1)
+                return 1;
+        if (workers > MAX_STAGE_WORKERS)
+                return MAX_STAGE_WORKERS;
+
+        return workers;
+}
+
+Pipeline *Pipeline::create(Arena *arena, Tables *tables,
+                           Arena *symbol_table_arena,
+                           SymbolTableEntry *main_scope, AstNode *module_node,
+                           PythonPath *path, uint32_t workers_per_stage)
+{
+        Pipeline *pipeline = (Pipeline *)arena->alloc(sizeof(Pipeline));
+        new (pipeline) Pipeline();
+        InitializeSRWLock(&pipeline->lock);
+        InitializeConditionVariable(&pipeline->module_submitted);
+        InitializeSRWLock(&pipeline->parse_queue.lock);
+        InitializeConditionVariable(&pipeline->parse_queue.not_empty);
+        InitializeConditionVariable(&pipeline->parse_queue.not_full);
+        InitializeConditionVariable(&pipeline->module_ready);
+        InitializeConditionVariable(&pipeline->body_submitted);
+
+        pipeline->module_arena = Arena::init(MEGABYTES(64));
+        pipeline->module_list = Arena::init(MEGABYTES(64));
+        pipeline->modules = (Module **)pipeline->module_list.memory;
+        pipeline->registry =
+                ModuleRegistry::init(MODULE_REGISTRY_INITIAL_CAPACITY);
+        pipeline->schedule.arena = Arena::init(MEGABYTES(64));
+        pipeline->schedule.scratch = Arena::init(MEGABYTES(64));
+        pipeline->schedule.pending = Arena::init(MEGABYTES(64));
+        pipeline->schedule.order_list = Arena::init(MEGABYTES(64));
+        pipeline->schedule.order =
+                (Module **)pipeline->schedule.order_list.memory;
+        pipeline->tables = tables;
+        pipeline->symbol_table_arena = symbol_table_arena;
+        pipeline->main_scope = main_scope;
+        pipeline->module_node = module_node;
+        pipeline->path = path;
+
+        if (workers_per_stage < 1)
+                workers_per_stage = 1;
+        if (workers_per_stage > MAX_STAGE_WORKERS)
+                workers_per_stage = MAX_STAGE_WORKERS;
+
+        pipeline->workers_per_stage = workers_per_stage;
+
+        for (uint32_t i = 0; i < workers_per_stage; ++i) {
+                pipeline->worker_symbol_arenas[i] = Arena::init(GIGABYTES(1));
+                pipeline->body_arenas[i] = Arena::init(GIGABYTES(1));
+                pipeline->type_symbol_arenas[i] = Arena::init(GIGABYTES(1));
+
+                BodyQueue *queue = &pipeline->body_queues[i];
+                InitializeSRWLock(&queue->lock);
+                queue->arena = Arena::init(MEGABYTES(64));
+                queue->items = (BodyTask *)queue->arena.memory;
+        }
+
+        return pipeline;
+}
+
+static Module *pipeline_module_create(Pipeline *pipeline, std::string &name,
+                                      uint32_t hash, SymbolTableEntry *scope)
+{
+        Module *module = (Module *)pipeline->module_arena.alloc(sizeof(Module));
+        new (module) Module();
+        module->name = name;
+        module->name_hash = hash;
+        module->scope = scope;
+        module->position = UINT32_MAX;
+        pipeline->registry.insert(module);
+
+        return module;
+}
+
+// Adds a module to be lexed unless one with the same name was already
+// submitted or loaded. A null scope gives the module its own top level scope
+Module *Pipeline::submit(std::string name, const char *filename,
+                         SymbolTableEntry *scope)
+{
+        uint32_t hash = atom_hash(name.c_str(), name.size());
+
+        AcquireSRWLockExclusive(&this->lock);
+
+        Module *module = this->registry.find(name, hash);
+        if (module) {
+                ReleaseSRWLockExclusive(&this->lock);
+                return module;
+        }
+
+        if (!scope) {
+                SymbolTableValue symbol_value = {};
+                symbol_value.static_type.type = TypeInfoType::INTEGER;
+                symbol_value.node = this->module_node;
+                scope = this->tables->symbol_table->insert(
+                        this->symbol_table_arena, name, 0, &symbol_value);
+        }
+
+        module = pipeline_module_create(this, name, hash, scope);
+        module->state = ModuleState::PENDING;
+        strncpy_s(module->filename, sizeof(module->filename), filename,
+                  strlen(filename));
+
+        Module **slot = (Module **)this->module_list.alloc(sizeof(Module *));
+        *slot = module;
+        module->position = this->module_count++;
+        InterlockedIncrement(&this->modules_in_flight);
+
+        ReleaseSRWLockExclusive(&this->lock);
+        WakeConditionVariable(&this->module_submitted);
+
+        return module;
+}
+
+// Registers a module whose symbols are already declared under scope, call
+// before run
+Module *Pipeline::add_loaded(std::string name, SymbolTableEntry *scope)
+{
+        uint32_t hash = atom_hash(name.c_str(), name.size());
+
+        AcquireSRWLockExclusive(&this->lock);
+
+        Module *module = this->registry.find(name, hash);
+        if (!module) {
+                module = pipeline_module_create(this, name, hash, scope);
+                module->state = ModuleState::TYPED;
+        }
+
+        ReleaseSRWLockExclusive(&this->lock);
+
+        return module;
+}
+
+// a.b.c is parsed as a.(b.c)
+static void pipeline_dotted_name(AstNode *dotted_name, std::string *name)
+{
+        while (dotted_name->type == AstNodeType::BINARYEXPR) {
+                *name += dotted_name->binary.left->token.value;
+                *name += '.';
+                dotted_name = dotted_name->binary.right;
+        }
+
+        *name += dotted_name->token.value;
+}
+
+static Module *pipeline_submit_import(Pipeline *pipeline, AstNode *import_target)
+{
+        if (!import_target) {
+                return nullptr;
+        }
+
+        std::string name;
+        pipeline_dotted_name(import_target->import_target.dotted_name, &name);
+
+        return pipeline_submit_import_name(pipeline, name);
+}
+
+// submits the module imported as the dotted name
+static Module *pipeline_submit_import_name(Pipeline *pipeline,
+                                           std::string &name)
+{
+        char filename[2048] = {};
+
+        if (name == "sys") {
+                strncpy_s(filename, sizeof(filename), "sysmodule.tpy",
+                          strlen("sysmodule.tpy"));
+        } else if (name == "import_test") {
+                strncpy_s(filename, sizeof(filename), "import_test.py",
+                          strlen("import_test.py"));
+        } else {
+                std::string relative_path = name;
+                for (char &c : relative_path) {
+                        if (c == '.')
+                                c = '\\';
+                }
+
+                // the shared python path is read only here, workers resolve
+                // imports concurrently
+                PythonPath *path = pipeline->path;
+                snprintf(filename, sizeof(filename), "%.*s%s.py",
+                         (int)(path->file_part - path->path_buffer),
+                         path->path_buffer, relative_path.c_str());
+        }
+
+        return pipeline->submit(name, filename, nullptr);
+}
+
+static void pipeline_finish_module(Pipeline *pipeline)
+{
+        if (InterlockedDecrement(&pipeline->modules_in_flight) != 0) {
+                return;
+        }
+
+        // nothing is left in any stage and nothing can submit more
+        AcquireSRWLockExclusive(&pipeline->lock);
+        pipeline->finished = true;
+        ReleaseSRWLockExclusive(&pipeline->lock);
+        WakeAllConditionVariable(&pipeline->module_submitted);
+        WakeAllConditionVariable(&pipeline->module_ready);
+        WakeAllConditionVariable(&pipeline->body_submitted);
+
+        pipeline->parse_queue.close();
+}
+
+static Module *pipeline_next_module_to_lex(Pipeline *pipeline)
+{
+        AcquireSRWLockExclusive(&pipeline->lock);
+
+        while (pipeline->next_to_lex == pipeline->module_count &&
+               !pipeline->finished) {
+                SleepConditionVariableSRW(&pipeline->module_submitted,
+                                          &pipeline->lock, INFINITE, 0);
+        }
+
+        Module *module = nullptr;
+        if (pipeline->next_to_lex < pipeline->module_count) {
+                module = pipeline->modules[pipeline->next_to_lex++];
+        }
+
+        ReleaseSRWLockExclusive(&pipeline->lock);
+
+        return module;
+}
+
+static InputStream pipeline_read_module(Module *module)
+{
+        InputStream input_stream =
+                InputStream::create_from_file(module->filename);
+
+        if (!input_stream.contents) {
+                perror("Error reading import file");
+                exit(1);
+        }
+
+        return input_stream;
+}
+
+// destroys the input stream, tokens own copies of their values
+static void pipeline_lex_module(Module *module, InputStream *input_stream)
+{
+        module->token_array = token_array_create_from_input_stream(
+                &module->arena, input_stream);
+        module->token_array.filename = module->filename;
+        module->line_count = input_stream->line;
+        module->state = ModuleState::PARSING;
+
+        input_stream->destroy();
+}
+
+// component is the first member of a cycle or a module outside one
+static void pipeline_schedule_release(WaveSchedule *schedule, Module *component)
+{
+        for (Module *module = component; module;
+             module = module->next_in_component) {
+                *(Module **)schedule->order_list.alloc(sizeof(Module *)) =
+                        module;
+                ++schedule->released;
+        }
+}
+
+// Gives a completed component its wave, everything else its members import
+// has one already. It's released once those imports are summarised
+static void pipeline_schedule_component(Pipeline *pipeline, uint32_t *members,
+                                        uint32_t member_count)
+{
+        WaveSchedule *schedule = &pipeline->schedule;
+        Module **modules = pipeline->modules;
+
+        // members are marked so imports inside the component are skipped
+        for (uint32_t i = 0; i < member_count; ++i) {
+                modules[members[i]]->wave = UINT32_MAX;
+        }
+
+        uint32_t wave = 0;
+        for (uint32_t i = 0; i < member_count; ++i) {
+                Module *member = modules[members[i]];
+                for (uint32_t j = 0; j < member->import_count; ++j) {
+                        Module *imported = member->imports[j];
+                        if (imported->position == UINT32_MAX ||
+                            imported->wave == UINT32_MAX)
+                                continue;
+
+                        if (imported->wave + 1 > wave)
+                                wave = imported->wave + 1;
+                }
+        }
+
+        // linked in the order they were reached, the root first
+        Module *first = modules[members[0]];
+        Module *next = nullptr;
+        for (uint32_t i = member_count; i-- > 0;) {
+                Module *member = modules[members[i]];
+                member->wave = wave;
+                member->scheduled = true;
+                member->next_in_component = next;
+                next = member;
+        }
+
+        for (uint32_t i = 0; i < member_count; ++i) {
+                Module *member = modules[members[i]];
+                for (uint32_t j = 0; j < member->import_count; ++j) {
+                        Module *imported = member->imports[j];
+                        if (imported->position == UINT32_MAX ||
+                            imported->wave == wave || imported->summarised)
+                                continue;
+
+                        ScheduleDependent *dependent =
+                                (ScheduleDependent *)schedule->arena.alloc(
+                                        sizeof(ScheduleDependent));
+                        dependent->module = first;
+                        dependent->next = imported->dependents;
+                        imported->dependents = dependent;
+                        ++first->imports_waiting;
+                }
+        }
+
+        if (!first->imports_waiting)
+                pipeline_schedule_release(schedule, first);
+}
+
+// Tarjan's algorithm without recursion over the parsed modules that don't
+// have a wave yet, an import chain can be thousands of modules long.
+// Components are completed after everything they import so a component's
+// wave is one past the latest wave it imports from. A component that
+// reaches a module that isn't parsed yet is blocked, it's scheduled by a
+// later pass
+static void pipeline_schedule_waves(Pipeline *pipeline)
+{
+        WaveSchedule *schedule = &pipeline->schedule;
+        Arena *scratch = &schedule->scratch;
+        uint32_t count = pipeline->module_count;
+        Module **modules = pipeline->modules;
+        Module **pending = (Module **)schedule->pending.memory;
+        uint32_t pending_count =
+                (uint32_t)(schedule->pending.offset / sizeof(Module *));
+
+        struct TarjanFrame {
+                uint32_t position;
+                uint32_t next_import;
+        };
+
+        // indexed by position, only the pending modules' entries are read
+        // so only theirs are cleared
+        scratch->clear();
+        // the arena doesn't align so the flags come last
+        uint32_t *index = (uint32_t *)scratch->alloc(count * sizeof(uint32_t));
+        uint32_t *lowlink = (uint32_t *)scratch->alloc(count * sizeof(uint32_t));
+        uint32_t *stack =
+                (uint32_t *)scratch->alloc(pending_count * sizeof(uint32_t));
+        TarjanFrame *frames = (TarjanFrame *)scratch->alloc(
+                pending_count * sizeof(TarjanFrame));
+        bool *on_stack = (bool *)scratch->alloc(count * sizeof(bool));
+        bool *blocked = (bool *)scratch->alloc(count * sizeof(bool));
+        for (uint32_t i = 0; i < pending_count; ++i) {
+                uint32_t position = pending[i]->position;
+                index[position] = 0;
+                on_stack[position] = false;
+                blocked[position] = false;
+        }
+
+        uint32_t next_index = 0;
+        uint32_t stack_count = 0;
+
+        for (uint32_t i = 0; i < pending_count; ++i) {
+                uint32_t root = pending[i]->position;
+                if (index[root])
+                        continue;
+
+                uint32_t frame_count = 0;
+                frames[frame_count++] = {root, 0};
+                index[root] = lowlink[root] = ++next_index;
+                stack[stack_count++] = root;
+                on_stack[root] = true;
+
+                while (frame_count) {
+                        TarjanFrame *frame = &frames[frame_count - 1];
+                        Module *module = modules[frame->position];
+
+                        if (frame->next_import < module->import_count) {
+                                Module *imported =
+                                        module->imports[frame->next_import++];
+
+                                // loaded modules are typed already
+                                if (imported->position == UINT32_MAX ||
+                                    imported->scheduled)
+                                        continue;
+
+                                uint32_t position = imported->position;
+                                if (!imported->parsed) {
+                                        blocked[frame->position] = true;
+                                } else if (!index[position]) {
+                                        index[position] = lowlink[position] =
+                                                ++next_index;
+                                        stack[stack_count++] = position;
+                                        on_stack[position] = true;
+                                        frames[frame_count++] = {position, 0};
+                                } else if (on_stack[position]) {
+                                        if (index[position] <
+                                            lowlink[frame->position])
+                                                lowlink[frame->position] =
+                                                        index[position];
+                                } else {
+                                        // completed by this pass without
+                                        // a wave
+                                        blocked[frame->position] = true;
+                                }
+
+                                continue;
+                        }
+
+                        uint32_t position = frame->position;
+                        --frame_count;
+
+                        // position roots a component, its members are on
+                        // the stack above it
+                        if (lowlink[position] == index[position]) {
+                                uint32_t first = stack_count;
+                                bool component_blocked = false;
+                                do {
+                                        --first;
+                                        on_stack[stack[first]] = false;
+                                        component_blocked |=
+                                                blocked[stack[first]];
+                                } while (stack[first] != position);
+
+                                if (component_blocked) {
+                                        for (uint32_t j = first;
+                                             j < stack_count; ++j) {
+                                                blocked[stack[j]] = true;
+                                        }
+                                } else {
+                                        pipeline_schedule_component(
+                                                pipeline, &stack[first],
+                                                stack_count - first);
+                                }
+
+                                stack_count = first;
+                        }
+
+                        if (frame_count) {
+                                uint32_t parent =
+                                        frames[frame_count - 1].position;
+                                if (!on_stack[position]) {
+                                        blocked[parent] |= blocked[position];
+                                } else if (lowlink[position] <
+                                           lowlink[parent]) {
+                                        lowlink[parent] = lowlink[position];
+                                }
+                        }
+                }
+        }
+
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < pending_count; ++i) {
+                if (!pending[i]->scheduled)
+                        pending[kept++] = pending[i];
+        }
+        schedule->pending.offset = kept * sizeof(Module *);
+}
+
+// Everything a module imports is submitted once it's parsed. A component
+// can only be completed by the last of the modules it reaches to be parsed
+// and that one's imports are all parsed, so only then is there a pass
+static void pipeline_module_parsed(Pipeline *pipeline, Module *module)
+{
+        WaveSchedule *schedule = &pipeline->schedule;
+
+        AcquireSRWLockExclusive(&pipeline->lock);
+
+        module->parsed = true;
+        *(Module **)schedule->pending.alloc(sizeof(Module *)) = module;
+
+        bool imports_parsed = true;
+        for (uint32_t i = 0; i < module->import_count; ++i) {
+                Module *imported = module->imports[i];
+                if (imported->position != UINT32_MAX && !imported->parsed) {
+                        imports_parsed = false;
+                        break;
+                }
+        }
+
+        uint32_t released = schedule->released;
+        if (imports_parsed) {
+                pipeline_schedule_waves(pipeline);
+        }
+        bool any_released = schedule->released != released;
+
+        ReleaseSRWLockExclusive(&pipeline->lock);
+
+        if (any_released) {
+                WakeAllConditionVariable(&pipeline->module_ready);
+        }
+}
+
+static DWORD WINAPI pipeline_lex_worker(LPVOID param)
+{
+        Pipeline *pipeline = (Pipeline *)param;
+
+        while (Module *module = pipeline_next_module_to_lex(pipeline)) {
+                InputStream input_stream = pipeline_read_module(module);
+                module->arena = Arena::init(GIGABYTES(2));
+
+                // a module with a cache entry for its source goes straight
+                // to the type stage, its imports are the ones the entry
+                // recorded
+                if (summary_is_cached(pipeline, module)) {
+                        module->source_hash = summary_hash_bytes(
+                                input_stream.contents, input_stream.size);
+
+                        if (summary_read_entry(pipeline, module)) {
+                                input_stream.destroy();
+                                module->state = ModuleState::TYPING;
+                                pipeline_module_parsed(pipeline, module);
+                                continue;
+                        }
+                }
+
+                pipeline_lex_module(module, &input_stream);
+                pipeline->parse_queue.push(module);
+        }
+
+        return 0;
+}
+
+// An importer reads what its imports declare while it's typed so each one
+// has to be typed first. Loaded modules already are and the modules of an
+// import cycle share a wave and are typed alongside each other
+static bool pipeline_imports_are_summarised(Module *module)
+{
+        for (uint32_t i = 0; i < module->import_count; ++i) {
+                Module *imported = module->imports[i];
+                if (imported->position == UINT32_MAX ||
+                    imported->wave == module->wave)
+                        continue;
+
+                if (!imported->summarised)
+                        return false;
+        }
+
+        return true;
+}
+
+static Module *pipeline_next_module_to_type(Pipeline *pipeline)
+{
+        WaveSchedule *schedule = &pipeline->schedule;
+
+        AcquireSRWLockExclusive(&pipeline->lock);
+
+        while (schedule->next == schedule->released && !pipeline->finished) {
+                SleepConditionVariableSRW(&pipeline->module_ready,
+                                          &pipeline->lock, INFINITE, 0);
+        }
+
+        Module *module = nullptr;
+        if (schedule->next < schedule->released) {
+                module = schedule->order[schedule->next++];
+                assert(pipeline_imports_are_summarised(module));
+        }
+
+        ReleaseSRWLockExclusive(&pipeline->lock);
+
+        return module;
+}
+
+// the module's summary is typed, what was only waiting on it is released
+static void pipeline_module_summarised(Pipeline *pipeline, Module *module)
+{
+        WaveSchedule *schedule = &pipeline->schedule;
+
+        AcquireSRWLockExclusive(&pipeline->lock);
+
+        module->summarised = true;
+
+        uint32_t released = schedule->released;
+        for (ScheduleDependent *dependent = module->dependents; dependent;
+             dependent = dependent->next) {
+                if (--dependent->module->imports_waiting == 0)
+                        pipeline_schedule_release(schedule, dependent->module);
+        }
+        bool any_released = schedule->released != released;
+
+        ReleaseSRWLockExclusive(&pipeline->lock);
+
+        if (any_released) {
+                WakeAllConditionVariable(&pipeline->module_ready);
+        }
+}
+
+// parses a lexed module and submits what it imports
+static void pipeline_parse_module(Pipeline *pipeline, Module *module,
+                                  Arena *symbol_table_arena)
+{
+        module->import_list = ImportList::create(&module->arena);
+        module->lazy = pipeline->lazy &&
+                       module->position >= pipeline->input_module_count;
+
+        // imports are collected per module so this worker knows
+        // which ones it found
+        Tables module_tables = *pipeline->tables;
+        module_tables.import_list = module->import_list;
+
+        Parser parser = {};
+        parser.token_arr = &module->token_array;
+        parser.ast_arena = &module->arena;
+        parser.scope = module->scope;
+        parser.tables = &module_tables;
+        parser.symbol_table_arena = symbol_table_arena;
+
+        ParseResult result = parse_statements(&parser);
+        module->root = result.node;
+
+        module->import_count = 0;
+        module->imports = (Module **)module->arena.alloc(
+                module->import_list->list_index * sizeof(Module *));
+        for (uint64_t i = 0; i < module->import_list->list_index; ++i) {
+                AstNode *import_target = module->import_list->list[i];
+                Module *imported =
+                        pipeline_submit_import(pipeline, import_target);
+                if (!imported)
+                        continue;
+
+                module->imports[module->import_count++] = imported;
+
+                // a checked module's wave needn't come before this
+                // one's if they import each other so only modules
+                // typed on demand, whose declarations are all in
+                // place once parsed, and loaded ones are bound
+                if (pipeline->lazy &&
+                    imported->position >= pipeline->input_module_count)
+                        import_target->import_target.module =
+                                imported->scope;
+        }
+
+        // declared before the module counts as parsed so they're in place
+        // before anything that reaches it is typed
+        if (module->lazy) {
+                declare_lazily(module->root, module->scope,
+                               &module->arena, &module_tables,
+                               module->filename);
+        }
+
+        module->state = ModuleState::TYPING;
+}
+
+static DWORD WINAPI pipeline_parse_worker(LPVOID param)
+{
+        Pipeline *pipeline = (Pipeline *)param;
+        LONG worker = InterlockedIncrement(&pipeline->parse_workers_started) - 1;
+        Arena *symbol_table_arena = &pipeline->worker_symbol_arenas[worker];
+
+        while (Module *module = pipeline->parse_queue.pop()) {
+                pipeline_parse_module(pipeline, module, symbol_table_arena);
+                pipeline_module_parsed(pipeline, module);
+        }
+
+        return 0;
+}
+
+// A module whose symbols point into its summary is released here, nothing
+// reads its tree once its bodies are checked. What it imports is kept for
+// writing its cache entry
+static void pipeline_module_typed(Pipeline *pipeline, Module *module)
+{
+        module->state = ModuleState::TYPED;
+
+        if (module->summary_arena.memory) {
+                Module **imports = (Module **)module->summary_arena.alloc(
+                        module->import_count * sizeof(Module *));
+                memcpy(imports, module->imports,
+                       module->import_count * sizeof(Module *));
+                module->imports = imports;
+
+                if (module->import_list) {
+                        module->import_list->destroy();
+                        module->import_list = nullptr;
+                }
+
+                module->arena.destroy();
+                module->arena = {};
+                module->token_array = {};
+                module->root = nullptr;
+                module->cache_entry = nullptr;
+        }
+
+        pipeline_finish_module(pipeline);
+}
+
+// Queues the bodies a module's type worker deferred, all of them go to one
+// worker's queue and the others steal from it
+static void pipeline_submit_bodies(Pipeline *pipeline, Module *module,
+                                   Arena *deferred_bodies)
+{
+        DeferredBody *deferred = (DeferredBody *)deferred_bodies->memory;
+        uint64_t count = deferred_bodies->offset / sizeof(DeferredBody);
+
+        // each body worker fills in its task's record
+        if (pipeline->incremental) {
+                ModuleRecords *records = &module->records;
+                records->arena = Arena::init(MEGABYTES(64));
+                records->bodies = (BodyRecord *)records->arena.alloc(
+                        count * sizeof(BodyRecord));
+                memset(records->bodies, 0, count * sizeof(BodyRecord));
+                records->body_count = (uint32_t)count;
+        }
+
+        if (!count) {
+                pipeline_module_typed(pipeline, module);
+                return;
+        }
+
+        // tasks are copied into the queue in one go, the deferred list
+        // doubles as their staging area
+        BodyTask *tasks = (BodyTask *)deferred_bodies->alloc(
+                count * sizeof(BodyTask));
+        for (uint64_t i = 0; i < count; ++i) {
+                tasks[i].module = module;
+                tasks[i].function_def = deferred[i].function_def;
+                tasks[i].scope = deferred[i].scope;
+                tasks[i].index = (uint32_t)i;
+        }
+
+        module->pending_bodies = (LONG)count;
+
+        LONG queue = InterlockedIncrement(&pipeline->next_body_queue);
+        pipeline->body_queues[queue % pipeline->workers_per_stage].push(
+                tasks, count);
+
+        AcquireSRWLockExclusive(&pipeline->lock);
+        InterlockedExchangeAdd(&pipeline->bodies_queued, (LONG)count);
+        ReleaseSRWLockExclusive(&pipeline->lock);
+        WakeAllConditionVariable(&pipeline->body_submitted);
+}
+
+// Only imported so nothing needs its tree once it's checked. The modules
+// of an import cycle are typed together so one's symbols can't be pointed
+// elsewhere while the others are reading them, those are kept
+static bool pipeline_module_is_released(Pipeline *pipeline, Module *module)
+{
+        if (module->position < pipeline->input_module_count || module->lazy) {
+                return false;
+        }
+
+        for (uint32_t i = 0; i < module->import_count; ++i) {
+                Module *imported = module->imports[i];
+                if (imported->position != UINT32_MAX &&
+                    imported->wave == module->wave)
+                        return false;
+        }
+
+        return true;
+}
+
+static DWORD WINAPI pipeline_type_worker(LPVOID param)
+{
+        Pipeline *pipeline = (Pipeline *)param;
+        LONG worker = InterlockedIncrement(&pipeline->type_workers_started) - 1;
+        Arena *symbol_table_arena = &pipeline->type_symbol_arenas[worker];
+
+        // the work stacks are per thread, everything else in tables is shared
+        Arena type_stack = Arena::init(MEGABYTES(64));
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        Arena deferred_bodies = Arena::init(MEGABYTES(64));
+        Tables worker_tables = *pipeline->tables;
+        worker_tables.type_stack = &type_stack;
+        worker_tables.deferred_bodies = &deferred_bodies;
+
+        while (Module *module = pipeline_next_module_to_type(pipeline)) {
+                deferred_bodies.clear();
+
+                // the run ends once the error cap is reached, what's left
+                // is only passed through the schedule
+                if (pipeline->tables->diagnostics->stopped) {
+                        pipeline_module_summarised(pipeline, module);
+                        pipeline_submit_bodies(pipeline, module,
+                                               &deferred_bodies);
+                        continue;
+                }
+
+                // what it imports is typed or loaded by now so its cache
+                // entry can be checked, a stale one means the module is
+                // parsed here. Its source is unchanged so everything it
+                // imports is already on the schedule
+                if (module->cache_entry) {
+                        if (summary_load(pipeline, module, symbol_table_arena)) {
+                                pipeline_module_summarised(pipeline, module);
+                                pipeline_submit_bodies(pipeline, module,
+                                                       &deferred_bodies);
+                                continue;
+                        }
+
+                        InputStream input_stream = pipeline_read_module(module);
+                        pipeline_lex_module(module, &input_stream);
+                        pipeline_parse_module(pipeline, module,
+                                              symbol_table_arena);
+                }
+
+                if (module->lazy) {
+                        pipeline_module_summarised(pipeline, module);
+                        pipeline_submit_bodies(pipeline, module,
+                                               &deferred_bodies);
+                        continue;
+                }
+
+                scope_stack.clear();
+                scope_stack_push(&scope_stack, pipeline->main_scope);
+
+                if (module->scope != pipeline->main_scope)
+                        scope_stack_push(&scope_stack, module->scope);
+
+                resolve_names(module->root, &scope_stack, &type_stack,
+                              worker_tables.symbol_table);
+                type_signatures(module->root, &module->arena, &scope_stack,
+                                &worker_tables, module->filename);
+
+                type_parse_tree(module->root, &module->arena, &scope_stack,
+                                &worker_tables, module->filename);
+
+                // before the bodies are queued, typing them writes to the
+                // function nodes
+                bool released = pipeline_module_is_released(pipeline, module);
+                if (released || summary_is_cached(pipeline, module)) {
+                        summary_extract(pipeline, module);
+                }
+
+                if (released) {
+                        summary_declare(pipeline, module, symbol_table_arena);
+                }
+
+                pipeline_module_summarised(pipeline, module);
+                pipeline_submit_bodies(pipeline, module, &deferred_bodies);
+        }
+
+        deferred_bodies.destroy();
+        scope_stack.destroy();
+        type_stack.destroy();
+
+        return 0;
+}
+
+static bool pipeline_next_body(Pipeline *pipeline, uint32_t worker,
+                               BodyTask *task)
+{
+        while (true) {
+                if (pipeline->body_queues[worker].pop(task)) {
+                        InterlockedDecrement(&pipeline->bodies_queued);
+                        return true;
+                }
+
+                for (uint32_t i = 1; i < pipeline->workers_per_stage; ++i) {
+                        uint32_t victim = (worker + i) % pipeline->workers_per_stage;
+                        if (pipeline->body_queues[victim].steal(task)) {
+                                InterlockedDecrement(&pipeline->bodies_queued);
+                                return true;
+                        }
+                }
+
+                // a steal can fail while another thief holds the queue so
+                // only sleep once nothing is queued anywhere
+                AcquireSRWLockExclusive(&pipeline->lock);
+                while (!pipeline->bodies_queued && !pipeline->finished) {
+                        SleepConditionVariableSRW(&pipeline->body_submitted,
+                                                  &pipeline->lock, INFINITE, 0);
+                }
+                bool finished = !pipeline->bodies_queued && pipeline->finished;
+                ReleaseSRWLockExclusive(&pipeline->lock);
+
+                if (finished) {
+                        return false;
+                }
+        }
+}
+
+// the scopes a body is typed in, from the outermost down to the one the
+// function is declared in
+static void pipeline_body_scope_stack(Pipeline *pipeline, BodyTask *task,
+                                      Arena *scope_stack)
+{
+        scope_stack->clear();
+        scope_stack_push(scope_stack, pipeline->main_scope);
+
+        Module *module = task->module;
+        if (module->scope != pipeline->main_scope)
+                scope_stack_push(scope_stack, module->scope);
+
+        uint64_t base = scope_stack->offset;
+        for (SymbolTableEntry *scope = task->scope;
+             scope && scope != module->scope; scope = scope->key.scope) {
+                scope_stack_push(scope_stack, scope);
+        }
+
+        // walked innermost first
+        SymbolTableEntry **scopes =
+                (SymbolTableEntry **)((char *)scope_stack->memory + base);
+        uint64_t count = (scope_stack->offset - base) / sizeof(SymbolTableEntry *);
+        for (uint64_t i = 0; i < count / 2; ++i) {
+                SymbolTableEntry *scope = scopes[i];
+                scopes[i] = scopes[count - 1 - i];
+                scopes[count - 1 - i] = scope;
+        }
+}
+
+static DWORD WINAPI pipeline_body_worker(LPVOID param)
+{
+        Pipeline *pipeline = (Pipeline *)param;
+        uint32_t worker =
+                (uint32_t)InterlockedIncrement(&pipeline->body_workers_started) -
+                1;
+
+        Arena *body_arena = &pipeline->body_arenas[worker];
+        Arena type_stack = Arena::init(MEGABYTES(64));
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        Arena symbol_reads = Arena::init(MEGABYTES(64));
+        Tables worker_tables = *pipeline->tables;
+        worker_tables.type_stack = &type_stack;
+        if (pipeline->incremental)
+                worker_tables.symbol_reads = &symbol_reads;
+
+        // errors are collected here without contending on the shared sink
+        // and merged after each body, printing sorts them so the order they
+        // arrive in doesn't show
+        worker_tables.diagnostics = Diagnostics::create(body_arena, 0);
+
+        BodyTask task;
+        while (pipeline_next_body(pipeline, worker, &task)) {
+                Module *module = task.module;
+                pipeline_body_scope_stack(pipeline, &task, &scope_stack);
+
+                symbol_reads.clear();
+                if (!pipeline->tables->diagnostics->stopped) {
+                        type_parse_tree(task.function_def, body_arena,
+                                        &scope_stack, &worker_tables,
+                                        module->filename);
+                }
+
+                if (pipeline->incremental) {
+                        record_body(&module->records.bodies[task.index], &task,
+                                    &worker_tables, body_arena, &type_stack);
+                }
+                pipeline->tables->diagnostics->merge(worker_tables.diagnostics);
+
+                if (InterlockedDecrement(&module->pending_bodies) == 0) {
+                        pipeline_module_typed(pipeline, module);
+                }
+        }
+
+        worker_tables.diagnostics->destroy();
+        symbol_reads.destroy();
+        scope_stack.destroy();
+        type_stack.destroy();
+
+        return 0;
+}
+
+void Pipeline::run()
+{
+        if (this->module_count == 0) {
+                return;
+        }
+
+        this->parse_workers_started = 0;
+        this->type_workers_started = 0;
+        this->body_workers_started = 0;
+        this->input_module_count = this->module_count;
+        this->tables->lazy_declarations->builtins = this->main_scope;
+
+        LPTHREAD_START_ROUTINE stages[] = {
+                pipeline_lex_worker,
+                pipeline_parse_worker,
+                pipeline_type_worker,
+                pipeline_body_worker,
+        };
+
+        for (int stage = 0; stage < array_count(stages); ++stage) {
+                for (uint32_t i = 0; i < this->workers_per_stage; ++i) {
+                        HANDLE thread = CreateThread(0, MEGABYTES(8),
+                                                     stages[stage], this,
+                                                     0, 0);
+
+                        if (!thread) {
+                                fprintf(stderr, "Failed to start worker thread\n");
+                                exit(1);
+                        }
+
+                        this->threads[this->thread_count++] = thread;
+                }
+        }
+
+        WaitForMultipleObjects(this->thread_count, this->threads, TRUE,
+                               INFINITE);
+
+        for (uint32_t i = 0; i < this->thread_count; ++i) {
+                CloseHandle(this->threads[i]);
+        }
+
+        this->thread_count = 0;
+}
+
+void Pipeline::destroy()
+{
+        for (uint32_t i = 0; i < this->workers_per_stage; ++i) {
+                this->worker_symbol_arenas[i].destroy();
+                this->body_arenas[i].destroy();
+                this->type_symbol_arenas[i].destroy();
+                this->body_queues[i].arena.destroy();
+        }
+
+        for (uint32_t i = 0; i < this->module_count; ++i) {
+                Module *module = this->modules[i];
+                if (module->import_list)
+                        module->import_list->destroy();
+                if (module->records.arena.memory)
+                        module->records.arena.destroy();
+                if (module->summary.memory)
+                        module->summary.destroy();
+                if (module->summary_arena.memory)
+                        module->summary_arena.destroy();
+                if (module->arena.memory)
+                        module->arena.destroy();
+        }
+
+        this->registry.destroy();
+        this->schedule.arena.destroy();
+        this->schedule.scratch.destroy();
+        this->schedule.pending.destroy();
+        this->schedule.order_list.destroy();
+        this->module_list.destroy();
+        this->module_arena.destroy();
+}
@@ -0,0 +1,271 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include <stdint.h>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "main.h"
+#include "utils.h"
+#include "tokeniser.h"
+#include "tables.h"
+#include "incremental.h"
+#include "summary.h"
+
+struct AstNode;
+
+#define MODULE_QUEUE_CAPACITY 64
+#define MODULE_REGISTRY_INITIAL_CAPACITY 64
+#define MAX_STAGE_WORKERS 16
+
+enum class ModuleState {
+        // submitted and waiting to be lexed
+        PENDING,
+        // lexed, waiting for or being parsed
+        PARSING,
+        // parsed, waiting for or being typed, or its function bodies are
+        // still being typed
+        TYPING,
+        // every symbol the module declares is typed in its scope and every
+        // function body is checked, or for a lazy module its declarations
+        // are ready to be typed on demand
+        TYPED,
+};
+
+struct ScheduleDependent;
+
+// A module moves lex -> parse -> type -> bodies, each stage runs on its own
+// pool of worker threads so while one module is being typed the next can be
+// parsed and the one after that lexed. The type stage records the module's
+// signatures and types its top level, the function bodies are then typed
+// independently of each other by the body workers
+struct Module {
+        // canonical dotted name, or the path for modules given on the
+        // command line
+        std::string name;
+        uint32_t name_hash;
+        char filename[2048];
+        uint32_t line_count;
+        // only written by the stage that has the module
+        ModuleState state;
+
+        // tokens, the ast and any types allocated while typing live here,
+        // released once the module is typed unless it's being checked
+        Arena arena;
+        TokenArray token_array;
+        ImportList *import_list;
+        AstNode *root;
+        // the module's summary, what importing it declares
+        SymbolTableEntry *scope;
+        // the modules it imports, in the module's arena
+        Module **imports;
+        uint32_t import_count;
+        // index in Pipeline::modules, UINT32_MAX for loaded modules
+        uint32_t position;
+        uint32_t wave;
+        // set under the pipeline's lock once what it imports is submitted
+        bool parsed;
+        // it and the rest of its import cycle have their wave
+        bool scheduled;
+        // what importing it declares is typed, set under the pipeline's
+        // lock by its type worker
+        bool summarised;
+        // a cycle is released together, these are kept on its first member
+        // and the others are linked from it. The imports outside the cycle
+        // whose summaries aren't typed yet, it's handed to the type workers
+        // once there are none. Guarded by the pipeline's lock as are the
+        // dependents
+        uint32_t imports_waiting;
+        Module *next_in_component;
+        // the first members of the cycles waiting on this one's summary
+        ScheduleDependent *dependents;
+        // only imported, its declarations are typed when something looks
+        // them up and its bodies are never checked
+        bool lazy;
+        // bodies left to type, the worker that types the last one finishes
+        // the module
+        volatile LONG pending_bodies;
+        // only kept when checking incrementally
+        ModuleRecords records;
+        // when caching summaries, 0 until the module's summary is typed
+        // or loaded and always for modules that don't have one
+        uint64_t source_hash;
+        uint64_t summary_hash;
+        // the module's cache entry when its source hashed the same, it's
+        // loaded in place of typing the module if its dependencies'
+        // summaries do too. In the module's arena
+        const char *cache_entry;
+        uint64_t cache_entry_size;
+        // written to the cache once the module is checked
+        Arena summary;
+        // the nodes and types of what the summary declares. A module that's
+        // only imported has its symbols pointed here once its top level is
+        // typed and its own arena is released when its bodies are checked
+        Arena summary_arena;
+};
+
+// A function body of module, scope is the one the function is declared in
+struct BodyTask {
+        Module *module;
+        AstNode *function_def;
+        SymbolTableEntry *scope;
+        // of the body's record in module's records
+        uint32_t index;
+};
+
+// Each body worker has one of these, it pops the newest task from its own
+// and once that's empty steals the oldest from the others. Items grows in
+// place and is rewound whenever the queue empties
+struct BodyQueue {
+        Arena arena;
+        BodyTask *items;
+        uint64_t head;
+        uint64_t tail;
+        SRWLOCK lock;
+
+        void push(BodyTask *tasks, uint64_t count);
+        bool pop(BodyTask *task);
+        bool steal(BodyTask *task);
+};
+
+// Every module by name so submitting an import is one probe however many
+// modules there are. An import cycle finds the module it started from
+// here rather than submitting it again. Open addressing on the name hash
+// kept at most half full
+struct ModuleRegistry {
+        Arena arena;
+        Module **slots;
+        uint64_t capacity;
+        uint64_t count;
+
+        static ModuleRegistry init(uint64_t capacity);
+        Module *find(std::string &name, uint32_t hash);
+        void insert(Module *module);
+        void destroy();
+};
+
+struct ScheduleDependent {
+        Module *module;
+        ScheduleDependent *next;
+};
+
+// Modules are typed in waves over the import graph, a module's wave comes
+// after the waves of everything it imports so their summaries are typed
+// first. The modules of an import cycle share a wave. A cycle, or a module
+// outside one, gets its wave once everything it reaches is parsed and each
+// module is released to the type stage once what it imports is summarised,
+// so typing overlaps parsing
+struct WaveSchedule {
+        // the dependents
+        Arena arena;
+        // a pass's Tarjan state, cleared by each pass
+        Arena scratch;
+        // parsed modules that don't have a wave yet
+        Arena pending;
+        // every module in the order it's released, grows in place
+        Arena order_list;
+        Module **order;
+        // order[next, released) can be typed now
+        uint32_t next;
+        uint32_t released;
+};
+
+// bounded so a fast stage can't run arbitrarily far ahead of a slow one
+struct ModuleQueue {
+        Module *items[MODULE_QUEUE_CAPACITY];
+        uint32_t head;
+        uint32_t count;
+        bool closed;
+        SRWLOCK lock;
+        CONDITION_VARIABLE not_empty;
+        CONDITION_VARIABLE not_full;
+
+        void push(Module *module);
+        // returns nullptr once the queue is closed and drained
+        Module *pop();
+        void close();
+};
+
+struct Pipeline {
+        // every module ever submitted in submission order, modules waiting to
+        // be lexed are [next_to_lex, module_count). This list is unbounded on
+        // purpose as parse workers submit imports to it and must never block,
+        // it grows in place in module_list
+        Arena module_list;
+        Module **modules;
+        uint32_t module_count;
+        uint32_t next_to_lex;
+        bool finished;
+        SRWLOCK lock;
+        CONDITION_VARIABLE module_submitted;
+        volatile LONG modules_in_flight;
+        // the submitted modules and the ones declared from the builtins
+        // snapshot, which are never lexed. Guarded by lock
+        ModuleRegistry registry;
+
+        ModuleQueue parse_queue;
+        // the type stage is fed by the schedule, both are guarded by lock
+        WaveSchedule schedule;
+        CONDITION_VARIABLE module_ready;
+
+        Arena module_arena;
+        Tables *tables;
+        // symbols inserted under the pipeline lock, parse workers insert
+        // into the symbol table concurrently so each has its own arena
+        Arena *symbol_table_arena;
+        Arena worker_symbol_arenas[MAX_STAGE_WORKERS];
+        volatile LONG parse_workers_started;
+        SymbolTableEntry *main_scope;
+        AstNode *module_node;
+        PythonPath *path;
+
+        BodyQueue body_queues[MAX_STAGE_WORKERS];
+        // tasks in any of the body queues, only raised under lock
+        volatile LONG bodies_queued;
+        CONDITION_VARIABLE body_submitted;
+        volatile LONG next_body_queue;
+        volatile LONG body_workers_started;
+        // types allocated while typing bodies, a worker's live as long as
+        // the modules do
+        Arena body_arenas[MAX_STAGE_WORKERS];
+
+        uint32_t workers_per_stage;
+        // check the modules submitted before run, the ones they import are
+        // only typed as far as they're used
+        bool lazy;
+        uint32_t input_module_count;
+        // record what each function body reads and reports so a checked
+        // module can be rechecked with pipeline_recheck
+        bool incremental;
+        // load the summaries of unchanged modules from here and write the
+        // summaries of the ones that were checked, null when not caching
+        const char *cache_directory;
+        volatile LONG summaries_loaded;
+        // symbols declared by type workers, from a summary or a module that
+        // was only parsed once its cache entry turned out to be stale
+        Arena type_symbol_arenas[MAX_STAGE_WORKERS];
+        volatile LONG type_workers_started;
+        HANDLE threads[4 * MAX_STAGE_WORKERS];
+        uint32_t thread_count;
+
+        static Pipeline *create(Arena *arena, Tables *tables,
+                                Arena *symbol_table_arena,
+                                SymbolTableEntry *main_scope,
+                                AstNode *module_node, PythonPath *path,
+                                uint32_t workers_per_stage);
+        Module *submit(std::string name, const char *filename,
+                       SymbolTableEntry *scope);
+        Module *add_loaded(std::string name, SymbolTableEntry *scope);
+        void run();
+        void destroy();
+};
+
+static Module *pipeline_submit_import(Pipeline *pipeline, AstNode *import_target);
+static Module *pipeline_submit_import_name(Pipeline *pipeline,
+                                           std::string &name);
+static uint32_t pipeline_default_workers_per_stage();
+
+#endif // PIPELINE_H_
@@ -1,6 +1,12 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
+#define MAX_RECORDS 1024
+#define MAX_STRUCT_MEMBERS 16
+#define MAX_PAYLOAD_TAGS 8
+
 struct Tokeniser {
         char *at;
 };
@@ -100,7 +106,116 @@ int inline char_to_num(char c) {
         return c - '0';
 }
 
-void parse_struct_members(Tokeniser *tokeniser, char *struct_name, int name_size)
+// every enum member seen so far as "Enum::MEMBER", payload tags name these
+struct EnumValueRecord {
+        char name[256];
+        int value;
+};
+
+struct MemberRecord {
+        // the meta type name, AstNode_PTR for AstNode *
+        char type[256];
+        char name[256];
+};
+
+// AstNode pointers in an introspected struct are the children of a node
+struct StructRecord {
+        char name[256];
+        int member_count;
+        int child_count;
+        MemberRecord members[MAX_STRUCT_MEMBERS];
+};
+
+// a member of a tagged union that holds the struct for one tag value
+struct PayloadRecord {
+        char enum_name[256];
+        int value;
+        StructRecord *struct_record;
+};
+
+EnumValueRecord enum_values[MAX_RECORDS];
+int enum_value_count;
+StructRecord struct_records[MAX_RECORDS];
+int struct_record_count;
+PayloadRecord payloads[MAX_RECORDS];
+int payload_count;
+
+// FNV-1a over everything introspected or marked schema, a cache written
+// with a different layout of any of these structs or enums is rejected when
+// read
+uint64_t schema_hash = 14695981039346656037ull;
+bool schema_hashed;
+
+void schema_hash_string(const char *string)
+{
+        schema_hashed = true;
+        for (; *string; ++string) {
+                schema_hash ^= (uint8_t)*string;
+                schema_hash *= 1099511628211ull;
+        }
+
+        // separate the strings so "ab", "c" doesn't hash as "a", "bc"
+        schema_hash ^= 0xff;
+        schema_hash *= 1099511628211ull;
+}
+
+// Packed field by field, every meta type has a serialize_<type> and
+// deserialize_<type> in serialize.h or generated for enums
+void print_struct_serializers(StructRecord *record)
+{
+        printf("static void serialize_%s(Serializer *serializer, %s *value)\n{\n",
+               record->name, record->name);
+        for (int i = 0; i < record->member_count; ++i) {
+                printf("        serialize_%s(serializer, &value->%s);\n",
+                       record->members[i].type, record->members[i].name);
+        }
+        printf("}\n");
+
+        printf("static void deserialize_%s(Deserializer *deserializer, %s *value)\n{\n",
+               record->name, record->name);
+        for (int i = 0; i < record->member_count; ++i) {
+                printf("        deserialize_%s(deserializer, &value->%s);\n",
+                       record->members[i].type, record->members[i].name);
+        }
+        printf("}\n");
+}
+
+// written as the smallest unsigned integer holding every value, anything
+// past the last value fails the read
+void print_enum_serializers(const char *name, int name_size, int max_value)
+{
+        const char *raw_type = max_value > UINT8_MAX ? "uint32_t" : "uint8_t";
+
+        printf("static void serialize_%.*s(Serializer *serializer, %.*s *value)\n{\n",
+               name_size, name, name_size, name);
+        printf("        %s raw = (%s)*value;\n", raw_type, raw_type);
+        printf("        serialize_%s(serializer, &raw);\n", raw_type);
+        printf("}\n");
+
+        printf("static void deserialize_%.*s(Deserializer *deserializer, %.*s *value)\n{\n",
+               name_size, name, name_size, name);
+        printf("        %s raw = 0;\n", raw_type);
+        printf("        deserialize_%s(deserializer, &raw);\n", raw_type);
+        printf("        if (raw > %d)\n", max_value);
+        printf("                deserializer->failed = true;\n");
+        printf("        *value = (%.*s)raw;\n", name_size, name);
+        printf("}\n");
+}
+
+StructRecord *find_struct_record(const char *name, int name_size)
+{
+        for (int i = 0; i < struct_record_count; ++i) {
+                if ((int)strlen(struct_records[i].name) == name_size &&
+                    strncmp(struct_records[i].name, name, name_size) == 0) {
+                        return &struct_records[i];
+                }
+        }
+
+        return nullptr;
+}
+
+void parse_struct_members(Tokeniser *tokeniser, char *struct_name, int name_size,
+                          StructRecord *record)
 {
         char buffer[256];
         while (*(tokeniser->at) && *(tokeniser->at) != '}') {
@@ -122,10 +237,26 @@ void parse_struct_members(Tokeniser *tokeniser, char *struct_name, int name_size
                 printf("{TYPE_%.*s, ", bytes_written,
                        buffer);
 
+                if (record->member_count >= MAX_STRUCT_MEMBERS) {
+                        fprintf(stderr, "too many members in %.*s\n",
+                                name_size, struct_name);
+                        exit(1);
+                }
+
+                MemberRecord *member = &record->members[record->member_count++];
+                snprintf(member->type, sizeof(member->type), "%.*s",
+                         bytes_written, buffer);
+                if (strcmp(member->type, "AstNode_PTR") == 0) {
+                        record->child_count++;
+                }
+
                 bytes_written = get_into_buffer_until_char(
                         tokeniser, ';', buffer,
                         sizeof(buffer));
 
+                snprintf(member->name, sizeof(member->name), "%.*s",
+                         bytes_written, buffer);
+
                 printf("\"%.*s\", ", bytes_written,
                        buffer);
                 printf("(uint64_t)&((%.*s *)0)->%.*s", name_size,
@@ -150,12 +281,46 @@ void parse_struct(Tokeniser *tokeniser)
         printf("StructMemberDefinition %.*sStructMembers[] = \n{\n", name_bytes_written,
                name);
 
-        parse_struct_members(tokeniser, name, name_bytes_written);
+        if (struct_record_count >= MAX_RECORDS) {
+                fprintf(stderr, "too many structs\n");
+                exit(1);
+        }
+
+        StructRecord *record = &struct_records[struct_record_count++];
+        snprintf(record->name, sizeof(record->name), "%.*s",
+                 name_bytes_written, name);
+
+        parse_struct_members(tokeniser, name, name_bytes_written, record);
 
         printf("};");
 
         printf("\n");
 
+        schema_hash_string("struct");
+        schema_hash_string(record->name);
+        for (int i = 0; i < record->member_count; ++i) {
+                schema_hash_string(record->members[i].type);
+                schema_hash_string(record->members[i].name);
+        }
+
+        print_struct_serializers(record);
+
+        if (!record->child_count) {
+                return;
+        }
+
+        // just the offsets of the child links so walking a node doesn't
+        // have to skip over its other members
+        printf("uint16_t %sChildOffsets[] = \n{\n", record->name);
+        for (int i = 0; i < record->member_count; ++i) {
+                if (strcmp(record->members[i].type, "AstNode_PTR") != 0) {
+                        continue;
+                }
+
+                printf("(uint16_t)(uint64_t)&((%s *)0)->%s,\n", record->name,
+                       record->members[i].name);
+        }
+        printf("};\n");
 }
 void parse_enum(Tokeniser *tokeniser)
 {
@@ -172,7 +337,16 @@ void parse_enum(Tokeniser *tokeniser)
         printf("EnumMemberDefinition %.*sEnumMembers[] =\n{\n",
                bytes_written, buffer);
 
+        // the name is read from just after "class" so skip the space
+        char enum_name[256];
+        int enum_name_size = 0;
+        for (int i = 0; i < bytes_written; ++i) {
+                if (!is_whitespace(buffer[i]))
+                        enum_name[enum_name_size++] = buffer[i];
+        }
+
         int last_val = 0;
+        int max_value = 0;
         while (*(tokeniser->at) && *(tokeniser->at) != '}') {
                 bytes_written = 0;
                 while (*(tokeniser->at) &&
@@ -191,6 +365,16 @@ void parse_enum(Tokeniser *tokeniser)
 
                 goto_next_word(tokeniser);
 
+                if (enum_value_count >= MAX_RECORDS) {
+                        fprintf(stderr, "too many enum members\n");
+                        exit(1);
+                }
+
+                EnumValueRecord *value_record = &enum_values[enum_value_count++];
+                snprintf(value_record->name, sizeof(value_record->name),
+                         "%.*s::%.*s", enum_name_size, enum_name, bytes_written,
+                         buffer);
+
                 printf("{\"%.*s\", ", bytes_written,
                        buffer);
                 if (match_key_word(
@@ -217,9 +401,284 @@ void parse_enum(Tokeniser *tokeniser)
                 } else {
                         printf("%.d", ++last_val);
                 } // skip the equals if there is one
+                value_record->value = last_val;
+                if (last_val > max_value) {
+                        max_value = last_val;
+                }
                 printf("},\n");
+
+                char value_string[32];
+                snprintf(value_string, sizeof(value_string), "%d", last_val);
+                schema_hash_string(value_record->name);
+                schema_hash_string(value_string);
         }
         printf("};\n");
+
+        print_enum_serializers(enum_name, enum_name_size, max_value);
+}
+
+// payload(Enum::A, Enum::B) StructName member; marks the union member
+// holding StructName when the tag is A or B
+void parse_payload(Tokeniser *tokeniser)
+{
+        char tags[MAX_PAYLOAD_TAGS][256];
+        int tag_count = 0;
+
+        eat_whitespace(tokeniser);
+        while (*(tokeniser->at) && *(tokeniser->at) != ')') {
+                if (tag_count >= MAX_PAYLOAD_TAGS) {
+                        fprintf(stderr, "too many payload tags\n");
+                        exit(1);
+                }
+
+                int bytes_written = 0;
+                while (*(tokeniser->at) && *(tokeniser->at) != ',' &&
+                       *(tokeniser->at) != ')' &&
+                       !is_whitespace(*(tokeniser->at)) &&
+                       bytes_written < (int)sizeof(tags[0]) - 1) {
+                        tags[tag_count][bytes_written++] = *(tokeniser->at);
+                        next_char(tokeniser);
+                }
+                tags[tag_count++][bytes_written] = '\0';
+
+                eat_whitespace(tokeniser);
+                if (*(tokeniser->at) == ',') {
+                        next_char(tokeniser);
+                        eat_whitespace(tokeniser);
+                }
+        }
+
+        goto_next_word(tokeniser);
+
+        char name[256];
+        int name_bytes_written = get_into_buffer_until_char(
+                tokeniser, ' ', name, sizeof(name));
+
+        StructRecord *struct_record =
+                find_struct_record(name, name_bytes_written);
+        if (!struct_record) {
+                fprintf(stderr, "payload %.*s isn't an introspected struct\n",
+                        name_bytes_written, name);
+                exit(1);
+        }
+
+        for (int i = 0; i < tag_count; ++i) {
+                EnumValueRecord *value_record = nullptr;
+                for (int j = 0; j < enum_value_count; ++j) {
+                        if (strcmp(enum_values[j].name, tags[i]) == 0) {
+                                value_record = &enum_values[j];
+                                break;
+                        }
+                }
+
+                const char *separator = strstr(tags[i], "::");
+                if (!value_record || !separator) {
+                        fprintf(stderr, "unknown payload tag %s\n", tags[i]);
+                        exit(1);
+                }
+
+                if (payload_count >= MAX_RECORDS) {
+                        fprintf(stderr, "too many payloads\n");
+                        exit(1);
+                }
+
+                PayloadRecord *payload = &payloads[payload_count++];
+                snprintf(payload->enum_name, sizeof(payload->enum_name),
+                         "%.*s", (int)(separator - tags[i]), tags[i]);
+                payload->value = value_record->value;
+                payload->struct_record = struct_record;
+        }
+}
+
+// schema struct Name {...} or schema followed by a #define marks something
+// serialized by hand, its text without whitespace and comments is hashed so
+// editing it changes the schema hash, nothing is generated for it and the
+// tokeniser isn't moved so annotations inside it are still seen
+void parse_schema(Tokeniser *tokeniser)
+{
+        Tokeniser text = *tokeniser;
+        eat_whitespace(&text);
+
+        bool is_define = strncmp(text.at, "#define", 7) == 0;
+        if (!is_define && strncmp(text.at, "struct", 6) != 0) {
+                fprintf(stderr, "schema must mark a struct or a #define\n");
+                exit(1);
+        }
+
+        char buffer[1 << 14];
+        int bytes_written = 0;
+        int depth = 0;
+        bool opened = false;
+        bool continued = false;
+        bool in_string = false;
+        while (*(text.at)) {
+                char c = *(text.at);
+                if (!in_string && c == '/' && text.at[1] == '/') {
+                        while (*(text.at) && *(text.at) != '\n') {
+                                next_char(&text);
+                        }
+                        continue;
+                }
+
+                if (is_define && c == '\n' && !continued) {
+                        break;
+                }
+
+                next_char(&text);
+                if (is_define && c == '\\') {
+                        continued = true;
+                        continue;
+                }
+                if (is_whitespace(c)) {
+                        continue;
+                }
+                continued = false;
+
+                if (c == '"') {
+                        in_string = !in_string;
+                }
+
+                if (bytes_written >= (int)sizeof(buffer) - 1) {
+                        fprintf(stderr, "schema declaration too long\n");
+                        exit(1);
+                }
+                buffer[bytes_written++] = c;
+
+                if (in_string || is_define) {
+                        continue;
+                }
+
+                if (c == '{') {
+                        ++depth;
+                        opened = true;
+                } else if (c == '}') {
+                        --depth;
+                }
+
+                if (opened && !depth) {
+                        break;
+                }
+        }
+        buffer[bytes_written] = '\0';
+
+        schema_hash_string("schema");
+        schema_hash_string(buffer);
+}
+
+// the tag is written separately, this only handles the union member
+void print_payload_serializers(const char *enum_name)
+{
+        const char *directions[][3] = {
+                {"serialize", "Serializer", "serializer"},
+                {"deserialize", "Deserializer", "deserializer"},
+        };
+
+        for (int d = 0; d < 2; ++d) {
+                printf("static void %s_%s_payload(%s *%s, %s tag, void *payload)\n{\n",
+                       directions[d][0], enum_name, directions[d][1],
+                       directions[d][2], enum_name);
+                printf("        switch (tag) {\n");
+                for (int i = 0; i < payload_count; ++i) {
+                        if (strcmp(payloads[i].enum_name, enum_name) != 0) {
+                                continue;
+                        }
+
+                        const char *tag = nullptr;
+                        for (int j = 0; j < enum_value_count; ++j) {
+                                size_t enum_name_size = strlen(enum_name);
+                                if (enum_values[j].value == payloads[i].value &&
+                                    strncmp(enum_values[j].name, enum_name,
+                                            enum_name_size) == 0 &&
+                                    enum_values[j].name[enum_name_size] == ':') {
+                                        tag = enum_values[j].name;
+                                        break;
+                                }
+                        }
+
+                        const char *struct_name = payloads[i].struct_record->name;
+                        printf("        case %s:\n", tag);
+                        printf("                %s_%s(%s, (%s *)payload);\n",
+                               directions[d][0], struct_name, directions[d][2],
+                               struct_name);
+                        printf("                break;\n");
+                }
+                printf("        default:\n");
+                printf("                break;\n");
+                printf("        }\n");
+                printf("}\n");
+        }
+}
+
+// One table per tag enum indexed by the tag's value, tags without a
+// payload get an empty entry
+void print_payload_tables()
+{
+        for (int i = 0; i < payload_count; ++i) {
+                bool printed = false;
+                for (int j = 0; j < i; ++j) {
+                        if (strcmp(payloads[j].enum_name,
+                                   payloads[i].enum_name) == 0) {
+                                printed = true;
+                                break;
+                        }
+                }
+
+                if (printed) {
+                        continue;
+                }
+
+                const char *enum_name = payloads[i].enum_name;
+                size_t enum_name_size = strlen(enum_name);
+                int max_value = 0;
+                for (int j = 0; j < enum_value_count; ++j) {
+                        if (strncmp(enum_values[j].name, enum_name,
+                                    enum_name_size) == 0 &&
+                            enum_values[j].name[enum_name_size] == ':' &&
+                            enum_values[j].value > max_value) {
+                                max_value = enum_values[j].value;
+                        }
+                }
+
+                schema_hash_string("payload");
+                for (int j = 0; j < payload_count; ++j) {
+                        if (strcmp(payloads[j].enum_name, enum_name) != 0) {
+                                continue;
+                        }
+
+                        char value_string[32];
+                        snprintf(value_string, sizeof(value_string), "%d",
+                                 payloads[j].value);
+                        schema_hash_string(value_string);
+                        schema_hash_string(payloads[j].struct_record->name);
+                }
+
+                print_payload_serializers(enum_name);
+
+                printf("PayloadDefinition %sPayloads[] =\n{\n", enum_name);
+                for (int value = 0; value <= max_value; ++value) {
+                        StructRecord *record = nullptr;
+                        for (int j = 0; j < payload_count; ++j) {
+                                if (payloads[j].value == value &&
+                                    strcmp(payloads[j].enum_name,
+                                           enum_name) == 0) {
+                                        record = payloads[j].struct_record;
+                                        break;
+                                }
+                        }
+
+                        if (!record) {
+                                printf("{nullptr, 0, nullptr, 0},\n");
+                        } else if (!record->child_count) {
+                                printf("{%sStructMembers, %d, nullptr, 0},\n",
+                                       record->name, record->member_count);
+                        } else {
+                                printf("{%sStructMembers, %d, %sChildOffsets, %d},\n",
+                                       record->name, record->member_count,
+                                       record->name, record->child_count);
+                        }
+                }
+                printf("};\n");
+        }
 }
 
 int main(int argc, char **argv)
@@ -255,6 +714,18 @@ int main(int argc, char **argv)
         tokeniser.at = file_buffer;
         while (*(tokeniser.at)) {
                 eat_whitespace(&tokeniser);
+                if (match_key_word(&tokeniser, "payload(",
+                                   sizeof("payload(") - 1)) {
+                        parse_payload(&tokeniser);
+                        continue;
+                }
+
+                if (match_key_word(&tokeniser, "schema",
+                                   sizeof("schema") - 1)) {
+                        parse_schema(&tokeniser);
+                        continue;
+                }
+
                 if (!match_key_word(&tokeniser, "introspect",
                                     sizeof("introspect") - 1)) {
                         next_char(&tokeniser);
@@ -271,4 +742,30 @@ int main(int argc, char **argv)
                 }
                 continue;
         }
+
+        print_payload_tables();
+
+        if (!schema_hashed) {
+                return 0;
+        }
+
+        // PARSER_H_SCHEMA_HASH for ../parser.h
+        const char *file_name = argv[1];
+        for (const char *at = argv[1]; *at; ++at) {
+                if (*at == '/' || *at == '\\') {
+                        file_name = at + 1;
+                }
+        }
+
+        printf("#define ");
+        for (const char *at = file_name; *at; ++at) {
+                char c = *at;
+                if (c >= 'a' && c <= 'z') {
+                        c = c - 'a' + 'A';
+                } else if (!(c >= 'A' && c <= 'Z') && !(c >= '0' && c <= '9')) {
+                        c = '_';
+                }
+                printf("%c", c);
+        }
+        printf("_SCHEMA_HASH 0x%016llxull\n", (unsigned long long)schema_hash);
 }
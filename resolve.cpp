@@ -0,0 +1,258 @@
+#include <stdint.h>
+#include <assert.h>
+
+#include "resolve.h"
+#include "traversal.h"
+
+static inline uint32_t resolve_scope_count(NameResolver *resolver)
+{
+        return resolver->scopes.offset / sizeof(ResolveScope);
+}
+
+static inline ResolveScope *resolve_scope_at(NameResolver *resolver,
+                                             uint32_t index)
+{
+        return &((ResolveScope *)resolver->scopes.memory)[index];
+}
+
+static inline void resolve_chain_push(NameResolver *resolver,
+                                      SymbolTableEntry *scope)
+{
+        SymbolTableEntry **link =
+                (SymbolTableEntry **)resolver->chain.alloc(sizeof(*link));
+        *link = scope;
+}
+
+static bool resolve_collect_declaration(AstNode *node, uint32_t,
+                                        void *user_data)
+{
+        NameResolver *resolver = (NameResolver *)user_data;
+
+        // nested scopes have their own declarations
+        if (node->type == AstNodeType::FUNCTION_DEF ||
+            node->type == AstNodeType::CLASS_DEF ||
+            node->type == AstNodeType::LAMBDA) {
+                return false;
+        }
+
+        if (node->type != AstNodeType::NARY ||
+            (node->token.type != TokenType::GLOBAL &&
+             node->token.type != TokenType::NONLOCAL)) {
+                return true;
+        }
+
+        ResolveScope *scope =
+                resolve_scope_at(resolver, resolve_scope_count(resolver) - 1);
+
+        for (AstNode *name = node->nary.children; name;
+             name = name->adjacent_child) {
+                ResolveDeclaration *declaration =
+                        (ResolveDeclaration *)resolver->declarations.alloc(
+                                sizeof(*declaration));
+                declaration->name = name;
+                declaration->nonlocal = node->token.type == TokenType::NONLOCAL;
+                ++scope->declaration_count;
+        }
+
+        return false;
+}
+
+static void resolve_push_scope(NameResolver *resolver, SymbolTableEntry *entry,
+                               ResolveScopeKind kind, AstNode *block)
+{
+        ResolveScope *scope =
+                (ResolveScope *)resolver->scopes.alloc(sizeof(*scope));
+        scope->entry = entry;
+        scope->kind = kind;
+        scope->first_declaration =
+                resolver->declarations.offset / sizeof(ResolveDeclaration);
+        scope->declaration_count = 0;
+
+        // a global or nonlocal statement applies to the whole body
+        for (AstNode *statement = block; statement;
+             statement = statement->adjacent_child) {
+                ast_visit(statement, resolver->stack,
+                          resolve_collect_declaration, resolver);
+        }
+}
+
+static void resolve_pop_scope(NameResolver *resolver)
+{
+        ResolveScope *scope =
+                resolve_scope_at(resolver, resolve_scope_count(resolver) - 1);
+        resolver->declarations.offset =
+                scope->first_declaration * sizeof(ResolveDeclaration);
+        resolver->scopes.offset -= sizeof(ResolveScope);
+}
+
+static ResolveDeclaration *resolve_find_declaration(NameResolver *resolver,
+                                                   ResolveScope *scope,
+                                                   std::string &name)
+{
+        ResolveDeclaration *declarations =
+                (ResolveDeclaration *)resolver->declarations.memory +
+                scope->first_declaration;
+
+        for (uint32_t i = 0; i < scope->declaration_count; ++i) {
+                if (declarations[i].name->token.value == name) {
+                        return &declarations[i];
+                }
+        }
+
+        return nullptr;
+}
+
+static SymbolTableEntry *resolve_identifier(NameResolver *resolver,
+                                            AstNode *node)
+{
+        uint32_t scope_count = resolve_scope_count(resolver);
+        uint32_t local = scope_count - 1;
+        ResolveScope *local_scope = resolve_scope_at(resolver, local);
+
+        ResolveDeclaration *declaration =
+                resolve_find_declaration(resolver, local_scope,
+                                         node->token.value);
+
+        resolver->chain.offset = 0;
+
+        // a nonlocal name skips the globals as well as the local scope
+        if (!declaration || !declaration->nonlocal) {
+                for (uint32_t i = 0; i <= resolver->global_scope; ++i) {
+                        resolve_chain_push(resolver,
+                                           resolve_scope_at(resolver, i)->entry);
+                }
+        }
+
+        if (!declaration || declaration->nonlocal) {
+                for (uint32_t i = resolver->global_scope + 1; i < local; ++i) {
+                        ResolveScope *scope = resolve_scope_at(resolver, i);
+                        if (scope->kind == ResolveScopeKind::FUNCTION) {
+                                resolve_chain_push(resolver, scope->entry);
+                        }
+                }
+        }
+
+        if (!declaration && local > resolver->global_scope) {
+                resolve_chain_push(resolver, local_scope->entry);
+        }
+
+        return resolver->symbol_table->lookup_in_scopes(
+                node->token.value, (SymbolTableEntry **)resolver->chain.memory,
+                resolver->chain.offset / sizeof(SymbolTableEntry *));
+}
+
+static void resolve_list(NameResolver *resolver, AstNode *head);
+
+static bool resolve_visit(AstNode *node, uint32_t, void *user_data)
+{
+        NameResolver *resolver = (NameResolver *)user_data;
+
+        switch (node->type) {
+        case AstNodeType::IDENTIFIER: {
+                node->identifier.symbol = resolve_identifier(resolver, node);
+                if (node->identifier.symbol) {
+                        ++resolver->resolved;
+                } else {
+                        ++resolver->unresolved;
+                }
+
+                return false;
+        }
+
+        // the keyword names a parameter of whatever is called
+        case AstNodeType::KWARG: {
+                resolve_list(resolver, node->kwarg.expression);
+
+                return false;
+        }
+
+        // the scopes are entered the same way type_parse_tree enters them
+        case AstNodeType::FUNCTION_DEF: {
+                ResolveScope *outer = resolve_scope_at(
+                        resolver, resolve_scope_count(resolver) - 1);
+                SymbolTableEntry *function_symbol =
+                        resolver->symbol_table->lookup(
+                                node->function_def.name->token.value,
+                                outer->entry);
+
+                resolve_list(resolver, node->function_def.decarators);
+                resolve_list(resolver, node->function_def.return_type);
+
+                resolve_push_scope(resolver, function_symbol,
+                                   ResolveScopeKind::FUNCTION,
+                                   node->function_def.block);
+                resolve_list(resolver, node->function_def.arguments);
+                resolve_list(resolver, node->function_def.block);
+                resolve_pop_scope(resolver);
+
+                return false;
+        }
+
+        case AstNodeType::CLASS_DEF: {
+                ResolveScope *outer = resolve_scope_at(
+                        resolver, resolve_scope_count(resolver) - 1);
+                SymbolTableEntry *class_symbol = resolver->symbol_table->lookup(
+                        node->class_def.name->token.value, outer->entry);
+
+                resolve_list(resolver, node->class_def.decarators);
+
+                resolve_push_scope(resolver, class_symbol,
+                                   ResolveScopeKind::CLASS,
+                                   node->class_def.block);
+                resolve_list(resolver, node->class_def.arguments);
+                resolve_list(resolver, node->class_def.block);
+                resolve_pop_scope(resolver);
+
+                return false;
+        }
+
+        default:
+                return true;
+        }
+}
+
+static void resolve_list(NameResolver *resolver, AstNode *head)
+{
+        for (AstNode *node = head; node; node = node->adjacent_child) {
+                ast_visit(node, resolver->stack, resolve_visit, resolver);
+        }
+}
+
+// Resolves root and everything below it against the scopes on scope_stack,
+// innermost last as type_parse_tree is called with. Returns how many
+// identifiers were bound, the others are left for typing to report
+static uint64_t resolve_names(AstNode *root, Arena *scope_stack, Arena *stack,
+                              SymbolTable *symbol_table)
+{
+        uint32_t base_scope_count =
+                scope_stack->offset / sizeof(SymbolTableEntry *);
+        if (!root || !base_scope_count) {
+                return 0;
+        }
+
+        NameResolver resolver = {};
+        resolver.symbol_table = symbol_table;
+        resolver.stack = stack;
+        resolver.scopes = Arena::init(MEGABYTES(1));
+        resolver.declarations = Arena::init(MEGABYTES(1));
+        resolver.chain = Arena::init(MEGABYTES(1));
+        resolver.global_scope = base_scope_count - 1;
+
+        SymbolTableEntry **base_scopes = (SymbolTableEntry **)scope_stack->memory;
+        for (uint32_t i = 0; i < base_scope_count; ++i) {
+                ResolveScope *scope =
+                        (ResolveScope *)resolver.scopes.alloc(sizeof(*scope));
+                scope->entry = base_scopes[i];
+                scope->kind = ResolveScopeKind::MODULE;
+                scope->first_declaration = 0;
+                scope->declaration_count = 0;
+        }
+
+        resolve_list(&resolver, root);
+
+        resolver.chain.destroy();
+        resolver.declarations.destroy();
+        resolver.scopes.destroy();
+
+        return resolver.resolved;
+}
@@ -0,0 +1,55 @@
+#ifndef RESOLVE_H_
+#define RESOLVE_H_
+
+#include <stdint.h>
+
+#include "utils.h"
+#include "parser.h"
+#include "tables.h"
+#include "traversal.h"
+
+enum class ResolveScopeKind {
+        MODULE,
+        FUNCTION,
+        CLASS,
+};
+
+struct ResolveScope {
+        SymbolTableEntry *entry;
+        ResolveScopeKind kind;
+        // this scope's global and nonlocal names in NameResolver::declarations
+        uint32_t first_declaration;
+        uint32_t declaration_count;
+};
+
+struct ResolveDeclaration {
+        // one of the names listed by the statement
+        AstNode *name;
+        // otherwise declared global
+        bool nonlocal;
+};
+
+// Binds every identifier to its symbol once, before typing, so typing an
+// identifier reads node->identifier.symbol instead of probing the symbol
+// table for each scope on the stack. Names follow Python's LEGB order: the
+// local scope, the enclosing functions but not enclosing classes, then the
+// scopes typing starts with, the innermost of which is the module's globals
+struct NameResolver {
+        SymbolTable *symbol_table;
+        // used by ast_visit
+        Arena *stack;
+        // arrays of ResolveScope and ResolveDeclaration used as stacks
+        Arena scopes;
+        Arena declarations;
+        // the scopes searched for one name, innermost last
+        Arena chain;
+        // the innermost of the scopes the resolver was started with
+        uint32_t global_scope;
+        uint64_t resolved;
+        uint64_t unresolved;
+};
+
+static uint64_t resolve_names(AstNode *root, Arena *scope_stack,
+                              Arena *stack, SymbolTable *symbol_table);
+
+#endif // RESOLVE_H_
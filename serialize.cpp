@@ -0,0 +1,846 @@
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "serialize.h"
+#include "parser.h"
+#include "typing.h"
+#include "tables.h"
+#include "debug.h"
+
+// the generated structs and enums of the headers and the hand serialized
+// Token, AstNode and TypeInfo they mark schema
+#define SERIALIZED_SCHEMA_HASH \
+        (PARSER_H_SCHEMA_HASH ^ (TYPING_H_SCHEMA_HASH * 1099511628211ull) ^ \
+         (TOKENISER_H_SCHEMA_HASH * 1099511628211ull * 1099511628211ull))
+
+PointerIndex PointerIndex::init(uint64_t capacity)
+{
+        PointerIndex index = {};
+
+        index.capacity = 16;
+        index.shift = 60;
+        while (index.capacity < capacity) {
+                index.capacity <<= 1;
+                --index.shift;
+        }
+
+        index.arena = Arena::init(index.capacity *
+                                  (sizeof(void *) + sizeof(uint32_t)));
+        index.keys = (void **)index.arena.alloc(index.capacity * sizeof(void *));
+        index.values =
+                (uint32_t *)index.arena.alloc(index.capacity * sizeof(uint32_t));
+        memset(index.keys, 0, index.capacity * sizeof(void *));
+
+        return index;
+}
+
+static inline uint64_t pointer_index_slot(PointerIndex *index, void *key)
+{
+        // fibonacci hashing, the low bits of a pointer are mostly alignment
+        return ((uint64_t)key * 11400714819323198485ull) >> index->shift;
+}
+
+uint32_t PointerIndex::find(void *key)
+{
+        uint64_t mask = this->capacity - 1;
+        for (uint64_t slot = pointer_index_slot(this, key);;
+             slot = (slot + 1) & mask) {
+                if (this->keys[slot] == key)
+                        return this->values[slot];
+                if (!this->keys[slot])
+                        return 0;
+        }
+}
+
+void PointerIndex::insert(void *key, uint32_t value)
+{
+        // kept at most half full so probes stay short
+        if ((this->count + 1) * 2 > this->capacity) {
+                PointerIndex grown = PointerIndex::init(this->capacity * 2);
+                for (uint64_t i = 0; i < this->capacity; ++i) {
+                        if (this->keys[i])
+                                grown.insert(this->keys[i], this->values[i]);
+                }
+
+                this->destroy();
+                *this = grown;
+        }
+
+        uint64_t mask = this->capacity - 1;
+        uint64_t slot = pointer_index_slot(this, key);
+        while (this->keys[slot] && this->keys[slot] != key) {
+                slot = (slot + 1) & mask;
+        }
+
+        if (!this->keys[slot])
+                ++this->count;
+
+        this->keys[slot] = key;
+        this->values[slot] = value;
+}
+
+void PointerIndex::destroy()
+{
+        this->arena.destroy();
+}
+
+static inline void serializer_write(Serializer *serializer, const void *data,
+                                    size_t size)
+{
+        memcpy(serializer->out->alloc(size), data, size);
+}
+
+static void serialize_uint8_t(Serializer *serializer, uint8_t *value)
+{
+        serializer_write(serializer, value, sizeof(*value));
+}
+
+static void serialize_uint32_t(Serializer *serializer, uint32_t *value)
+{
+        serializer_write(serializer, value, sizeof(*value));
+}
+
+static void serialize_int(Serializer *serializer, int *value)
+{
+        int32_t raw = *value;
+        serializer_write(serializer, &raw, sizeof(raw));
+}
+
+static void serialize_bool(Serializer *serializer, bool *value)
+{
+        uint8_t raw = *value;
+        serializer_write(serializer, &raw, sizeof(raw));
+}
+
+static void serialize_string(Serializer *serializer, std::string *value)
+{
+        uint32_t length = (uint32_t)value->length();
+        serialize_uint32_t(serializer, &length);
+        serializer_write(serializer, value->data(), length);
+}
+
+// gives pointer the next index of its kind the first time it's reached
+static inline uint32_t serializer_index_of(Arena *pointers,
+                                           PointerIndex *indices, void *pointer)
+{
+        if (!pointer) {
+                return 0;
+        }
+
+        uint32_t index = indices->find(pointer);
+        if (index) {
+                return index;
+        }
+
+        *(void **)pointers->alloc(sizeof(void *)) = pointer;
+        index = (uint32_t)(pointers->offset / sizeof(void *));
+        indices->insert(pointer, index);
+
+        return index;
+}
+
+static void serialize_AstNode_PTR(Serializer *serializer, AstNode **value)
+{
+        uint32_t index = serializer_index_of(&serializer->nodes,
+                                             &serializer->node_indices, *value);
+        serialize_uint32_t(serializer, &index);
+}
+
+static void serialize_TypeInfo_PTR(Serializer *serializer, TypeInfo **value)
+{
+        TypeInfo *type = *value;
+        uint32_t index = 0;
+
+        if (type) {
+                // most types point at the static type of a child node, those
+                // stay pointing into the node instead of becoming a copy
+                AstNode *owner = (AstNode *)((char *)type -
+                                             (uint64_t)&((AstNode *)0)->static_type);
+                index = serializer->node_indices.find(owner);
+
+                if (index) {
+                        index |= SERIALIZED_NODE_TYPE;
+                } else {
+                        index = serializer_index_of(&serializer->types,
+                                                    &serializer->type_indices,
+                                                    type);
+                }
+        }
+
+        serialize_uint32_t(serializer, &index);
+}
+
+static void serialize_SymbolTableEntry_PTR(Serializer *serializer,
+                                           SymbolTableEntry **value)
+{
+        uint32_t index = serializer_index_of(&serializer->symbols,
+                                             &serializer->symbol_indices,
+                                             *value);
+        serialize_uint32_t(serializer, &index);
+}
+
+static void serialize_token(Serializer *serializer, Token *token)
+{
+        uint8_t type = (uint8_t)token->type;
+        serialize_uint8_t(serializer, &type);
+        serialize_uint32_t(serializer, &token->line);
+        serialize_uint32_t(serializer, &token->column);
+        serialize_uint32_t(serializer, &token->indent_level);
+        serialize_string(serializer, &token->value);
+}
+
+static void serialize_type_info(Serializer *serializer, TypeInfo *type)
+{
+        serialize_TypeInfoType(serializer, &type->type);
+        serialize_TypeInfoType_payload(serializer, type->type, &type->list);
+        serialize_TypeInfo_PTR(serializer, &type->next);
+}
+
+// stands in for a default in an interface, only whether a parameter has one
+// is looked at
+static AstNode interface_default;
+
+static void serialize_node(Serializer *serializer, AstNode *node)
+{
+        // written without the parts an importer never looks at, whatever
+        // only they reach is never given an index
+        AstNode interface_node;
+        if (serializer->interface_only) {
+                interface_node = *node;
+                node = &interface_node;
+
+                switch (node->type) {
+                case AstNodeType::FUNCTION_DEF:
+                        node->function_def.block = nullptr;
+                        break;
+                case AstNodeType::CLASS_DEF:
+                        node->class_def.block = nullptr;
+                        break;
+                case AstNodeType::DECLARATION:
+                        if (node->declaration.expression) {
+                                node->declaration.expression =
+                                        &interface_default;
+                        }
+                        break;
+                case AstNodeType::ASSIGNMENT:
+                        node->assignment.expression = nullptr;
+                        break;
+                default:
+                        break;
+                }
+        }
+
+        serialize_token(serializer, &node->token);
+        serialize_AstNodeType(serializer, &node->type);
+        serialize_AstNodeType_payload(serializer, node->type, &node->nary);
+        serialize_AstNode_PTR(serializer, &node->adjacent_child);
+
+        // last so the children it may point into already have an index
+        serialize_type_info(serializer, &node->static_type);
+}
+
+// Symbols are written as their name and scope and found again by name when
+// read, their values belong to whoever owns the symbol table
+static void serialize_symbol(Serializer *serializer, SymbolTableEntry *entry)
+{
+        std::string identifier = entry->key.identifier;
+        serialize_string(serializer, &identifier);
+        serialize_SymbolTableEntry_PTR(serializer, &entry->key.scope);
+}
+
+static inline uint32_t serializer_pointer_count(Arena *pointers)
+{
+        return (uint32_t)(pointers->offset / sizeof(void *));
+}
+
+static inline void *serializer_pointer(Arena *pointers, uint32_t i)
+{
+        return ((void **)pointers->memory)[i];
+}
+
+static void serializer_init(Serializer *serializer)
+{
+        *serializer = {};
+        serializer->node_section = Arena::init(GIGABYTES(1));
+        serializer->type_section = Arena::init(GIGABYTES(1));
+        serializer->symbol_section = Arena::init(MEGABYTES(256));
+        serializer->nodes = Arena::init(GIGABYTES(1));
+        serializer->types = Arena::init(GIGABYTES(1));
+        serializer->symbols = Arena::init(MEGABYTES(256));
+        serializer->node_indices = PointerIndex::init(1024);
+        serializer->type_indices = PointerIndex::init(1024);
+        serializer->symbol_indices = PointerIndex::init(64);
+}
+
+// Writes every node, type and symbol that has been given an index so far and
+// everything they reach
+static void serializer_write_reached(Serializer *serializer)
+{
+        // nodes reach types and symbols, types reach symbols, symbols only
+        // reach their scopes so each kind is done once the loop ends
+        serializer->out = &serializer->node_section;
+        for (uint32_t i = 0; i < serializer_pointer_count(&serializer->nodes);
+             ++i) {
+                serialize_node(serializer,
+                               (AstNode *)serializer_pointer(&serializer->nodes, i));
+        }
+
+        serializer->out = &serializer->type_section;
+        for (uint32_t i = 0; i < serializer_pointer_count(&serializer->types);
+             ++i) {
+                serialize_type_info(serializer, (TypeInfo *)serializer_pointer(
+                                                        &serializer->types, i));
+        }
+
+        serializer->out = &serializer->symbol_section;
+        for (uint32_t i = 0; i < serializer_pointer_count(&serializer->symbols);
+             ++i) {
+                serialize_symbol(serializer,
+                                 (SymbolTableEntry *)serializer_pointer(
+                                         &serializer->symbols, i));
+        }
+}
+
+static void serializer_fill_header(Serializer *serializer,
+                                   SerializedHeader *header)
+{
+        header->magic = SERIALIZED_MAGIC;
+        header->version = SERIALIZED_FORMAT_VERSION;
+        header->schema_hash = SERIALIZED_SCHEMA_HASH;
+        header->node_count = serializer_pointer_count(&serializer->nodes);
+        header->type_count = serializer_pointer_count(&serializer->types);
+        header->symbol_count = serializer_pointer_count(&serializer->symbols);
+        header->symbol_section_size = (uint32_t)serializer->symbol_section.offset;
+        header->type_section_size = (uint32_t)serializer->type_section.offset;
+        header->node_section_size = (uint32_t)serializer->node_section.offset;
+}
+
+static inline char *serializer_copy_section(char *data, Arena *section)
+{
+        memcpy(data, section->memory, section->offset);
+        return data + section->offset;
+}
+
+static void serializer_destroy(Serializer *serializer)
+{
+        serializer->symbol_indices.destroy();
+        serializer->type_indices.destroy();
+        serializer->node_indices.destroy();
+        serializer->symbols.destroy();
+        serializer->types.destroy();
+        serializer->nodes.destroy();
+        serializer->symbol_section.destroy();
+        serializer->type_section.destroy();
+        serializer->node_section.destroy();
+}
+
+// Writes root, everything reachable from it and the types and symbols those
+// refer to, returns the number of bytes appended to out
+static uint64_t serialize_tree(AstNode *root, Arena *out)
+{
+        Serializer serializer;
+        serializer_init(&serializer);
+
+        serializer_index_of(&serializer.nodes, &serializer.node_indices, root);
+        serializer_write_reached(&serializer);
+
+        SerializedHeader header = {};
+        serializer_fill_header(&serializer, &header);
+
+        uint64_t size = sizeof(header) + serializer.symbol_section.offset +
+                        serializer.type_section.offset +
+                        serializer.node_section.offset;
+        char *data = (char *)out->alloc(size);
+
+        memcpy(data, &header, sizeof(header));
+        data += sizeof(header);
+        data = serializer_copy_section(data, &serializer.symbol_section);
+        data = serializer_copy_section(data, &serializer.type_section);
+        serializer_copy_section(data, &serializer.node_section);
+
+        serializer_destroy(&serializer);
+
+        return size;
+}
+
+// a scope before the symbols it declares
+static void serializer_index_scope(Serializer *serializer,
+                                   SymbolTable *symbol_table,
+                                   SymbolTableEntry *scope)
+{
+        serializer_index_of(&serializer->symbols, &serializer->symbol_indices,
+                            scope);
+
+        ScopeSymbols *symbols = symbol_table->scope_symbols(scope);
+        if (!symbols) {
+                return;
+        }
+
+        for (SymbolTableEntry *entry = symbols->first; entry;
+             entry = entry->next_in_scope) {
+                AstNode *node = entry->value.node;
+                if (serializer->interface_only &&
+                    (!node || node->type != AstNodeType::CLASS_DEF)) {
+                        serializer_index_of(&serializer->symbols,
+                                            &serializer->symbol_indices, entry);
+                        continue;
+                }
+
+                serializer_index_scope(serializer, symbol_table, entry);
+        }
+}
+
+// destroys the serializer once the scopes are appended to out
+static uint64_t serializer_write_scopes(Serializer *serializer,
+                                        SymbolTable *symbol_table,
+                                        SymbolTableEntry **scopes,
+                                        uint32_t scope_count,
+                                        uint64_t source_hash, Arena *out)
+{
+        for (uint32_t i = 0; i < scope_count; ++i) {
+                assert(!scopes[i]->key.scope);
+                serializer_index_scope(serializer, symbol_table, scopes[i]);
+        }
+
+        uint32_t declared_count = serializer_pointer_count(&serializer->symbols);
+        Arena declaration_section = Arena::init(MEGABYTES(256));
+
+        serializer->out = &declaration_section;
+        for (uint32_t i = 0; i < declared_count; ++i) {
+                SymbolTableEntry *entry = (SymbolTableEntry *)serializer_pointer(
+                        &serializer->symbols, i);
+
+                // the node first so a type pointing into it isn't copied
+                serialize_AstNode_PTR(serializer, &entry->value.node);
+                serialize_type_info(serializer, &entry->value.static_type);
+        }
+
+        serializer_write_reached(serializer);
+
+        SerializedScopesHeader header = {};
+        serializer_fill_header(serializer, &header.tree);
+        header.tree.magic = SERIALIZED_SCOPES_MAGIC;
+        header.declared_count = declared_count;
+        header.declaration_section_size = (uint32_t)declaration_section.offset;
+        header.source_hash = source_hash;
+
+        uint64_t size = sizeof(header) + serializer->symbol_section.offset +
+                        declaration_section.offset +
+                        serializer->type_section.offset +
+                        serializer->node_section.offset;
+        char *data = (char *)out->alloc(size);
+
+        memcpy(data, &header, sizeof(header));
+        data += sizeof(header);
+        data = serializer_copy_section(data, &serializer->symbol_section);
+        data = serializer_copy_section(data, &declaration_section);
+        data = serializer_copy_section(data, &serializer->type_section);
+        serializer_copy_section(data, &serializer->node_section);
+
+        declaration_section.destroy();
+        serializer_destroy(serializer);
+
+        return size;
+}
+
+// Writes the top level scopes, every symbol declared in them and their values
+// along with the nodes and types those reach. The declared symbols are the
+// first ones numbered, parents before what they declare, and their values
+// are a section of their own after the symbol records. source_hash is kept
+// in the header for serialized_scopes_source_hash
+static uint64_t serialize_scopes(SymbolTable *symbol_table,
+                                 SymbolTableEntry **scopes,
+                                 uint32_t scope_count, uint64_t source_hash,
+                                 Arena *out)
+{
+        Serializer serializer;
+        serializer_init(&serializer);
+
+        return serializer_write_scopes(&serializer, symbol_table, scopes,
+                                       scope_count, source_hash, out);
+}
+
+// What importing the module declared in the top level scope needs, its
+// symbols and those of its classes with the signatures but not the bodies
+// of what they declare. Read back with deserialize_scopes
+static uint64_t serialize_summary(SymbolTable *symbol_table,
+                                  SymbolTableEntry *scope, Arena *out)
+{
+        Serializer serializer;
+        serializer_init(&serializer);
+        serializer.interface_only = true;
+
+        return serializer_write_scopes(&serializer, symbol_table, &scope, 1,
+                                       0, out);
+}
+
+static inline void deserializer_read(Deserializer *deserializer, void *data,
+                                     size_t size)
+{
+        if (deserializer->failed ||
+            (size_t)(deserializer->end - deserializer->at) < size) {
+                deserializer->failed = true;
+                memset(data, 0, size);
+                return;
+        }
+
+        memcpy(data, deserializer->at, size);
+        deserializer->at += size;
+}
+
+static void deserialize_uint8_t(Deserializer *deserializer, uint8_t *value)
+{
+        deserializer_read(deserializer, value, sizeof(*value));
+}
+
+static void deserialize_uint32_t(Deserializer *deserializer, uint32_t *value)
+{
+        deserializer_read(deserializer, value, sizeof(*value));
+}
+
+static void deserialize_int(Deserializer *deserializer, int *value)
+{
+        int32_t raw = 0;
+        deserializer_read(deserializer, &raw, sizeof(raw));
+        *value = raw;
+}
+
+static void deserialize_bool(Deserializer *deserializer, bool *value)
+{
+        uint8_t raw = 0;
+        deserializer_read(deserializer, &raw, sizeof(raw));
+        *value = raw != 0;
+}
+
+static void deserialize_string(Deserializer *deserializer, std::string *value)
+{
+        uint32_t length = 0;
+        deserialize_uint32_t(deserializer, &length);
+
+        if (deserializer->failed ||
+            (size_t)(deserializer->end - deserializer->at) < length) {
+                deserializer->failed = true;
+                value->clear();
+                return;
+        }
+
+        value->assign(deserializer->at, length);
+        deserializer->at += length;
+}
+
+static void deserialize_AstNode_PTR(Deserializer *deserializer, AstNode **value)
+{
+        uint32_t index = 0;
+        deserialize_uint32_t(deserializer, &index);
+
+        if (index > deserializer->node_count) {
+                deserializer->failed = true;
+                index = 0;
+        }
+
+        *value = index ? &deserializer->nodes[index - 1] : nullptr;
+}
+
+static void deserialize_TypeInfo_PTR(Deserializer *deserializer,
+                                     TypeInfo **value)
+{
+        uint32_t index = 0;
+        deserialize_uint32_t(deserializer, &index);
+
+        if (index & SERIALIZED_NODE_TYPE) {
+                index &= ~SERIALIZED_NODE_TYPE;
+                if (!index || index > deserializer->node_count) {
+                        deserializer->failed = true;
+                        *value = nullptr;
+                        return;
+                }
+
+                *value = &deserializer->nodes[index - 1].static_type;
+                return;
+        }
+
+        if (index > deserializer->type_count) {
+                deserializer->failed = true;
+                index = 0;
+        }
+
+        *value = index ? &deserializer->types[index - 1] : nullptr;
+}
+
+static void deserialize_SymbolTableEntry_PTR(Deserializer *deserializer,
+                                             SymbolTableEntry **value)
+{
+        uint32_t index = 0;
+        deserialize_uint32_t(deserializer, &index);
+
+        if (index > deserializer->symbol_count) {
+                deserializer->failed = true;
+                index = 0;
+        }
+
+        *value = index ? deserializer->symbols[index - 1] : nullptr;
+}
+
+static void deserialize_token(Deserializer *deserializer, Token *token)
+{
+        uint8_t type = 0;
+        deserialize_uint8_t(deserializer, &type);
+        if (type >= array_count(TOKEN_STRINGS))
+                deserializer->failed = true;
+
+        token->type = (TokenType)type;
+        deserialize_uint32_t(deserializer, &token->line);
+        deserialize_uint32_t(deserializer, &token->column);
+        deserialize_uint32_t(deserializer, &token->indent_level);
+        deserialize_string(deserializer, &token->value);
+}
+
+static void deserialize_type_info(Deserializer *deserializer, TypeInfo *type)
+{
+        deserialize_TypeInfoType(deserializer, &type->type);
+        deserialize_TypeInfoType_payload(deserializer, type->type, &type->list);
+        deserialize_TypeInfo_PTR(deserializer, &type->next);
+}
+
+static void deserialize_node(Deserializer *deserializer, AstNode *node)
+{
+        deserialize_token(deserializer, &node->token);
+        deserialize_AstNodeType(deserializer, &node->type);
+        deserialize_AstNodeType_payload(deserializer, node->type, &node->nary);
+        deserialize_AstNode_PTR(deserializer, &node->adjacent_child);
+        deserialize_type_info(deserializer, &node->static_type);
+}
+
+static bool serialized_header_is_valid(SerializedHeader *header,
+                                       uint32_t magic, uint64_t extra_size,
+                                       uint64_t size)
+{
+        return header->magic == magic &&
+               header->version == SERIALIZED_FORMAT_VERSION &&
+               header->schema_hash == SERIALIZED_SCHEMA_HASH &&
+               (uint64_t)header->symbol_section_size + header->type_section_size +
+                               header->node_section_size + extra_size ==
+                       size;
+}
+
+// the records are read into these once every index can be turned into a
+// pointer
+static void deserializer_alloc(Deserializer *deserializer,
+                               SerializedHeader *header, Arena *ast_arena)
+{
+        deserializer->node_count = header->node_count;
+        deserializer->type_count = header->type_count;
+        deserializer->symbol_count = header->symbol_count;
+
+        deserializer->nodes =
+                (AstNode *)ast_arena->alloc(header->node_count * sizeof(AstNode));
+        for (uint32_t i = 0; i < header->node_count; ++i) {
+                new (&deserializer->nodes[i]) AstNode();
+        }
+
+        deserializer->types =
+                (TypeInfo *)ast_arena->alloc(header->type_count * sizeof(TypeInfo));
+        for (uint32_t i = 0; i < header->type_count; ++i) {
+                new (&deserializer->types[i]) TypeInfo();
+        }
+
+        deserializer->symbols = (SymbolTableEntry **)ast_arena->alloc(
+                header->symbol_count * sizeof(SymbolTableEntry *));
+}
+
+// the symbols that are looked up rather than declared, from the back as a
+// symbol's scope is always reached after it
+static void deserializer_lookup_symbols(Deserializer *deserializer,
+                                        SymbolTable *symbol_table,
+                                        std::string *identifiers,
+                                        uint32_t *scopes, uint32_t first)
+{
+        for (uint32_t i = deserializer->symbol_count;
+             !deserializer->failed && i > first; --i) {
+                SymbolTableEntry *scope =
+                        scopes[i - 1] ? deserializer->symbols[scopes[i - 1] - 1]
+                                      : nullptr;
+                deserializer->symbols[i - 1] =
+                        symbol_table ? symbol_table->lookup(identifiers[i - 1],
+                                                            scope)
+                                     : nullptr;
+        }
+}
+
+// expects at to be the start of the type section
+static void deserializer_read_types_and_nodes(Deserializer *deserializer,
+                                              SerializedHeader *header)
+{
+        deserializer->end = deserializer->at + header->type_section_size;
+        for (uint32_t i = 0; i < header->type_count; ++i) {
+                deserialize_type_info(deserializer, &deserializer->types[i]);
+        }
+
+        if (deserializer->at != deserializer->end) {
+                deserializer->failed = true;
+        }
+
+        deserializer->end += header->node_section_size;
+        for (uint32_t i = 0; i < header->node_count; ++i) {
+                deserialize_node(deserializer, &deserializer->nodes[i]);
+        }
+
+        if (deserializer->at != deserializer->end) {
+                deserializer->failed = true;
+        }
+}
+
+// Rebuilds a tree written by serialize_tree in ast_arena, the nodes end up
+// contiguous in the order they were written. Symbols are looked up in
+// symbol_table when one is given and are null otherwise. Returns nullptr
+// for data written with a different schema or that is malformed
+static AstNode *deserialize_tree(const void *data, uint64_t size,
+                                 Arena *ast_arena, SymbolTable *symbol_table)
+{
+        SerializedHeader header = {};
+        if (size < sizeof(header)) {
+                return nullptr;
+        }
+
+        memcpy(&header, data, sizeof(header));
+        if (!serialized_header_is_valid(&header, SERIALIZED_MAGIC, 0,
+                                        size - sizeof(header)) ||
+            !header.node_count) {
+                return nullptr;
+        }
+
+        Deserializer deserializer = {};
+        deserializer_alloc(&deserializer, &header, ast_arena);
+
+        const char *at = (const char *)data + sizeof(header);
+
+        uint32_t *scopes = (uint32_t *)ast_arena->alloc(header.symbol_count *
+                                                        sizeof(uint32_t));
+        std::string *identifiers = new std::string[header.symbol_count];
+
+        deserializer.at = at;
+        deserializer.end = at + header.symbol_section_size;
+        for (uint32_t i = 0; i < header.symbol_count; ++i) {
+                deserialize_string(&deserializer, &identifiers[i]);
+                deserialize_uint32_t(&deserializer, &scopes[i]);
+
+                if (scopes[i] && (scopes[i] <= i + 1 ||
+                                  scopes[i] > header.symbol_count)) {
+                        deserializer.failed = true;
+                }
+        }
+
+        if (deserializer.at != deserializer.end) {
+                deserializer.failed = true;
+        }
+
+        deserializer_lookup_symbols(&deserializer, symbol_table, identifiers,
+                                    scopes, 0);
+        delete[] identifiers;
+
+        deserializer_read_types_and_nodes(&deserializer, &header);
+        if (deserializer.failed) {
+                return nullptr;
+        }
+
+        return &deserializer.nodes[0];
+}
+
+// what serialize_scopes was given, 0 if data is too short to hold it
+static uint64_t serialized_scopes_source_hash(const void *data, uint64_t size)
+{
+        SerializedScopesHeader header = {};
+        if (size < sizeof(header)) {
+                return 0;
+        }
+
+        memcpy(&header, data, sizeof(header));
+        return header.source_hash;
+}
+
+// Declares what serialize_scopes wrote in symbol_table, entries are allocated
+// in symbol_arena and nodes and types in ast_arena. The symbol records are
+// checked before anything is declared but a file that is malformed past them
+// can leave some symbols declared with empty values, returns false if so or
+// if it was written with a different schema
+static bool deserialize_scopes(const void *data, uint64_t size,
+                               Arena *ast_arena, Arena *symbol_arena,
+                               SymbolTable *symbol_table)
+{
+        SerializedScopesHeader header = {};
+        if (size < sizeof(header)) {
+                return false;
+        }
+
+        memcpy(&header, data, sizeof(header));
+        if (!serialized_header_is_valid(&header.tree, SERIALIZED_SCOPES_MAGIC,
+                                        header.declaration_section_size,
+                                        size - sizeof(header)) ||
+            header.declared_count > header.tree.symbol_count) {
+                return false;
+        }
+
+        Deserializer deserializer = {};
+        deserializer_alloc(&deserializer, &header.tree, ast_arena);
+
+        const char *at = (const char *)data + sizeof(header);
+        uint32_t symbol_count = header.tree.symbol_count;
+        uint32_t declared_count = header.declared_count;
+
+        uint32_t *scopes =
+                (uint32_t *)ast_arena->alloc(symbol_count * sizeof(uint32_t));
+        std::string *identifiers = new std::string[symbol_count];
+
+        deserializer.at = at;
+        deserializer.end = at + header.tree.symbol_section_size;
+        for (uint32_t i = 0; i < symbol_count; ++i) {
+                deserialize_string(&deserializer, &identifiers[i]);
+                deserialize_uint32_t(&deserializer, &scopes[i]);
+
+                // declared symbols come after their scope, the rest are
+                // in scopes that are declared or reached after them
+                bool valid_scope =
+                        i < declared_count ?
+                                scopes[i] <= i :
+                                scopes[i] <= declared_count ||
+                                        (scopes[i] > i + 1 &&
+                                         scopes[i] <= symbol_count);
+                if (scopes[i] && !valid_scope) {
+                        deserializer.failed = true;
+                }
+        }
+
+        if (deserializer.at != deserializer.end) {
+                deserializer.failed = true;
+        }
+
+        for (uint32_t i = 0; !deserializer.failed && i < declared_count; ++i) {
+                SymbolTableEntry *scope =
+                        scopes[i] ? deserializer.symbols[scopes[i] - 1] : nullptr;
+                SymbolTableValue value = {};
+                deserializer.symbols[i] = symbol_table->insert(
+                        symbol_arena, identifiers[i], scope, &value);
+        }
+
+        deserializer_lookup_symbols(&deserializer, symbol_table, identifiers,
+                                    scopes, declared_count);
+        delete[] identifiers;
+
+        // every index can be turned into a pointer now so the values are
+        // read straight into the entries
+        deserializer.end += header.declaration_section_size;
+        for (uint32_t i = 0; !deserializer.failed && i < declared_count; ++i) {
+                SymbolTableValue *value = &deserializer.symbols[i]->value;
+                deserialize_AstNode_PTR(&deserializer, &value->node);
+                deserialize_type_info(&deserializer, &value->static_type);
+        }
+
+        if (deserializer.at != deserializer.end) {
+                deserializer.failed = true;
+        }
+
+        deserializer_read_types_and_nodes(&deserializer, &header.tree);
+
+        return !deserializer.failed;
+}
@@ -0,0 +1,136 @@
+#ifndef SERIALIZE_H_
+#define SERIALIZE_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "utils.h"
+
+struct AstNode;
+struct TypeInfo;
+struct SymbolTable;
+struct SymbolTableEntry;
+
+#define SERIALIZED_MAGIC 0x41505954 // "TYPA"
+#define SERIALIZED_SCOPES_MAGIC 0x53505954 // "TYPS"
+// bump when how the hand written parts are written changes, the generated
+// parts and the layout of the structs marked schema are covered by the
+// schema hashes
+#define SERIALIZED_FORMAT_VERSION 2
+// a type pointer with this bit set refers to the static type of a node
+#define SERIALIZED_NODE_TYPE 0x80000000u
+
+// Maps pointers to the index they were given, open addressing on the
+// pointer bits. Indices start at 1 so 0 means missing
+struct PointerIndex {
+        Arena arena;
+        void **keys;
+        uint32_t *values;
+        uint64_t capacity;
+        uint64_t count;
+        uint32_t shift;
+
+        static PointerIndex init(uint64_t capacity);
+        uint32_t find(void *key);
+        void insert(void *key, uint32_t value);
+        void destroy();
+};
+
+// Nodes, types and symbols are numbered in the order they're reached and
+// each kind is written to its own section, records are tightly packed and
+// every pointer is written as the index of what it points to
+struct Serializer {
+        // the section being written
+        Arena *out;
+        Arena node_section;
+        Arena type_section;
+        Arena symbol_section;
+
+        // pointers in index order, the ones past the last written record
+        // are still to be written
+        Arena nodes;
+        Arena types;
+        Arena symbols;
+        PointerIndex node_indices;
+        PointerIndex type_indices;
+        PointerIndex symbol_indices;
+        // only what an importer needs, function and class bodies and the
+        // values declarations are initialised with are left out and only
+        // class scopes are written below the top level
+        bool interface_only;
+};
+
+struct SerializedHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t schema_hash;
+        uint32_t node_count;
+        uint32_t type_count;
+        uint32_t symbol_count;
+        // the sections follow in this order
+        uint32_t symbol_section_size;
+        uint32_t type_section_size;
+        uint32_t node_section_size;
+};
+
+// Written by serialize_scopes, the values of the declared symbols are their
+// own section after the symbol records
+struct SerializedScopesHeader {
+        SerializedHeader tree;
+        uint32_t declared_count;
+        uint32_t declaration_section_size;
+        // of the sources the scopes were checked from, 0 when the writer
+        // doesn't record them
+        uint64_t source_hash;
+};
+
+// Reads never go past end, anything malformed sets failed and reads as 0
+struct Deserializer {
+        const char *at;
+        const char *end;
+        bool failed;
+
+        AstNode *nodes;
+        uint32_t node_count;
+        TypeInfo *types;
+        uint32_t type_count;
+        SymbolTableEntry **symbols;
+        uint32_t symbol_count;
+};
+
+static void serialize_uint8_t(Serializer *serializer, uint8_t *value);
+static void serialize_uint32_t(Serializer *serializer, uint32_t *value);
+static void serialize_int(Serializer *serializer, int *value);
+static void serialize_bool(Serializer *serializer, bool *value);
+static void serialize_string(Serializer *serializer, std::string *value);
+static void serialize_AstNode_PTR(Serializer *serializer, AstNode **value);
+static void serialize_TypeInfo_PTR(Serializer *serializer, TypeInfo **value);
+static void serialize_SymbolTableEntry_PTR(Serializer *serializer,
+                                           SymbolTableEntry **value);
+
+static void deserialize_uint8_t(Deserializer *deserializer, uint8_t *value);
+static void deserialize_uint32_t(Deserializer *deserializer, uint32_t *value);
+static void deserialize_int(Deserializer *deserializer, int *value);
+static void deserialize_bool(Deserializer *deserializer, bool *value);
+static void deserialize_string(Deserializer *deserializer, std::string *value);
+static void deserialize_AstNode_PTR(Deserializer *deserializer, AstNode **value);
+static void deserialize_TypeInfo_PTR(Deserializer *deserializer,
+                                     TypeInfo **value);
+static void deserialize_SymbolTableEntry_PTR(Deserializer *deserializer,
+                                             SymbolTableEntry **value);
+
+static uint64_t serialize_tree(AstNode *root, Arena *out);
+static AstNode *deserialize_tree(const void *data, uint64_t size,
+                                 Arena *ast_arena, SymbolTable *symbol_table);
+static uint64_t serialize_scopes(SymbolTable *symbol_table,
+                                 SymbolTableEntry **scopes,
+                                 uint32_t scope_count, uint64_t source_hash,
+                                 Arena *out);
+static uint64_t serialize_summary(SymbolTable *symbol_table,
+                                  SymbolTableEntry *scope, Arena *out);
+static bool deserialize_scopes(const void *data, uint64_t size,
+                               Arena *ast_arena, Arena *symbol_arena,
+                               SymbolTable *symbol_table);
+static uint64_t serialized_scopes_source_hash(const void *data, uint64_t size);
+
+#endif // SERIALIZE_H_
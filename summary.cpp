@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "summary.h"
+#include "pipeline.h"
+#include "serialize.h"
+#include "diagnostics.h"
+
+// FNV-1a
+static uint64_t summary_hash_bytes(const void *data, uint64_t size)
+{
+        const unsigned char *bytes = (const unsigned char *)data;
+        uint64_t hash = 14695981039346656037ull;
+        for (uint64_t i = 0; i < size; ++i) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+        }
+
+        return hash;
+}
+
+// A module given on the command line isn't when checking incrementally, a
+// recheck needs its tree. Nor is a single file checked in the main scope,
+// nothing can import it
+static bool summary_is_cached(Pipeline *pipeline, Module *module)
+{
+        return pipeline->cache_directory &&
+               module->scope != pipeline->main_scope &&
+               !(pipeline->incremental &&
+                 module->position < pipeline->input_module_count);
+}
+
+// named by the hash of the module's name, the entry holds the name itself
+// to rule out a collision
+static void summary_entry_path(Pipeline *pipeline, Module *module, char *path,
+                               size_t size)
+{
+        uint64_t name_hash =
+                summary_hash_bytes(module->name.data(), module->name.size());
+        snprintf(path, size, "%s\\%016llx" SUMMARY_FILE_EXTENSION,
+                 pipeline->cache_directory, (unsigned long long)name_hash);
+}
+
+// reader is left at the module's name
+static bool summary_entry_open(const char *entry, uint64_t size,
+                               Deserializer *reader, SummaryHeader *header)
+{
+        if (size < sizeof(*header)) {
+                return false;
+        }
+
+        memcpy(header, entry, sizeof(*header));
+        if (header->magic != SUMMARY_MAGIC ||
+            header->version != SUMMARY_FORMAT_VERSION) {
+                return false;
+        }
+
+        *reader = {};
+        reader->at = entry + sizeof(*header);
+        reader->end = entry + size;
+
+        return true;
+}
+
+// Reads the module's cache entry into its arena if there's one for its
+// source and submits the dependencies it records in place of the module's
+// imports. Whether the entry can be used is only known once they're typed
+static bool summary_read_entry(Pipeline *pipeline, Module *module)
+{
+        char path[2048];
+        summary_entry_path(pipeline, module, path, sizeof(path));
+
+        FILE *file = nullptr;
+        fopen_s(&file, path, "rb");
+        if (!file) {
+                return false;
+        }
+
+        fseek(file, 0, SEEK_END);
+        uint64_t size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        // the arena doesn't align so keep what follows on 8 bytes
+        char *entry = (char *)module->arena.alloc((size + 7) & ~7ull);
+        bool read = fread_s(entry, size, 1, size, file) == size;
+        fclose(file);
+
+        SummaryHeader header = {};
+        Deserializer reader;
+        if (!read || !summary_entry_open(entry, size, &reader, &header) ||
+            header.source_hash != module->source_hash) {
+                return false;
+        }
+
+        std::string name;
+        deserialize_string(&reader, &name);
+        if (reader.failed || name != module->name) {
+                return false;
+        }
+
+        // every record is checked before any dependency is submitted
+        const char *dependencies = reader.at;
+        for (uint32_t i = 0; i < header.dependency_count; ++i) {
+                uint64_t summary_hash = 0;
+                deserializer_read(&reader, &summary_hash, sizeof(summary_hash));
+                deserialize_string(&reader, &name);
+        }
+
+        if (reader.failed) {
+                return false;
+        }
+
+        reader.at = dependencies;
+        module->imports = (Module **)module->arena.alloc(
+                header.dependency_count * sizeof(Module *));
+        for (uint32_t i = 0; i < header.dependency_count; ++i) {
+                uint64_t summary_hash = 0;
+                deserializer_read(&reader, &summary_hash, sizeof(summary_hash));
+                deserialize_string(&reader, &name);
+
+                module->imports[module->import_count++] =
+                        pipeline_submit_import_name(pipeline, name);
+        }
+
+        module->cache_entry = entry;
+        module->cache_entry_size = size;
+        module->line_count = header.line_count;
+
+        return true;
+}
+
+// Declares the module's summary and reports the diagnostics it had if what
+// it depends on still has the summaries it was checked against, called in
+// the module's wave once everything it imports is typed or loaded
+static bool summary_load(Pipeline *pipeline, Module *module,
+                         Arena *symbol_table_arena)
+{
+        SummaryHeader header = {};
+        Deserializer reader;
+        summary_entry_open(module->cache_entry, module->cache_entry_size,
+                           &reader, &header);
+
+        std::string name;
+        deserialize_string(&reader, &name);
+
+        for (uint32_t i = 0; i < header.dependency_count; ++i) {
+                uint64_t summary_hash = 0;
+                deserializer_read(&reader, &summary_hash, sizeof(summary_hash));
+                deserialize_string(&reader, &name);
+
+                // loaded modules have no summary and the modules of an
+                // import cycle are typed together, none of them is loaded
+                Module *imported = module->imports[i];
+                bool unchanged =
+                        imported->position == UINT32_MAX ?
+                                summary_hash == 0 :
+                                imported->wave < module->wave &&
+                                        summary_hash &&
+                                        imported->summary_hash == summary_hash;
+                if (!unchanged) {
+                        return false;
+                }
+        }
+
+        // skipped until the summary is declared, a stale entry reports
+        // nothing
+        const char *diagnostics = reader.at;
+        for (uint32_t i = 0; i < header.diagnostic_count; ++i) {
+                uint32_t position = 0;
+                deserialize_uint32_t(&reader, &position);
+                deserialize_uint32_t(&reader, &position);
+                deserialize_string(&reader, &name);
+        }
+
+        if (reader.failed ||
+            (uint64_t)(reader.end - reader.at) != header.summary_size) {
+                return false;
+        }
+
+        module->summary_arena = Arena::init(MEGABYTES(256));
+        if (!deserialize_scopes(reader.at, header.summary_size,
+                                &module->summary_arena, symbol_table_arena,
+                                pipeline->tables->symbol_table)) {
+                module->summary_arena.destroy();
+                module->summary_arena = {};
+                return false;
+        }
+
+        // the scope's own value was written with the rest
+        module->scope->value.node = pipeline->module_node;
+        module->summary_hash = header.summary_hash;
+
+        // a module that would be typed on demand isn't checked
+        bool lazy = pipeline->lazy &&
+                    module->position >= pipeline->input_module_count;
+        uint32_t diagnostic_count = lazy ? 0 : header.diagnostic_count;
+
+        reader.at = diagnostics;
+        std::string message;
+        for (uint32_t i = 0; i < diagnostic_count; ++i) {
+                uint32_t line = 0;
+                uint32_t column = 0;
+                deserialize_uint32_t(&reader, &line);
+                deserialize_uint32_t(&reader, &column);
+                deserialize_string(&reader, &message);
+
+                pipeline->tables->diagnostics->report(module->filename, line,
+                                                      column, message.c_str());
+        }
+
+        InterlockedIncrement(&pipeline->summaries_loaded);
+
+        return true;
+}
+
+// once the module's top level is typed, what modules importing it see can't
+// change after that
+static void summary_extract(Pipeline *pipeline, Module *module)
+{
+        module->summary = Arena::init(MEGABYTES(256));
+        uint64_t size = serialize_summary(pipeline->tables->symbol_table,
+                                          module->scope, &module->summary);
+        module->summary_hash = summary_hash_bytes(module->summary.memory, size);
+}
+
+// Points the module's symbols at a copy of its summary so its arena can be
+// released once its bodies are checked, called before anything importing
+// the module is typed. The symbols are declared again in place so whatever
+// was bound to them stays bound
+static void summary_declare(Pipeline *pipeline, Module *module,
+                            Arena *symbol_table_arena)
+{
+        module->summary_arena = Arena::init(MEGABYTES(256));
+        bool declared = deserialize_scopes(
+                module->summary.memory, module->summary.offset,
+                &module->summary_arena, symbol_table_arena,
+                pipeline->tables->symbol_table);
+        assert(declared);
+
+        module->scope->value.node = pipeline->module_node;
+
+        // only kept to be written to the cache
+        if (!summary_is_cached(pipeline, module)) {
+                module->summary.destroy();
+                module->summary = {};
+        }
+}
+
+// Writes a cache entry for every module whose summary was extracted, call
+// once the pipeline has run so the diagnostics are complete. An entry that
+// could never be used, because it depends on a module without a summary,
+// isn't written. Returns the number written
+static uint32_t pipeline_write_summaries(Pipeline *pipeline)
+{
+        if (!pipeline->cache_directory) {
+                return 0;
+        }
+
+        Arena entry = Arena::init(GIGABYTES(1));
+        Serializer writer = {};
+        writer.out = &entry;
+
+        Diagnostics *diagnostics = pipeline->tables->diagnostics;
+        Diagnostic *list = (Diagnostic *)diagnostics->entries.memory;
+        uint32_t written = 0;
+
+        for (uint32_t i = 0; i < pipeline->module_count; ++i) {
+                Module *module = pipeline->modules[i];
+                if (!module->summary.offset)
+                        continue;
+
+                bool usable = true;
+                for (uint32_t j = 0; j < module->import_count; ++j) {
+                        Module *imported = module->imports[j];
+                        if (imported->position != UINT32_MAX &&
+                            (!imported->summary_hash ||
+                             imported->wave >= module->wave))
+                                usable = false;
+                }
+
+                if (!usable)
+                        continue;
+
+                entry.offset = 0;
+                SummaryHeader *header =
+                        (SummaryHeader *)entry.alloc(sizeof(SummaryHeader));
+                *header = {};
+                header->magic = SUMMARY_MAGIC;
+                header->version = SUMMARY_FORMAT_VERSION;
+                header->source_hash = module->source_hash;
+                header->summary_hash = module->summary_hash;
+                header->line_count = module->line_count;
+                header->dependency_count = module->import_count;
+                header->summary_size = (uint32_t)module->summary.offset;
+
+                serialize_string(&writer, &module->name);
+                for (uint32_t j = 0; j < module->import_count; ++j) {
+                        Module *imported = module->imports[j];
+                        serializer_write(&writer, &imported->summary_hash,
+                                         sizeof(imported->summary_hash));
+                        serialize_string(&writer, &imported->name);
+                }
+
+                for (uint32_t j = 0; j < diagnostics->count; ++j) {
+                        if (list[j].filename != module->filename)
+                                continue;
+
+                        std::string message = list[j].message;
+                        serialize_uint32_t(&writer, &list[j].line);
+                        serialize_uint32_t(&writer, &list[j].column);
+                        serialize_string(&writer, &message);
+                        ++header->diagnostic_count;
+                }
+
+                serializer_write(&writer, module->summary.memory,
+                                 module->summary.offset);
+
+                char path[2048];
+                summary_entry_path(pipeline, module, path, sizeof(path));
+
+                FILE *file = nullptr;
+                fopen_s(&file, path, "wb");
+                if (!file ||
+                    fwrite(entry.memory, 1, entry.offset, file) != entry.offset) {
+                        perror("Couldn't write module summary");
+                        if (file)
+                                fclose(file);
+                        continue;
+                }
+
+                fclose(file);
+                ++written;
+        }
+
+        entry.destroy();
+
+        return written;
+}
@@ -0,0 +1,46 @@
+#ifndef SUMMARY_H_
+#define SUMMARY_H_
+
+#include <stdint.h>
+
+#include "utils.h"
+
+struct Module;
+struct Pipeline;
+struct Tables;
+struct Deserializer;
+
+#define SUMMARY_MAGIC 0x4d505954 // "TYPM"
+// bump when the layout of a cache entry changes, the summary in it carries
+// its own format version and schema hash
+#define SUMMARY_FORMAT_VERSION 1
+#define SUMMARY_FILE_EXTENSION ".tpysum"
+
+// A module's cache entry is this header followed by the module's name, its
+// dependencies as a summary hash then a name, its diagnostics as line,
+// column then message and last the summary written by serialize_summary.
+// An entry is only used while the source hashes the same and so do the
+// summaries of its dependencies
+struct SummaryHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t source_hash;
+        // what modules importing this one record
+        uint64_t summary_hash;
+        uint32_t line_count;
+        uint32_t dependency_count;
+        uint32_t diagnostic_count;
+        uint32_t summary_size;
+};
+
+static uint64_t summary_hash_bytes(const void *data, uint64_t size);
+static bool summary_is_cached(Pipeline *pipeline, Module *module);
+static bool summary_read_entry(Pipeline *pipeline, Module *module);
+static bool summary_load(Pipeline *pipeline, Module *module,
+                         Arena *symbol_table_arena);
+static void summary_extract(Pipeline *pipeline, Module *module);
+static void summary_declare(Pipeline *pipeline, Module *module,
+                            Arena *symbol_table_arena);
+static uint32_t pipeline_write_summaries(Pipeline *pipeline);
+
+#endif // SUMMARY_H_
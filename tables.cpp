@@ -1,87 +1,571 @@
 #include <string>
+#include <string.h>
 #include <assert.h>
 
 #include "tables.h"
 
-// FIXME: I took this hash function of stackoverflow please
-// replace with something that is more secure and robust after more research
-uint32_t SymbolTable::hash(std::string &string, SymbolTableEntry *scope)
+static inline uint32_t atom_hash(const char *chars, uint32_t length)
 {
-        uint32_t hash = 0;
-        for (int i = 0; i < string.length(); ++i) {
-                hash = hash * 101 + string[i];
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (uint32_t i = 0; i < length; ++i) {
+                hash ^= (uint8_t)chars[i];
+                hash *= 16777619u;
         }
 
-        while (scope) {
-                for (int i = 0; i < scope->key.identifier.length(); ++i) {
-                        hash = hash * 101 + scope->key.identifier[i];
+        return hash;
+}
+
+// A writer makes the version odd before it changes what it guards and even
+// again after, the increments are full barriers. A reader copies what it
+// needs between read_begin and read_retry and starts over when they differ
+static inline LONG seqlock_read_begin(volatile LONG *version)
+{
+        for (;;) {
+                LONG begin = *version;
+                if (!(begin & 1)) {
+                        MemoryBarrier();
+                        return begin;
+                }
+
+                YieldProcessor();
+        }
+}
+
+static inline bool seqlock_read_retry(volatile LONG *version, LONG begin)
+{
+        MemoryBarrier();
+        return *version != begin;
+}
+
+AtomTable AtomTable::init()
+{
+        AtomTable table = {};
+        table.capacity = ATOM_TABLE_INITIAL_CAPACITY;
+        table.slot_arena = Arena::init(GIGABYTES(1));
+        table.slots = (AtomSlot *)table.slot_arena.alloc(table.capacity *
+                                                          sizeof(AtomSlot));
+        memset(table.slots, 0, table.capacity * sizeof(AtomSlot));
+        table.atoms = Arena::init(GIGABYTES(1));
+        table.chars = Arena::init(GIGABYTES(1));
+
+        return table;
+}
+
+Atom *AtomTable::get(uint32_t atom)
+{
+        assert(atom && atom <= this->count);
+        return &((Atom *)this->atoms.memory)[atom - 1];
+}
+
+static uint32_t atom_slots_find(AtomTable *table, AtomSlot *slots,
+                                uint64_t capacity, const char *chars,
+                                uint32_t length, uint32_t hash)
+{
+        uint64_t mask = capacity - 1;
+        uint64_t slot = hash & mask;
+
+        // bounded as an intern may be filling the slots while they're probed
+        for (uint64_t probe = 0; probe < capacity;
+             ++probe, slot = (slot + 1) & mask) {
+                AtomSlot atom_slot = slots[slot];
+                if (!atom_slot.atom) {
+                        return 0;
+                }
+
+                if (atom_slot.hash != hash) {
+                        continue;
+                }
+
+                Atom *atom = table->get(atom_slot.atom);
+                if (atom->length == length &&
+                    memcmp(atom->chars, chars, length) == 0) {
+                        return atom_slot.atom;
+                }
+        }
+
+        return 0;
+}
+
+uint32_t AtomTable::find(const char *chars, uint32_t length)
+{
+        uint32_t hash = atom_hash(chars, length);
+
+        for (;;) {
+                LONG version = seqlock_read_begin(&this->version);
+                AtomSlot *slots = this->slots;
+                uint64_t capacity = this->capacity;
+                if (seqlock_read_retry(&this->version, version)) {
+                        continue;
+                }
+
+                uint32_t atom = atom_slots_find(this, slots, capacity, chars,
+                                                length, hash);
+                if (!seqlock_read_retry(&this->version, version)) {
+                        return atom;
+                }
+        }
+}
+
+static void atom_table_place(AtomTable *table, uint32_t hash, uint32_t atom)
+{
+        uint64_t mask = table->capacity - 1;
+        uint64_t slot = hash & mask;
+        while (table->slots[slot].atom) {
+                slot = (slot + 1) & mask;
+        }
+
+        table->slots[slot].hash = hash;
+        table->slots[slot].atom = atom;
+}
+
+// NOTE: expects the caller to hold the atom lock exclusive
+uint32_t AtomTable::intern(const char *chars, uint32_t length)
+{
+        uint32_t existing = this->find(chars, length);
+        if (existing) {
+                return existing;
+        }
+
+        InterlockedIncrement(&this->version);
+
+        if ((this->count + 1) * 2 > this->capacity) {
+                AtomSlot *old_slots = this->slots;
+                uint64_t old_capacity = this->capacity;
+
+                // the old slots stay behind in the arena for finds that
+                // loaded them before the grow
+                this->capacity = old_capacity * 2;
+                this->slots = (AtomSlot *)this->slot_arena.alloc(
+                        this->capacity * sizeof(AtomSlot));
+                memset(this->slots, 0, this->capacity * sizeof(AtomSlot));
+                for (uint64_t i = 0; i < old_capacity; ++i) {
+                        if (old_slots[i].atom) {
+                                atom_table_place(this, old_slots[i].hash,
+                                                 old_slots[i].atom);
+                        }
+                }
+        }
+
+        char *copy = (char *)this->chars.alloc(length + 1);
+        memcpy(copy, chars, length);
+        copy[length] = '\0';
+
+        Atom *atom = (Atom *)this->atoms.alloc(sizeof(Atom));
+        atom->chars = copy;
+        atom->length = length;
+        atom->hash = atom_hash(chars, length);
+
+        uint32_t index = (uint32_t)++this->count;
+        // a find probing mid intern may see the slot, the atom it points to
+        // has to be complete by then
+        MemoryBarrier();
+        atom_table_place(this, atom->hash, index);
+
+        InterlockedIncrement(&this->version);
+
+        return index;
+}
+
+static inline uint64_t symbol_key(uint32_t atom, SymbolTableEntry *scope)
+{
+        return ((uint64_t)atom << 32) | (scope ? scope->id : 0);
+}
+
+static inline uint64_t symbol_home_slot(uint32_t shift, uint64_t key)
+{
+        // fibonacci hashing spreads the atom and scope bits over the index
+        return (key * 11400714819323198485ull) >> shift;
+}
+
+static inline uint64_t symbol_probe_distance(uint32_t shift, uint64_t capacity,
+                                             uint64_t key, uint64_t slot)
+{
+        return (slot - symbol_home_slot(shift, key)) & (capacity - 1);
+}
+
+static void symbol_shard_allocate(SymbolTableShard *shard, uint64_t capacity)
+{
+        shard->capacity = capacity;
+        shard->shift = 64;
+        for (uint64_t i = capacity; i > 1; i >>= 1) {
+                --shard->shift;
+        }
+
+        shard->slots = (SymbolTableSlot *)shard->slot_arena.alloc(
+                capacity * sizeof(SymbolTableSlot));
+        memset(shard->slots, 0, capacity * sizeof(SymbolTableSlot));
+}
+
+void SymbolTableShard::init(uint64_t capacity)
+{
+        this->slot_arena = Arena::init(GIGABYTES(1));
+        symbol_shard_allocate(this, capacity);
+}
+
+void SymbolTableShard::destroy()
+{
+        this->slot_arena.destroy();
+}
+
+static SymbolTableEntry *symbol_slots_find(SymbolTableSlot *slots,
+                                           uint64_t capacity, uint32_t shift,
+                                           uint64_t key)
+{
+        uint64_t mask = capacity - 1;
+        uint64_t slot = symbol_home_slot(shift, key);
+
+        // bounded as an insert may be moving the entries while they're probed
+        for (uint64_t distance = 0; distance < capacity;
+             ++distance, slot = (slot + 1) & mask) {
+                SymbolTableSlot symbol_slot = slots[slot];
+                if (!symbol_slot.entry) {
+                        return nullptr;
+                }
+
+                if (symbol_slot.key == key) {
+                        return symbol_slot.entry;
+                }
+
+                // the key would have displaced this entry had it been here
+                if (symbol_probe_distance(shift, capacity, symbol_slot.key,
+                                          slot) < distance) {
+                        return nullptr;
+                }
+        }
+
+        return nullptr;
+}
+
+// NOTE: doesn't lock, mustn't be called by an insert between its increments
+// of the version or it would wait on itself
+SymbolTableEntry *SymbolTableShard::find(uint64_t key)
+{
+        for (;;) {
+                LONG version = seqlock_read_begin(&this->version);
+                SymbolTableSlot *slots = this->slots;
+                uint64_t capacity = this->capacity;
+                uint32_t shift = this->shift;
+                if (seqlock_read_retry(&this->version, version)) {
+                        continue;
+                }
+
+                SymbolTableEntry *entry =
+                        symbol_slots_find(slots, capacity, shift, key);
+                if (!seqlock_read_retry(&this->version, version)) {
+                        return entry;
+                }
+        }
+}
+
+// NOTE: expects the key to be absent and the slots to have room
+void SymbolTableShard::insert_slot(uint64_t key, SymbolTableEntry *entry)
+{
+        uint64_t mask = this->capacity - 1;
+        uint64_t slot = symbol_home_slot(this->shift, key);
+        uint64_t distance = 0;
+
+        SymbolTableSlot carried = {key, entry};
+        for (;; ++distance, slot = (slot + 1) & mask) {
+                SymbolTableSlot *symbol_slot = &this->slots[slot];
+                if (!symbol_slot->entry) {
+                        *symbol_slot = carried;
+                        return;
+                }
+
+                uint64_t resident_distance = symbol_probe_distance(
+                        this->shift, this->capacity, symbol_slot->key, slot);
+                if (resident_distance < distance) {
+                        SymbolTableSlot displaced = *symbol_slot;
+                        *symbol_slot = carried;
+                        carried = displaced;
+                        distance = resident_distance;
+                }
+        }
+}
+
+// the old slots are left in the arena, a lookup that loaded them before the
+// grow may still be probing them
+void SymbolTableShard::grow()
+{
+        SymbolTableSlot *old_slots = this->slots;
+        uint64_t old_capacity = this->capacity;
+
+        symbol_shard_allocate(this, old_capacity * 2);
+        for (uint64_t i = 0; i < old_capacity; ++i) {
+                if (old_slots[i].entry) {
+                        this->insert_slot(old_slots[i].key, old_slots[i].entry);
                 }
+        }
+}
+
+SymbolTable *SymbolTable::create(Arena *arena)
+{
+        SymbolTable *table = (SymbolTable *)arena->alloc(sizeof(SymbolTable));
+        new (table) SymbolTable();
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_SHARD_COUNT; ++i) {
+                table->shards[i].init(SYMBOL_TABLE_SHARD_INITIAL_CAPACITY);
+                InitializeSRWLock(&table->shards[i].lock);
+        }
 
-                scope = scope->key.scope;
+        table->atoms = AtomTable::init();
+        InitializeSRWLock(&table->atom_lock);
+
+        return table;
+}
+
+void SymbolTable::destroy()
+{
+        for (uint32_t i = 0; i < SYMBOL_TABLE_SHARD_COUNT; ++i) {
+                this->shards[i].destroy();
+        }
+
+        this->atoms.slot_arena.destroy();
+        this->atoms.atoms.destroy();
+        this->atoms.chars.destroy();
+}
+
+SymbolTableShard *SymbolTable::shard(SymbolTableEntry *scope)
+{
+        uint32_t id = scope ? scope->id : 0;
+        return &this->shards[((id * 2654435769u) >> 16) &
+                             (SYMBOL_TABLE_SHARD_COUNT - 1)];
+}
+
+uint32_t SymbolTable::find_atom(std::string &string)
+{
+        if (string == "") {
+                return 0;
         }
 
-        return hash % SYMBOL_TABLE_ARRAY_SIZE;
+        return this->atoms.find(string.data(), (uint32_t)string.length());
+}
+
+static SymbolTableEntry *symbol_table_find(SymbolTable *table, uint32_t atom,
+                                           SymbolTableEntry *scope)
+{
+        return table->shard(scope)->find(symbol_key(atom, scope));
 }
 
 SymbolTableEntry *SymbolTable::lookup(std::string &string,
-                                             SymbolTableEntry *scope)
+                                      SymbolTableEntry *scope)
 {
-        SymbolTableEntry *entry = &this->table[hash(string, scope)];
-        if (entry->key.identifier == "") {
+        // a name that was never interned can't have been declared anywhere
+        uint32_t atom = this->find_atom(string);
+        if (!atom) {
                 return nullptr;
         }
 
-        if (string == "") {
+        return symbol_table_find(this, atom, scope);
+}
+
+// The name is hashed once and then each scope is a single probe on the
+// (atom, scope id) key, so the cost doesn't grow with the length of the names
+// of the enclosing scopes
+SymbolTableEntry *SymbolTable::lookup_in_scopes(std::string &string,
+                                                SymbolTableEntry **scopes,
+                                                uint32_t scope_count)
+{
+        uint32_t atom = this->find_atom(string);
+        if (!atom) {
                 return nullptr;
         }
 
-        while (entry) {
-                if (entry->key.identifier == string &&
-                    entry->key.scope == scope) {
-                        //assert(entry->value.node != nullptr);
+        for (uint32_t i = scope_count; i > 0; --i) {
+                SymbolTableEntry *entry =
+                        symbol_table_find(this, atom, scopes[i - 1]);
+                if (entry) {
                         return entry;
                 }
-
-                entry = entry->next_in_table;
         }
 
         return nullptr;
 }
 
-SymbolTableEntry *SymbolTable::insert(Arena *arena, std::string string,
-                                             SymbolTableEntry *scope,
-                                             SymbolTableValue *value)
+static inline uint64_t scope_symbol_slot(uint32_t atom, uint32_t capacity)
+{
+        return (atom * 2654435769u) & (capacity - 1);
+}
+
+static SymbolTableEntry *scope_symbols_find(ScopeSymbols *symbols,
+                                            uint32_t atom)
 {
-        SymbolTableEntry *entry = this->lookup(string, scope);
+        if (!symbols) {
+                return nullptr;
+        }
 
-        if (entry != nullptr) {
+        if (!symbols->slots) {
+                for (uint32_t i = 0; i < symbols->count; ++i) {
+                        if (symbols->inline_symbols[i]->key.atom == atom) {
+                                return symbols->inline_symbols[i];
+                        }
+                }
+
+                return nullptr;
+        }
+
+        uint32_t mask = symbols->capacity - 1;
+        for (uint64_t slot = scope_symbol_slot(atom, symbols->capacity);;
+             slot = (slot + 1) & mask) {
+                SymbolTableEntry *entry = symbols->slots[slot];
+                if (!entry || entry->key.atom == atom) {
+                        return entry;
+                }
+        }
+}
+
+// the slots are kept at most half full, the old ones are left in the arena
+static void scope_symbols_index(Arena *arena, ScopeSymbols *symbols,
+                                uint32_t capacity)
+{
+        symbols->capacity = capacity;
+        symbols->slots = (SymbolTableEntry **)arena->alloc(
+                sizeof(SymbolTableEntry *) * capacity);
+        memset(symbols->slots, 0, sizeof(SymbolTableEntry *) * capacity);
+
+        uint32_t mask = capacity - 1;
+        for (SymbolTableEntry *entry = symbols->first; entry;
+             entry = entry->next_in_scope) {
+                uint64_t slot = scope_symbol_slot(entry->key.atom, capacity);
+                while (symbols->slots[slot]) {
+                        slot = (slot + 1) & mask;
+                }
+
+                symbols->slots[slot] = entry;
+        }
+}
+
+static void scope_symbols_add(Arena *arena, ScopeSymbols *symbols,
+                              SymbolTableEntry *entry)
+{
+        if (symbols->last) {
+                symbols->last->next_in_scope = entry;
+        } else {
+                symbols->first = entry;
+        }
+        symbols->last = entry;
+
+        if (symbols->count < SCOPE_INLINE_SYMBOLS) {
+                symbols->inline_symbols[symbols->count++] = entry;
+                return;
+        }
+
+        ++symbols->count;
+        if (!symbols->slots || symbols->count * 2 > symbols->capacity) {
+                scope_symbols_index(arena, symbols, symbols->slots ?
+                                                    symbols->capacity * 2 :
+                                                    SCOPE_INLINE_SYMBOLS * 4);
+                return;
+        }
+
+        uint32_t mask = symbols->capacity - 1;
+        uint64_t slot = scope_symbol_slot(entry->key.atom, symbols->capacity);
+        while (symbols->slots[slot]) {
+                slot = (slot + 1) & mask;
+        }
+
+        symbols->slots[slot] = entry;
+}
+
+ScopeSymbols *SymbolTable::scope_symbols(SymbolTableEntry *scope)
+{
+        return scope ? scope->symbols : &this->top_level;
+}
+
+SymbolTableEntry *SymbolTable::lookup_member(std::string &string,
+                                             SymbolTableEntry *scope)
+{
+        uint32_t atom = this->find_atom(string);
+        if (!atom) {
+                return nullptr;
+        }
+
+        SymbolTableShard *shard = this->shard(scope);
+
+        // the ScopeSymbols are copied so the probe reads a consistent count,
+        // slots and capacity, slots that were since replaced stay in the arena
+        for (;;) {
+                LONG version = seqlock_read_begin(&shard->version);
+                ScopeSymbols *symbols = this->scope_symbols(scope);
+                ScopeSymbols copy = {};
+                if (symbols) {
+                        copy = *symbols;
+                }
+                if (seqlock_read_retry(&shard->version, version)) {
+                        continue;
+                }
+
+                SymbolTableEntry *entry =
+                        scope_symbols_find(symbols ? &copy : nullptr, atom);
+                if (!seqlock_read_retry(&shard->version, version)) {
+                        return entry;
+                }
+        }
+}
+
+SymbolTableEntry *SymbolTable::insert(Arena *arena, std::string string,
+                                      SymbolTableEntry *scope,
+                                      SymbolTableValue *value)
+{
+        // nameless symbols can never be looked up so aren't kept in the table
+        if (string == "") {
+                SymbolTableEntry *entry =
+                        (SymbolTableEntry *)arena->alloc(sizeof(SymbolTableEntry));
+                new (entry) SymbolTableEntry();
+                entry->key.identifier = "";
+                entry->key.scope = scope;
                 entry->value = *value;
+                entry->id = InterlockedIncrement(&this->next_id);
+
                 return entry;
-                //assert(entry->value.node != nullptr);
         }
 
-        SymbolTableEntry *new_entry = &this->table[hash(string, scope)];
-        if (new_entry->key.identifier != "") {
-                // find an empty slot in the linked list
-                while (new_entry->next_in_table) {
-                        new_entry = new_entry->next_in_table;
-                }
+        uint32_t atom = this->find_atom(string);
+        if (!atom) {
+                AcquireSRWLockExclusive(&this->atom_lock);
+                atom = this->atoms.intern(string.data(),
+                                          (uint32_t)string.length());
+                ReleaseSRWLockExclusive(&this->atom_lock);
+        }
 
-                new_entry->next_in_table = (SymbolTableEntry *)arena->alloc(
-                        sizeof(*entry->next_in_table));
-                *new_entry->next_in_table = SymbolTableEntry();
-                new_entry->next_in_table->value = *value;
+        uint64_t key = symbol_key(atom, scope);
+        SymbolTableShard *shard = this->shard(scope);
 
-                new_entry = new_entry->next_in_table;
+        AcquireSRWLockExclusive(&shard->lock);
+        SymbolTableEntry *entry = shard->find(key);
+
+        if (entry != nullptr) {
+                entry->value = *value;
+                ReleaseSRWLockExclusive(&shard->lock);
+                return entry;
         }
 
-        // FIXME: find out why this isn't initilising std::string correctly
-        *new_entry = SymbolTableEntry();
-        new_entry->key.identifier = string;
+        SymbolTableEntry *new_entry =
+                (SymbolTableEntry *)arena->alloc(sizeof(SymbolTableEntry));
+        new (new_entry) SymbolTableEntry();
+        new_entry->key.atom = atom;
+        // atoms are never moved, reading one doesn't need the atom lock
+        new_entry->key.identifier = this->atoms.get(atom)->chars;
         new_entry->key.scope = scope;
         new_entry->value = *value;
+        new_entry->id = InterlockedIncrement(&this->next_id);
 
-//        assert(new_entry->value.node != nullptr);
+        InterlockedIncrement(&shard->version);
+        if ((shard->count + 1) * 4 > shard->capacity * 3) {
+                shard->grow();
+        }
+
+        shard->insert_slot(key, new_entry);
+        ++shard->count;
+
+        if (scope && !scope->symbols) {
+                scope->symbols = (ScopeSymbols *)arena->alloc(sizeof(ScopeSymbols));
+                memset(scope->symbols, 0, sizeof(ScopeSymbols));
+        }
+        scope_symbols_add(arena, this->scope_symbols(scope), new_entry);
+        InterlockedIncrement(&shard->version);
+        ReleaseSRWLockExclusive(&shard->lock);
 
         return new_entry;
 }
@@ -91,37 +575,1106 @@ SymbolTableEntry *SymbolTable::insert_function(Arena *arena, std::string string,
                                                SymbolTableValue *value)
 {
         SymbolTableEntry *entry = this->insert(arena, string, scope, value);
+        SymbolTableShard *shard = this->shard(scope);
 
+        AcquireSRWLockExclusive(&shard->lock);
         entry->value.static_type.function.custom_symbol = entry;
+        ReleaseSRWLockExclusive(&shard->lock);
 
         return entry;
 }
 
-Tables Tables::init(Arena *arena)
+// Only the words of the payload the type's kind uses are part of its
+// identity, the rest can be left over from a copy. Every payload is at most
+// two pointers
+static inline void type_intern_key(TypeInfo *type, void **first, void **second)
 {
-        Tables tables = Tables();
-        tables.symbol_table =
-                (SymbolTable *)arena->alloc(sizeof(SymbolTable));
-        // use placement new for initilisation because calling symbol tables
-        // constructor naively causes a copy
-        // of the entire struct on the stack and can cause overflow
-        // FIXME: find out why this isn't initilising std::string correctly
-        new (tables.symbol_table) SymbolTable();
+        void **payload = (void **)&type->list;
+        *first = nullptr;
+        *second = nullptr;
+
+        switch (type->type) {
+        case TypeInfoType::LIST:
+        case TypeInfoType::CLASS:
+                *first = payload[0];
+                break;
+        case TypeInfoType::DICT:
+        case TypeInfoType::KVPAIR:
+        case TypeInfoType::UNION:
+        case TypeInfoType::FUNCTION:
+                *first = payload[0];
+                *second = payload[1];
+                break;
+        default:
+                break;
+        }
+}
+
+static inline uint32_t type_intern_hash(TypeInfo *type)
+{
+        void *first;
+        void *second;
+        type_intern_key(type, &first, &second);
+
+        uint64_t hash = (uint64_t)type->type * 11400714819323198485ull;
+        hash = (hash ^ (uint64_t)first) * 11400714819323198485ull;
+        hash = (hash ^ (uint64_t)second) * 11400714819323198485ull;
+
+        return (uint32_t)(hash >> 32);
+}
+
+// true when a and b are the same kind with the same children, which for
+// interned children means the types are equal
+static inline bool type_infos_are_identical(TypeInfo *a, TypeInfo *b)
+{
+        void *a_first, *a_second, *b_first, *b_second;
+        type_intern_key(a, &a_first, &a_second);
+        type_intern_key(b, &b_first, &b_second);
+
+        return a->type == b->type && a_first == b_first &&
+               a_second == b_second;
+}
+
+static inline uint32_t union_set_hash(UnionSet *set)
+{
+        uint64_t hash = (uint64_t)TypeInfoType::UNION * 11400714819323198485ull;
+        hash = (hash ^ set->primitive_types) * 11400714819323198485ull;
+        for (uint32_t i = 0; i < set->member_count; ++i) {
+                hash = (hash ^ set->members[i]) * 11400714819323198485ull;
+        }
+
+        return (uint32_t)(hash >> 32);
+}
+
+static inline bool union_sets_are_equal(UnionSet *a, UnionSet *b)
+{
+        return a->primitive_types == b->primitive_types &&
+               a->member_count == b->member_count &&
+               !memcmp(a->members, b->members,
+                       a->member_count * sizeof(TypeId));
+}
+
+// a union is found by its set, anything else by its kind and children
+static TypeId type_interner_find(TypeInterner *interner, TypeInfo *type,
+                                 UnionSet *set, uint32_t hash)
+{
+        uint64_t mask = interner->capacity - 1;
+        for (uint64_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                TypeInternSlot *intern_slot = &interner->slots[slot];
+                if (!intern_slot->id) {
+                        return 0;
+                }
+
+                if (intern_slot->hash != hash) {
+                        continue;
+                }
+
+                if (set) {
+                        if (interner->get(intern_slot->id)->type ==
+                                    TypeInfoType::UNION &&
+                            union_sets_are_equal(
+                                    interner->union_set(intern_slot->id), set)) {
+                                return intern_slot->id;
+                        }
+                } else if (type_infos_are_identical(
+                                   interner->get(intern_slot->id), type)) {
+                        return intern_slot->id;
+                }
+        }
+}
+
+static void type_interner_place(TypeInterner *interner, uint32_t hash,
+                                TypeId id)
+{
+        uint64_t mask = interner->capacity - 1;
+        uint64_t slot = hash & mask;
+        while (interner->slots[slot].id) {
+                slot = (slot + 1) & mask;
+        }
 
-        tables.import_list =
-                (ImportList *)arena->alloc(sizeof(*tables.import_list));
-        new (tables.symbol_table) ImportList();
+        interner->slots[slot].hash = hash;
+        interner->slots[slot].id = id;
+}
 
-        tables.builtin_types = (TypeInfo *)arena->alloc(
-                sizeof(*tables.builtin_types) * (int)TypeInfoType::SIZE);
+// The builtin types are interned first so a builtin's id is its
+// TypeInfoType plus one
+TypeInterner *TypeInterner::create(Arena *arena)
+{
+        TypeInterner *interner = (TypeInterner *)arena->alloc(sizeof(TypeInterner));
+        new (interner) TypeInterner();
+        InitializeSRWLock(&interner->lock);
 
-        tables.symbol_table =
-                (SymbolTable *)arena->alloc(sizeof(*tables.symbol_table));
+        interner->capacity = TYPE_INTERNER_INITIAL_CAPACITY;
+        interner->slot_arena =
+                Arena::init(interner->capacity * sizeof(TypeInternSlot));
+        interner->slots = (TypeInternSlot *)interner->slot_arena.alloc(
+                interner->capacity * sizeof(TypeInternSlot));
+        memset(interner->slots, 0, interner->capacity * sizeof(TypeInternSlot));
+        interner->types = Arena::init(GIGABYTES(1));
+        interner->union_sets = Arena::init(GIGABYTES(1));
+        interner->union_members = Arena::init(GIGABYTES(1));
 
         for (int i = 0; i < (int)TypeInfoType::SIZE; ++i) {
-                new (&tables.builtin_types[i]) TypeInfo();
-                tables.builtin_types[i].type = (TypeInfoType)i;
+                TypeInfo builtin = {};
+                builtin.type = (TypeInfoType)i;
+                interner->intern(&builtin);
+        }
+
+        return interner;
+}
+
+TypeInfo *TypeInterner::get(TypeId id)
+{
+        assert(id && id <= this->count);
+        return &((TypeInfo *)this->types.memory)[id - 1];
+}
+
+TypeId TypeInterner::id_of(TypeInfo *type)
+{
+        TypeInfo *types = (TypeInfo *)this->types.memory;
+        if (type < types || type >= types + this->count) {
+                return 0;
+        }
+
+        return (TypeId)(type - types) + 1;
+}
+
+UnionSet *TypeInterner::union_set(TypeId id)
+{
+        assert(id && id <= this->count);
+        return &((UnionSet *)this->union_sets.memory)[id - 1];
+}
+
+// Needs the lock held exclusively
+static void type_interner_grow(TypeInterner *interner)
+{
+        if (((uint64_t)interner->count + 1) * 2 <= interner->capacity) {
+                return;
         }
 
+        uint64_t capacity = interner->capacity * 2;
+        Arena slot_arena = Arena::init(capacity * sizeof(TypeInternSlot));
+        TypeInternSlot *slots = (TypeInternSlot *)slot_arena.alloc(
+                capacity * sizeof(TypeInternSlot));
+        memset(slots, 0, capacity * sizeof(TypeInternSlot));
+
+        TypeInternSlot *old_slots = interner->slots;
+        uint64_t old_capacity = interner->capacity;
+        Arena old_arena = interner->slot_arena;
+
+        interner->slots = slots;
+        interner->capacity = capacity;
+        interner->slot_arena = slot_arena;
+        for (uint64_t i = 0; i < old_capacity; ++i) {
+                if (old_slots[i].id) {
+                        type_interner_place(interner, old_slots[i].hash,
+                                            old_slots[i].id);
+                }
+        }
+
+        old_arena.destroy();
+}
+
+// Needs the lock held exclusively, set is copied as the new type's set
+static TypeInfo *type_interner_append(TypeInterner *interner, TypeInfo *type,
+                                      UnionSet *set, uint32_t hash)
+{
+        type_interner_grow(interner);
+
+        TypeInfo *interned = (TypeInfo *)interner->types.alloc(sizeof(TypeInfo));
+        new (interned) TypeInfo();
+        interned->type = type->type;
+
+        void *first;
+        void *second;
+        type_intern_key(type, &first, &second);
+        ((void **)&interned->list)[0] = first;
+        ((void **)&interned->list)[1] = second;
+
+        UnionSet *interned_set =
+                (UnionSet *)interner->union_sets.alloc(sizeof(UnionSet));
+        *interned_set = set ? *set : UnionSet{};
+
+        TypeId id = ++interner->count;
+        type_interner_place(interner, hash, id);
+
+        return interned;
+}
+
+// The members of an interned type as a union, a type that isn't a union is
+// its only member
+static void type_interner_members_of(TypeInterner *interner, TypeInfo *type,
+                                     UnionSet *members, TypeId *single)
+{
+        *members = {};
+
+        if (type->type == TypeInfoType::UNION) {
+                *members = *interner->union_set(interner->id_of(type));
+        } else if (type->type < TypeInfoType::LIST) {
+                members->primitive_types = 1u << (int)type->type;
+        } else {
+                *single = interner->id_of(type);
+                members->members = single;
+                members->member_count = 1;
+        }
+}
+
+// Interns both sides then merges their sets, the spine of a long union has
+// to be interned from the innermost union out to keep this from recursing
+// once per member
+static TypeInfo *type_interner_intern_union(TypeInterner *interner,
+                                            TypeInfo *type)
+{
+        TypeInfo union_type = *type;
+        union_type.union_type.left = interner->intern(type->union_type.left);
+        union_type.union_type.right = interner->intern(type->union_type.right);
+
+        AcquireSRWLockExclusive(&interner->lock);
+
+        UnionSet left;
+        UnionSet right;
+        TypeId left_single;
+        TypeId right_single;
+        type_interner_members_of(interner, union_type.union_type.left, &left,
+                                 &left_single);
+        type_interner_members_of(interner, union_type.union_type.right, &right,
+                                 &right_single);
+
+        UnionSet set = {};
+        set.primitive_types = left.primitive_types | right.primitive_types;
+
+        uint64_t members_offset = interner->union_members.offset;
+        set.members = (TypeId *)interner->union_members.alloc(
+                (left.member_count + right.member_count) * sizeof(TypeId));
+
+        uint32_t l = 0;
+        uint32_t r = 0;
+        while (l < left.member_count || r < right.member_count) {
+                TypeId member;
+                if (r == right.member_count ||
+                    (l < left.member_count && left.members[l] < right.members[r])) {
+                        member = left.members[l++];
+                } else if (l == left.member_count ||
+                           right.members[r] < left.members[l]) {
+                        member = right.members[r++];
+                } else {
+                        member = left.members[l++];
+                        ++r;
+                }
+
+                set.members[set.member_count++] = member;
+        }
+
+        interner->union_members.offset =
+                members_offset + set.member_count * sizeof(TypeId);
+
+        TypeInfo *interned = nullptr;
+
+        // a union of one type is that type
+        bool single_primitive = set.primitive_types &&
+                                !(set.primitive_types & (set.primitive_types - 1));
+        if (!set.member_count && single_primitive) {
+                int type_index = 0;
+                while (!(set.primitive_types & (1u << type_index))) {
+                        ++type_index;
+                }
+                interned = interner->get(type_index + 1);
+        } else if (set.member_count == 1 && !set.primitive_types) {
+                interned = interner->get(set.members[0]);
+        }
+
+        if (interned) {
+                interner->union_members.offset = members_offset;
+                ReleaseSRWLockExclusive(&interner->lock);
+                return interned;
+        }
+
+        uint32_t hash = union_set_hash(&set);
+        TypeId id = type_interner_find(interner, nullptr, &set, hash);
+        if (id) {
+                interner->union_members.offset = members_offset;
+                interned = interner->get(id);
+        } else {
+                interned = type_interner_append(interner, &union_type, &set,
+                                                hash);
+        }
+
+        ReleaseSRWLockExclusive(&interner->lock);
+
+        return interned;
+}
+
+// Returns the interned copy of type
+TypeInfo *TypeInterner::intern(TypeInfo *type)
+{
+        if (this->id_of(type)) {
+                return type;
+        }
+
+        // the builtin union has no members and is interned like the others
+        if (type->type == TypeInfoType::UNION && type->union_type.left &&
+            type->union_type.right) {
+                return type_interner_intern_union(this, type);
+        }
+
+        uint32_t hash = type_intern_hash(type);
+
+        AcquireSRWLockShared(&this->lock);
+        TypeId id = type_interner_find(this, type, nullptr, hash);
+        ReleaseSRWLockShared(&this->lock);
+
+        if (id) {
+                return this->get(id);
+        }
+
+        AcquireSRWLockExclusive(&this->lock);
+
+        // another worker may have interned it between the locks
+        id = type_interner_find(this, type, nullptr, hash);
+        TypeInfo *interned = id ? this->get(id)
+                                : type_interner_append(this, type, nullptr, hash);
+
+        ReleaseSRWLockExclusive(&this->lock);
+
+        return interned;
+}
+
+TypeId TypeInterner::find(TypeInfo *type)
+{
+        TypeId id = this->id_of(type);
+        if (id || type->type == TypeInfoType::UNION) {
+                return id;
+        }
+
+        uint32_t hash = type_intern_hash(type);
+
+        AcquireSRWLockShared(&this->lock);
+        id = type_interner_find(this, type, nullptr, hash);
+        ReleaseSRWLockShared(&this->lock);
+
+        return id;
+}
+
+void TypeInterner::destroy()
+{
+        this->union_members.destroy();
+        this->union_sets.destroy();
+        this->slot_arena.destroy();
+        this->types.destroy();
+}
+
+static inline uint64_t subtype_cache_key(TypeId lhs, TypeId rhs)
+{
+        return ((uint64_t)lhs << 32) | rhs;
+}
+
+static inline uint64_t subtype_cache_slot(uint64_t key, uint64_t capacity)
+{
+        return (key * 11400714819323198485ull >> 32) & (capacity - 1);
+}
+
+SubtypeCache *SubtypeCache::create(Arena *arena)
+{
+        SubtypeCache *cache = (SubtypeCache *)arena->alloc(sizeof(SubtypeCache));
+        new (cache) SubtypeCache();
+        InitializeSRWLock(&cache->lock);
+
+        cache->capacity = SUBTYPE_CACHE_INITIAL_CAPACITY;
+        cache->slot_arena =
+                Arena::init(cache->capacity * sizeof(SubtypeCacheSlot));
+        cache->slots = (SubtypeCacheSlot *)cache->slot_arena.alloc(
+                cache->capacity * sizeof(SubtypeCacheSlot));
+        memset(cache->slots, 0, cache->capacity * sizeof(SubtypeCacheSlot));
+
+        return cache;
+}
+
+bool SubtypeCache::find(TypeId lhs, TypeId rhs, bool *result)
+{
+        uint64_t key = subtype_cache_key(lhs, rhs);
+        bool found = false;
+
+        AcquireSRWLockShared(&this->lock);
+        uint64_t mask = this->capacity - 1;
+        for (uint64_t slot = subtype_cache_slot(key, this->capacity);
+             this->slots[slot].key; slot = (slot + 1) & mask) {
+                if (this->slots[slot].key == key) {
+                        *result = this->slots[slot].result;
+                        found = true;
+                        break;
+                }
+        }
+        ReleaseSRWLockShared(&this->lock);
+
+        InterlockedIncrement(found ? &this->hits : &this->misses);
+
+        return found;
+}
+
+static void subtype_cache_place(SubtypeCache *cache, uint64_t key, bool result)
+{
+        uint64_t mask = cache->capacity - 1;
+        uint64_t slot = subtype_cache_slot(key, cache->capacity);
+        while (cache->slots[slot].key) {
+                if (cache->slots[slot].key == key) {
+                        return;
+                }
+
+                slot = (slot + 1) & mask;
+        }
+
+        cache->slots[slot].key = key;
+        cache->slots[slot].result = result;
+        ++cache->count;
+}
+
+void SubtypeCache::insert(TypeId lhs, TypeId rhs, bool result)
+{
+        AcquireSRWLockExclusive(&this->lock);
+
+        if ((this->count + 1) * 2 > this->capacity) {
+                SubtypeCacheSlot *old_slots = this->slots;
+                uint64_t old_capacity = this->capacity;
+                Arena old_arena = this->slot_arena;
+
+                this->capacity *= 2;
+                this->slot_arena =
+                        Arena::init(this->capacity * sizeof(SubtypeCacheSlot));
+                this->slots = (SubtypeCacheSlot *)this->slot_arena.alloc(
+                        this->capacity * sizeof(SubtypeCacheSlot));
+                memset(this->slots, 0,
+                       this->capacity * sizeof(SubtypeCacheSlot));
+                this->count = 0;
+
+                for (uint64_t i = 0; i < old_capacity; ++i) {
+                        if (old_slots[i].key) {
+                                subtype_cache_place(this, old_slots[i].key,
+                                                    old_slots[i].result);
+                        }
+                }
+
+                old_arena.destroy();
+        }
+
+        subtype_cache_place(this, subtype_cache_key(lhs, rhs), result);
+
+        ReleaseSRWLockExclusive(&this->lock);
+}
+
+void SubtypeCache::clear()
+{
+        AcquireSRWLockExclusive(&this->lock);
+        memset(this->slots, 0, this->capacity * sizeof(SubtypeCacheSlot));
+        this->count = 0;
+        ReleaseSRWLockExclusive(&this->lock);
+}
+
+void SubtypeCache::destroy()
+{
+        this->slot_arena.destroy();
+}
+
+// marks a class whose bases are being bound, a class that's reached again
+// while it's marked inherits from itself
+static ClassInfo class_info_binding;
+
+ClassHierarchy *ClassHierarchy::create(Arena *arena)
+{
+        ClassHierarchy *hierarchy =
+                (ClassHierarchy *)arena->alloc(sizeof(ClassHierarchy));
+        new (hierarchy) ClassHierarchy();
+        InitializeSRWLock(&hierarchy->lock);
+        hierarchy->arena = Arena::init(GIGABYTES(1));
+        hierarchy->merge_stack = Arena::init(MEGABYTES(64));
+
+        return hierarchy;
+}
+
+static inline bool class_info_has_ancestor(ClassInfo *info, uint32_t id)
+{
+        uint32_t word = id / 64;
+        return word < info->ancestor_words &&
+               (info->ancestors[word] >> (id % 64)) & 1;
+}
+
+struct ClassMergeSequence {
+        SymbolTableEntry **classes;
+        uint32_t count;
+        uint32_t head;
+};
+
+static bool class_merge_in_tail(ClassMergeSequence *sequences,
+                                uint32_t sequence_count,
+                                SymbolTableEntry *candidate)
+{
+        for (uint32_t i = 0; i < sequence_count; ++i) {
+                ClassMergeSequence *sequence = &sequences[i];
+                for (uint32_t j = sequence->head + 1; j < sequence->count;
+                     ++j) {
+                        if (sequence->classes[j] == candidate) {
+                                return true;
+                        }
+                }
+        }
+
+        return false;
+}
+
+// The C3 merge of the bases' mros and the bases themselves, appended to
+// info's mro which has to be the last thing allocated in the arena. When there's no consistent order
+// what's left is appended depth first
+static bool class_merge(ClassHierarchy *hierarchy, ClassInfo *info,
+                        ClassInfo **bases, uint32_t base_count)
+{
+        Arena *stack = &hierarchy->merge_stack;
+        uint64_t base_offset = stack->offset;
+
+        SymbolTableEntry **base_symbols = (SymbolTableEntry **)stack->alloc(
+                base_count * sizeof(SymbolTableEntry *));
+        ClassMergeSequence *sequences = (ClassMergeSequence *)stack->alloc(
+                (base_count + 1) * sizeof(ClassMergeSequence));
+        for (uint32_t i = 0; i < base_count; ++i) {
+                base_symbols[i] = bases[i]->symbol;
+                sequences[i] = {bases[i]->mro, bases[i]->mro_count, 0};
+        }
+        sequences[base_count] = {base_symbols, base_count, 0};
+        uint32_t sequence_count = base_count + 1;
+
+        bool consistent = true;
+        while (true) {
+                SymbolTableEntry *next = nullptr;
+                bool remaining = false;
+
+                for (uint32_t i = 0; i < sequence_count && !next; ++i) {
+                        ClassMergeSequence *sequence = &sequences[i];
+                        if (sequence->head == sequence->count) {
+                                continue;
+                        }
+
+                        remaining = true;
+                        SymbolTableEntry *candidate =
+                                sequence->classes[sequence->head];
+                        if (!class_merge_in_tail(sequences, sequence_count,
+                                                 candidate)) {
+                                next = candidate;
+                        }
+                }
+
+                if (!remaining) {
+                        break;
+                }
+
+                if (!next) {
+                        consistent = false;
+                        break;
+                }
+
+                *(SymbolTableEntry **)hierarchy->arena.alloc(
+                        sizeof(SymbolTableEntry *)) = next;
+                ++info->mro_count;
+
+                for (uint32_t i = 0; i < sequence_count; ++i) {
+                        ClassMergeSequence *sequence = &sequences[i];
+                        if (sequence->head < sequence->count &&
+                            sequence->classes[sequence->head] == next) {
+                                ++sequence->head;
+                        }
+                }
+        }
+
+        if (!consistent) {
+                for (uint32_t i = 0; i < base_count; ++i) {
+                        for (uint32_t j = 0; j < bases[i]->mro_count; ++j) {
+                                SymbolTableEntry *ancestor = bases[i]->mro[j];
+                                bool seen = false;
+                                for (uint32_t k = 0; k < info->mro_count && !seen;
+                                     ++k) {
+                                        seen = info->mro[k] == ancestor;
+                                }
+
+                                if (!seen) {
+                                        *(SymbolTableEntry **)
+                                                 hierarchy->arena.alloc(sizeof(
+                                                         SymbolTableEntry *)) =
+                                                ancestor;
+                                        ++info->mro_count;
+                                }
+                        }
+                }
+        }
+
+        stack->offset = base_offset;
+
+        return consistent;
+}
+
+// A class bound before one of its arguments was typed, e.g. a base from a
+// module of the same import cycle, has it as an unknown base. Only such a
+// class can go stale, once the argument is typed as a class or a base was
+// bound again since
+static bool class_info_is_stale(ClassInfo *info)
+{
+        if (!info->unknown_base) {
+                return false;
+        }
+
+        uint32_t class_argument_count = 0;
+        for (AstNode *argument = info->symbol->value.node->class_def.arguments;
+             argument; argument = argument->adjacent_child) {
+                class_argument_count +=
+                        argument->static_type.type == TypeInfoType::CLASS;
+        }
+        if (class_argument_count != info->class_argument_count) {
+                return true;
+        }
+
+        for (uint32_t i = 0; i < info->base_count; ++i) {
+                ClassInfo *base = info->bases[i];
+                if (base->symbol->class_info != base ||
+                    class_info_is_stale(base)) {
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+// Needs the lock held exclusively
+static ClassInfo *class_hierarchy_bind(ClassHierarchy *hierarchy,
+                                       SymbolTableEntry *class_symbol)
+{
+        ClassInfo *bound = class_symbol->class_info;
+        if (bound == &class_info_binding) {
+                // inherits from itself, the base is left out
+                return nullptr;
+        }
+
+        if (bound && !class_info_is_stale(bound)) {
+                return bound;
+        }
+
+        AstNode *class_node = class_symbol->value.node;
+        if (!class_node || class_node->type != AstNodeType::CLASS_DEF) {
+                return nullptr;
+        }
+
+        class_symbol->class_info = &class_info_binding;
+
+        // bound bases are pushed, anything else makes the base unknown
+        Arena *stack = &hierarchy->merge_stack;
+        uint64_t base_offset = stack->offset;
+        uint32_t base_count = 0;
+        uint32_t class_argument_count = 0;
+        bool unknown_base = false;
+        for (AstNode *argument = class_node->class_def.arguments; argument;
+             argument = argument->adjacent_child) {
+                ClassInfo *base = nullptr;
+                if (argument->static_type.type == TypeInfoType::CLASS) {
+                        ++class_argument_count;
+                        base = class_hierarchy_bind(
+                                hierarchy,
+                                argument->static_type.class_type.custom_symbol);
+                }
+
+                if (!base) {
+                        unknown_base = true;
+                        continue;
+                }
+
+                *(ClassInfo **)stack->alloc(sizeof(ClassInfo *)) = base;
+                ++base_count;
+                unknown_base |= base->unknown_base;
+        }
+        ClassInfo **bases = (ClassInfo **)((char *)stack->memory + base_offset);
+
+        ClassInfo *info = (ClassInfo *)hierarchy->arena.alloc(sizeof(ClassInfo));
+        new (info) ClassInfo();
+        info->symbol = class_symbol;
+        info->id = ++hierarchy->count;
+        info->unknown_base = unknown_base;
+        info->class_argument_count = class_argument_count;
+
+        info->base_count = base_count;
+        info->bases = (ClassInfo **)hierarchy->arena.alloc(
+                base_count * sizeof(ClassInfo *));
+        memcpy(info->bases, bases, base_count * sizeof(ClassInfo *));
+
+        info->mro = (SymbolTableEntry **)hierarchy->arena.alloc(
+                sizeof(SymbolTableEntry *));
+        info->mro[0] = class_symbol;
+        info->mro_count = 1;
+        if (base_count == 1) {
+                SymbolTableEntry **mro = (SymbolTableEntry **)hierarchy->arena.alloc(
+                        bases[0]->mro_count * sizeof(SymbolTableEntry *));
+                memcpy(mro, bases[0]->mro,
+                       bases[0]->mro_count * sizeof(SymbolTableEntry *));
+                info->mro_count += bases[0]->mro_count;
+        } else if (base_count > 1) {
+                info->inconsistent =
+                        !class_merge(hierarchy, info, bases, base_count);
+        }
+
+        // every ancestor was bound first so has a lower id
+        info->ancestor_words = info->id / 64 + 1;
+        info->ancestors = (uint64_t *)hierarchy->arena.alloc(
+                info->ancestor_words * sizeof(uint64_t));
+        memset(info->ancestors, 0, info->ancestor_words * sizeof(uint64_t));
+        info->ancestors[info->id / 64] |= 1ull << (info->id % 64);
+        for (uint32_t i = 0; i < base_count; ++i) {
+                for (uint32_t word = 0; word < bases[i]->ancestor_words;
+                     ++word) {
+                        info->ancestors[word] |= bases[i]->ancestors[word];
+                }
+        }
+
+        uint32_t member_count = 0;
+        for (uint32_t i = 0; i < info->mro_count; ++i) {
+                ScopeSymbols *symbols = info->mro[i]->symbols;
+                member_count += symbols ? symbols->count : 0;
+        }
+
+        info->member_capacity = SCOPE_INLINE_SYMBOLS;
+        while (info->member_capacity < member_count * 2) {
+                info->member_capacity *= 2;
+        }
+        info->members = (SymbolTableEntry **)hierarchy->arena.alloc(
+                info->member_capacity * sizeof(SymbolTableEntry *));
+        memset(info->members, 0,
+               info->member_capacity * sizeof(SymbolTableEntry *));
+
+        uint32_t mask = info->member_capacity - 1;
+        for (uint32_t i = 0; i < info->mro_count; ++i) {
+                ScopeSymbols *symbols = info->mro[i]->symbols;
+                for (SymbolTableEntry *member = symbols ? symbols->first :
+                                                          nullptr;
+                     member; member = member->next_in_scope) {
+                        uint64_t slot = scope_symbol_slot(member->key.atom,
+                                                          info->member_capacity);
+                        while (info->members[slot] &&
+                               info->members[slot]->key.atom !=
+                                       member->key.atom) {
+                                slot = (slot + 1) & mask;
+                        }
+
+                        if (!info->members[slot]) {
+                                info->members[slot] = member;
+                        }
+                }
+        }
+
+        stack->offset = base_offset;
+
+        // published once it's complete, readers don't take the lock
+        MemoryBarrier();
+        class_symbol->class_info = info;
+
+        return info;
+}
+
+ClassInfo *ClassHierarchy::info(SymbolTableEntry *class_symbol)
+{
+        if (!class_symbol) {
+                return nullptr;
+        }
+
+        ClassInfo *info = class_symbol->class_info;
+        if (info && info != &class_info_binding && !class_info_is_stale(info)) {
+                return info;
+        }
+
+        AcquireSRWLockExclusive(&this->lock);
+        info = class_hierarchy_bind(this, class_symbol);
+        ReleaseSRWLockExclusive(&this->lock);
+
+        return info;
+}
+
+bool ClassHierarchy::is_subclass(SymbolTableEntry *derived,
+                                 SymbolTableEntry *base)
+{
+        if (derived == base) {
+                return true;
+        }
+
+        ClassInfo *derived_info = this->info(derived);
+        ClassInfo *base_info = this->info(base);
+        if (!derived_info || !base_info || derived_info->unknown_base) {
+                return true;
+        }
+
+        return class_info_has_ancestor(derived_info, base_info->id);
+}
+
+SymbolTableEntry *ClassHierarchy::lookup_member(SymbolTable *symbol_table,
+                                                std::string &string,
+                                                SymbolTableEntry *class_symbol)
+{
+        ClassInfo *info = this->info(class_symbol);
+        if (!info) {
+                return symbol_table->lookup_member(string, class_symbol);
+        }
+
+        uint32_t atom = symbol_table->find_atom(string);
+        if (!atom) {
+                return nullptr;
+        }
+
+        uint32_t mask = info->member_capacity - 1;
+        for (uint64_t slot = scope_symbol_slot(atom, info->member_capacity);;
+             slot = (slot + 1) & mask) {
+                SymbolTableEntry *member = info->members[slot];
+                if (!member || member->key.atom == atom) {
+                        return member;
+                }
+        }
+}
+
+void ClassHierarchy::destroy()
+{
+        this->merge_stack.destroy();
+        this->arena.destroy();
+}
+
+CallSignatures *CallSignatures::create(Arena *arena)
+{
+        CallSignatures *signatures =
+                (CallSignatures *)arena->alloc(sizeof(CallSignatures));
+        new (signatures) CallSignatures();
+        InitializeSRWLock(&signatures->lock);
+        signatures->arena = Arena::init(GIGABYTES(1));
+
+        return signatures;
+}
+
+static CallSignature *call_signature_compile(CallSignatures *signatures,
+                                             SymbolTable *symbol_table,
+                                             TypeInterner *interner,
+                                             SymbolTableEntry *function_symbol)
+{
+        AstNode *function_node = function_symbol->value.node;
+        AstNodeFunctionDef *function = &function_node->function_def;
+        Arena *arena = &signatures->arena;
+
+        uint32_t count = 0;
+        for (AstNode *argument = function->arguments; argument;
+             argument = argument->adjacent_child) {
+                ++count;
+        }
+
+        // the arena doesn't align, the 8 byte arrays come first and the
+        // 4 byte ones are padded so the next signature stays on 8 bytes
+        CallSignature *signature =
+                (CallSignature *)arena->alloc(sizeof(CallSignature));
+        new (signature) CallSignature();
+        signature->parameter_count = count;
+        signature->parameter_types =
+                (TypeInfo **)arena->alloc(count * sizeof(TypeInfo *));
+
+        signature->required_words = count / 64 + 1;
+        signature->required = (uint64_t *)arena->alloc(
+                signature->required_words * sizeof(uint64_t));
+        memset(signature->required, 0,
+               signature->required_words * sizeof(uint64_t));
+
+        signature->parameter_atoms = (uint32_t *)arena->alloc(
+                (count * sizeof(uint32_t) + 7) & ~7ull);
+
+        signature->keyword_capacity = SCOPE_INLINE_SYMBOLS;
+        while (signature->keyword_capacity < count * 2) {
+                signature->keyword_capacity *= 2;
+        }
+        signature->keywords = (uint32_t *)arena->alloc(
+                (signature->keyword_capacity * sizeof(uint32_t) + 7) & ~7ull);
+        memset(signature->keywords, 0,
+               signature->keyword_capacity * sizeof(uint32_t));
+
+        // the positions count the / and * markers, a / always comes first
+        signature->positional_only_count =
+                function->slash_pos < 0 ? 0 : function->slash_pos;
+        signature->keyword_only_index =
+                function->star_pos < 0 ?
+                        count :
+                        function->star_pos - (function->slash_pos >= 0);
+        signature->star = function->star != nullptr;
+        signature->double_star = function->double_star != nullptr;
+
+        SymbolTableEntry *scope = function_symbol->key.scope;
+        signature->method = scope && scope->value.node &&
+                            scope->value.node->type == AstNodeType::CLASS_DEF;
+        for (AstNode *decorator = function->decarators; decorator;
+             decorator = decorator->adjacent_child) {
+                if (decorator->token.value == "staticmethod") {
+                        signature->method = false;
+                } else if (decorator->token.value == "classmethod") {
+                        signature->class_method = true;
+                }
+        }
+        signature->class_method &= signature->method;
+
+        uint32_t mask = signature->keyword_capacity - 1;
+        uint32_t index = 0;
+        for (AstNode *argument = function->arguments; argument;
+             argument = argument->adjacent_child, ++index) {
+                AstNode *name = argument;
+                if (argument->type == AstNodeType::DECLARATION) {
+                        name = argument->declaration.name;
+                } else if (argument->type == AstNodeType::ASSIGNMENT) {
+                        name = argument->assignment.left;
+                }
+
+                TypeInfo type = argument->static_type;
+                signature->parameter_types[index] = interner->intern(&type);
+
+                if (!is_default_arg(argument)) {
+                        signature->required[index / 64] |= 1ull << (index % 64);
+                }
+
+                // a summary doesn't declare the parameters so their names
+                // may not be interned yet
+                std::string &string = name->token.value;
+                uint32_t atom = symbol_table->find_atom(string);
+                if (!atom) {
+                        AcquireSRWLockExclusive(&symbol_table->atom_lock);
+                        atom = symbol_table->atoms.intern(
+                                string.data(), (uint32_t)string.length());
+                        ReleaseSRWLockExclusive(&symbol_table->atom_lock);
+                }
+                signature->parameter_atoms[index] = atom;
+
+                uint64_t slot =
+                        scope_symbol_slot(atom, signature->keyword_capacity);
+                while (signature->keywords[slot]) {
+                        slot = (slot + 1) & mask;
+                }
+                signature->keywords[slot] = index + 1;
+        }
+
+        ++signatures->count;
+
+        // published once it's complete, readers don't take the lock
+        MemoryBarrier();
+        function_symbol->call_signature = signature;
+
+        return signature;
+}
+
+CallSignature *CallSignatures::signature(SymbolTable *symbol_table,
+                                         TypeInterner *interner,
+                                         SymbolTableEntry *function_symbol)
+{
+        if (!function_symbol) {
+                return nullptr;
+        }
+
+        CallSignature *signature = function_symbol->call_signature;
+        if (signature) {
+                return signature;
+        }
+
+        AstNode *function_node = function_symbol->value.node;
+        if (!function_node ||
+            function_node->type != AstNodeType::FUNCTION_DEF) {
+                return nullptr;
+        }
+
+        AcquireSRWLockExclusive(&this->lock);
+        signature = function_symbol->call_signature;
+        if (!signature) {
+                signature = call_signature_compile(this, symbol_table,
+                                                   interner, function_symbol);
+        }
+        ReleaseSRWLockExclusive(&this->lock);
+
+        return signature;
+}
+
+void CallSignatures::destroy()
+{
+        this->arena.destroy();
+}
+
+uint32_t CallSignature::keyword_index(uint32_t atom)
+{
+        if (!atom) {
+                return UINT32_MAX;
+        }
+
+        uint32_t mask = this->keyword_capacity - 1;
+        for (uint64_t slot = scope_symbol_slot(atom, this->keyword_capacity);;
+             slot = (slot + 1) & mask) {
+                uint32_t index = this->keywords[slot];
+                if (!index) {
+                        return UINT32_MAX;
+                }
+
+                if (this->parameter_atoms[index - 1] == atom) {
+                        return index - 1;
+                }
+        }
+}
+
+LazyDeclarations *LazyDeclarations::create(Arena *arena)
+{
+        LazyDeclarations *lazy =
+                (LazyDeclarations *)arena->alloc(sizeof(LazyDeclarations));
+        new (lazy) LazyDeclarations();
+        InitializeSRWLock(&lazy->lock);
+
+        for (uint32_t i = 0; i < LAZY_MAX_DEPTH; ++i) {
+                lazy->scope_stacks[i] = Arena::init(sizeof(void *) * 1000);
+        }
+
+        return lazy;
+}
+
+void LazyDeclarations::destroy()
+{
+        for (uint32_t i = 0; i < LAZY_MAX_DEPTH; ++i) {
+                this->scope_stacks[i].destroy();
+        }
+}
+
+// allocated in arena, the list itself has its own
+ImportList *ImportList::create(Arena *arena)
+{
+        ImportList *import_list = (ImportList *)arena->alloc(sizeof(ImportList));
+        new (import_list) ImportList();
+        import_list->arena = Arena::init(MEGABYTES(1));
+        import_list->list = (AstNode **)import_list->arena.memory;
+
+        return import_list;
+}
+
+void ImportList::push(AstNode *import_target)
+{
+        AstNode **slot = (AstNode **)this->arena.alloc(sizeof(AstNode *));
+        *slot = import_target;
+        ++this->list_index;
+}
+
+void ImportList::destroy()
+{
+        this->arena.destroy();
+}
+
+Tables Tables::init(Arena *arena)
+{
+        Tables tables = Tables();
+        tables.symbol_table = SymbolTable::create(arena);
+
+        tables.import_list = ImportList::create(arena);
+
+        tables.type_interner = TypeInterner::create(arena);
+        tables.builtin_types = tables.type_interner->get(1);
+        tables.subtype_cache = SubtypeCache::create(arena);
+        tables.class_hierarchy = ClassHierarchy::create(arena);
+        tables.call_signatures = CallSignatures::create(arena);
+        tables.lazy_declarations = LazyDeclarations::create(arena);
+
+        tables.type_stack = (Arena *)arena->alloc(sizeof(*tables.type_stack));
+        *tables.type_stack = Arena::init(MEGABYTES(64));
+
+        tables.diagnostics = Diagnostics::create(arena, DEFAULT_MAX_ERRORS);
+
         return tables;
 }
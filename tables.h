@@ -1,57 +1,424 @@
 #ifndef SYMBOLTABLE_H_
 #define SYMBOLTABLE_H_
 
+#include <stdint.h>
 #include <string>
 
 #include "typing.h"
 #include "utils.h"
+#include "diagnostics.h"
 
-#define SYMBOL_TABLE_ARRAY_SIZE 4096
+// a power of two, as is the capacity of each shard
+#define SYMBOL_TABLE_SHARD_COUNT 16
+#define SYMBOL_TABLE_SHARD_INITIAL_CAPACITY 64
+#define ATOM_TABLE_INITIAL_CAPACITY 1024
+#define TYPE_INTERNER_INITIAL_CAPACITY 1024
+#define SUBTYPE_CACHE_INITIAL_CAPACITY 1024
+#define SCOPE_INLINE_SYMBOLS 8
 
 struct SymbolTableEntry;
+struct SymbolTable;
 struct AstNode;
+struct ClassInfo;
+struct CallSignature;
+struct LazyDeclaration;
+
+struct Atom {
+        // NUL terminated, lives as long as the table
+        const char *chars;
+        uint32_t length;
+        uint32_t hash;
+};
+
+struct AtomSlot {
+        uint32_t hash;
+        // index into atoms plus one, 0 when the slot is empty
+        uint32_t atom;
+};
+
+// Interns identifiers so symbols are keyed by a small integer instead of a
+// string, linear probing and kept at most half full. Finds don't lock, intern
+// makes the version odd while it changes the slots and a find that saw it odd
+// or changed probes again. Grown slots are allocated after the old ones in
+// slot_arena, which are kept so a find that raced the grow never reads freed
+// memory
+struct AtomTable {
+        Arena slot_arena;
+        AtomSlot *slots;
+        uint64_t capacity;
+        uint64_t count;
+        volatile LONG version;
+        // contiguous array of Atom
+        Arena atoms;
+        Arena chars;
+
+        static AtomTable init();
+        // returns 0 when the string was never interned
+        uint32_t find(const char *chars, uint32_t length);
+        uint32_t intern(const char *chars, uint32_t length);
+        Atom *get(uint32_t atom);
+};
+
+struct TypeInternSlot {
+        uint32_t hash;
+        // 0 when the slot is empty
+        TypeId id;
+};
+
+// The canonical form of a union, the primitive members are bits indexed by
+// their TypeInfoType and the rest are their TypeIds sorted ascending. Nested
+// unions are flattened and duplicates dropped so equal unions have equal
+// sets whichever order they were written in
+struct UnionSet {
+        uint32_t primitive_types;
+        uint32_t member_count;
+        TypeId *members;
+};
+
+// Hash conses types so structurally equal types share one TypeInfo and can
+// be compared by pointer or TypeId. Children are compared by pointer, they
+// need to be interned first for an equal type to be found and one that isn't
+// only costs a duplicate. Unions are the exception, they're identified by
+// their UnionSet. Linear probing kept at most half full, finds take the lock
+// shared as the type workers intern concurrently
+struct TypeInterner {
+        // contiguous array of TypeInfo indexed by id - 1, grows in place so
+        // interned types never move
+        Arena types;
+        // a UnionSet per type in the same order, empty unless it's a union
+        Arena union_sets;
+        Arena union_members;
+        Arena slot_arena;
+        TypeInternSlot *slots;
+        uint64_t capacity;
+        uint32_t count;
+        SRWLOCK lock;
+
+        static TypeInterner *create(Arena *arena);
+        TypeInfo *intern(TypeInfo *type);
+        TypeInfo *get(TypeId id);
+        // 0 when type isn't one of the interned types
+        TypeId id_of(TypeInfo *type);
+        UnionSet *union_set(TypeId id);
+        // finds the interned copy without interning it, 0 when there's
+        // none. Unions can only be found by interning them
+        TypeId find(TypeInfo *type);
+        void destroy();
+};
+
+struct SubtypeCacheSlot {
+        // the lhs id in the high half and the rhs in the low, 0 when the
+        // slot is empty
+        uint64_t key;
+        bool result;
+};
+
+// Remembers whether the interned rhs type is compatible with the interned
+// lhs type so the structural comparison is done once per pair. Linear
+// probing kept at most half full, lookups take the lock shared
+struct SubtypeCache {
+        Arena slot_arena;
+        SubtypeCacheSlot *slots;
+        uint64_t capacity;
+        uint64_t count;
+        SRWLOCK lock;
+        volatile LONG hits;
+        volatile LONG misses;
+
+        static SubtypeCache *create(Arena *arena);
+        // false when the pair hasn't been compared yet
+        bool find(TypeId lhs, TypeId rhs, bool *result);
+        void insert(TypeId lhs, TypeId rhs, bool result);
+        // forgets every result, for when a class's bases may have changed
+        void clear();
+        void destroy();
+};
+
+static inline bool type_infos_are_identical(TypeInfo *a, TypeInfo *b);
 
 struct SymbolTableKey {
-        std::string identifier;
+        uint32_t atom;
+        // the atom's text
+        const char *identifier;
+        // the enclosing scope, null for top level symbols such as modules
         SymbolTableEntry *scope;
 };
 
+// The symbols declared directly in one scope. While there are few they're
+// found by scanning inline_symbols, once that's full they're indexed by atom
+// in slots. Either way first and next_in_scope give them in the order they
+// were declared
+struct ScopeSymbols {
+        SymbolTableEntry *inline_symbols[SCOPE_INLINE_SYMBOLS];
+        // power of two, null until there are more symbols than fit inline
+        SymbolTableEntry **slots;
+        uint32_t capacity;
+        uint32_t count;
+        SymbolTableEntry *first;
+        SymbolTableEntry *last;
+};
+
 struct SymbolTableValue {
         TypeInfo static_type;
         AstNode *node;
 };
 
+// Allocated in the arena passed to insert and never moved, the table only
+// holds pointers to entries
 struct SymbolTableEntry {
         SymbolTableKey key;
         SymbolTableValue value;
+        // non zero, symbols declared inside this one are keyed by it
+        uint32_t id;
+        // null until something is declared inside this symbol
+        ScopeSymbols *symbols;
+        SymbolTableEntry *next_in_scope;
+        // null until the class is bound in the ClassHierarchy
+        ClassInfo *class_info;
+        // null until the function is first called
+        CallSignature *call_signature;
+        // set when the symbol's module is only checked on demand
+        LazyDeclaration *lazy_declaration;
+};
 
-        SymbolTableEntry *next_in_table;
+struct SymbolTableSlot {
+        // atom in the high half, the scope's id in the low half
+        uint64_t key;
+        // null when the slot is empty
+        SymbolTableEntry *entry;
 };
 
+// Open addressing with Robin Hood probing, an entry that is further from its
+// home slot takes the place of one that is closer. Probe lengths stay short
+// and even at high load and a miss stops as soon as it passes where the key
+// would have been. The slots are doubled when 3/4 full, the old ones are left
+// in slot_arena for lookups that were still probing them
+struct SymbolTableShard {
+        Arena slot_arena;
+        SymbolTableSlot *slots;
+        uint64_t capacity;
+        uint64_t count;
+        uint32_t shift;
+        // odd while an insert is changing the slots or the ScopeSymbols of a
+        // scope in the shard, lookups don't lock and retry when it was odd or
+        // changed while they read
+        volatile LONG version;
+        // only taken by inserts, exclusive
+        SRWLOCK lock;
+
+        void init(uint64_t capacity);
+        SymbolTableEntry *find(uint64_t key);
+        void insert_slot(uint64_t key, SymbolTableEntry *entry);
+        void grow();
+        void destroy();
+};
+
+// Modules are parsed and typed on several threads at once so the symbols are
+// split into shards by the id of their scope, each with its own lock. All of
+// a scope's symbols are in one shard so threads declaring into different
+// modules or functions rarely wait on each other. Lookups never lock, they
+// only retry when an insert into the same shard changed it under them. Entries are allocated in the arena passed
+// to insert, threads inserting at the same time must pass different arenas
 struct SymbolTable {
-        SymbolTableEntry table[SYMBOL_TABLE_ARRAY_SIZE];
+        SymbolTableShard shards[SYMBOL_TABLE_SHARD_COUNT];
+        AtomTable atoms;
+        // serialises interning, finding an atom doesn't take it
+        SRWLOCK atom_lock;
+        volatile LONG next_id;
+        // symbols declared outside of any scope
+        ScopeSymbols top_level;
 
+        static SymbolTable *create(Arena *arena);
         SymbolTableEntry *insert(Arena *arena, std::string string,
                                  SymbolTableEntry *scope,
                                  SymbolTableValue *value);
         SymbolTableEntry *insert_function(Arena *arena, std::string string,
                                  SymbolTableEntry *scope,
                                  SymbolTableValue *value);
-        uint32_t hash(std::string &string, SymbolTableEntry *scope);
         SymbolTableEntry *lookup(std::string &string, SymbolTableEntry *scope);
+        // scopes is a stack with the innermost scope last
+        SymbolTableEntry *lookup_in_scopes(std::string &string,
+                                           SymbolTableEntry **scopes,
+                                           uint32_t scope_count);
+        // only looks at the symbols the scope itself declares, e.g. the
+        // members of a class
+        SymbolTableEntry *lookup_member(std::string &string,
+                                        SymbolTableEntry *scope);
+        // not locked, only read it once nothing more is declared in scope
+        ScopeSymbols *scope_symbols(SymbolTableEntry *scope);
+        SymbolTableShard *shard(SymbolTableEntry *scope);
+        // returns 0 when the name was never declared anywhere
+        uint32_t find_atom(std::string &string);
+        void destroy();
+};
+
+// A class's place in the hierarchy, immutable once it's bound. A class with
+// an unknown base is bound again once another of its arguments is typed as a
+// class or one of its bases was bound again, the old info is left in place
+// for readers that still hold it
+struct ClassInfo {
+        SymbolTableEntry *symbol;
+        // dense from 1 in the order classes are bound, bases are bound
+        // before the classes that derive from them
+        uint32_t id;
+        // C3 linearisation, starts with the class itself
+        SymbolTableEntry **mro;
+        uint32_t mro_count;
+        // a bit per class id set for the class and each of its ancestors
+        uint64_t *ancestors;
+        uint32_t ancestor_words;
+        // the members of every class in mro indexed by atom, the first class
+        // in mro to declare a name is the one it resolves to
+        SymbolTableEntry **members;
+        uint32_t member_capacity;
+        // the bound bases in the order they're declared
+        ClassInfo **bases;
+        uint32_t base_count;
+        // the arguments that were typed as a class when it was bound
+        uint32_t class_argument_count;
+        // a base, or a base of a base, that isn't a class we know, the class
+        // is then assumed to be a subclass of any other
+        bool unknown_base;
+        // the bases have no consistent C3 order, mro is then depth first
+        bool inconsistent;
+};
+
+// Classes are bound the first time they're needed, after their bases,
+// binding takes the lock exclusively. A bound class is read without the
+// lock so is-subclass is a bit test and an attribute is one probe of the
+// flattened members
+struct ClassHierarchy {
+        Arena arena;
+        // scratch for the C3 merge
+        Arena merge_stack;
+        uint32_t count;
+        SRWLOCK lock;
+
+        static ClassHierarchy *create(Arena *arena);
+        // null when class_symbol isn't a class definition
+        ClassInfo *info(SymbolTableEntry *class_symbol);
+        bool is_subclass(SymbolTableEntry *derived, SymbolTableEntry *base);
+        // looks through the class's mro
+        SymbolTableEntry *lookup_member(SymbolTable *symbol_table,
+                                        std::string &string,
+                                        SymbolTableEntry *class_symbol);
+        void destroy();
+};
+
+// What a call is checked against, a function's parameters in the order
+// they're declared without its *args and **kwargs. Immutable once it's
+// compiled and holds nothing of the function's module, only interned types
+// and atoms
+struct CallSignature {
+        TypeInfo **parameter_types;
+        uint32_t *parameter_atoms;
+        uint32_t parameter_count;
+        // the parameters before this one can't be passed by keyword
+        uint32_t positional_only_count;
+        // the parameters from this one on can only be passed by keyword
+        uint32_t keyword_only_index;
+        // parameter indices plus one by atom, 0 is an empty slot
+        uint32_t *keywords;
+        uint32_t keyword_capacity;
+        // a bit per parameter without a default
+        uint64_t *required;
+        uint32_t required_words;
+        bool star;
+        bool double_star;
+        // the first parameter is bound to the instance or the class the
+        // function is called through
+        bool method;
+        bool class_method;
+
+        // UINT32_MAX when no parameter is named atom
+        uint32_t keyword_index(uint32_t atom);
 };
 
+// Signatures are compiled the first time the function is called, compiling
+// takes the lock exclusively. A compiled signature is read without the lock
+// so matching a call's arguments is a probe per keyword and a bit per
+// parameter
+struct CallSignatures {
+        Arena arena;
+        uint32_t count;
+        SRWLOCK lock;
+
+        static CallSignatures *create(Arena *arena);
+        // null when function_symbol isn't a function definition, its
+        // parameters have to be typed
+        CallSignature *signature(SymbolTable *symbol_table,
+                                 TypeInterner *interner,
+                                 SymbolTableEntry *function_symbol);
+        void destroy();
+};
+
+#define LAZY_MAX_DEPTH 64
+
+// A declaration in a module that's only checked on demand, it's typed the
+// first time a lookup resolves to its symbol
+struct LazyDeclaration {
+        AstNode *node;
+        // the scope it's declared in
+        SymbolTableEntry *scope;
+        // its module's
+        Arena *arena;
+        const char *filename;
+        // only read and written under the lock, set while the declaration
+        // is being typed so a cycle through it stops there
+        bool typing;
+        volatile LONG typed;
+};
+
+// Typing a declaration takes the lock exclusively, the thread holding it
+// re-enters when an annotation resolves to another pending declaration.
+// Once typed a declaration is read without the lock
+struct LazyDeclarations {
+        SRWLOCK lock;
+        // the type stack of the thread holding lock, every thread has its own
+        Arena *volatile owner;
+        // the outermost scope of every module
+        SymbolTableEntry *builtins;
+        // one per level of nesting, deeper than that is left untyped
+        Arena scope_stacks[LAZY_MAX_DEPTH];
+        uint32_t depth;
+        volatile LONG declared;
+        volatile LONG typed;
+
+        static LazyDeclarations *create(Arena *arena);
+        void destroy();
+};
+
+// The import targets of a module in the order they were parsed, list grows
+// in place in arena so there's no limit on how many a module has
 struct ImportList {
-        AstNode *list[4096];
-        uint64_t list_index = 0;
+        Arena arena;
+        AstNode **list;
+        uint64_t list_index;
+
+        static ImportList *create(Arena *arena);
+        void push(AstNode *import_target);
+        void destroy();
 };
 
 //TODO bounds checking for builtin_type_table
 struct Tables {
         SymbolTable *symbol_table;
         //TODO make these globals
+        // the first interned types, indexed by TypeInfoType
         TypeInfo *builtin_types;
+        TypeInterner *type_interner;
+        SubtypeCache *subtype_cache;
+        ClassHierarchy *class_hierarchy;
+        CallSignatures *call_signatures;
+        LazyDeclarations *lazy_declarations;
         ImportList *import_list;
+        Arena *type_stack;
+        // when set function bodies are appended here as DeferredBody
+        // instead of being typed
+        Arena *deferred_bodies;
+        // when set every symbol whose type is read is appended here
+        Arena *symbol_reads;
+        Diagnostics *diagnostics;
         static Tables init(Arena *arena);
 };
 
@@ -7,6 +7,13 @@
 #include "debug.cpp"
 #include "typing.cpp"
 #include "tables.cpp"
+#include "diagnostics.cpp"
+#include "traversal.cpp"
+#include "serialize.cpp"
+#include "resolve.cpp"
+#include "pipeline.cpp"
+#include "incremental.cpp"
+#include "summary.cpp"
 
 #define PARSER_TESTS 1
 
@@ -71,6 +78,37 @@ const char *debug_token_type_to_string(enum TokenType type)
         return TOKEN_STRINGS[(int)type];
 }
 
+// declares the main scope and in it the builtins the tests' annotations name
+static SymbolTableEntry *declare_test_builtins(Tables *tables,
+                                               Arena *symbol_table_arena)
+{
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables->symbol_table->insert(
+                symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        const char *builtin_names[] = {"int", "str", "list", "dict"};
+        TypeInfoType builtin_types[] = {
+                TypeInfoType::INTEGER,
+                TypeInfoType::STRING,
+                TypeInfoType::LIST,
+                TypeInfoType::DICT,
+        };
+        for (int i = 0; i < array_count(builtin_names); ++i) {
+                SymbolTableValue builtin_value = {};
+                builtin_value.node = &main_node;
+                builtin_value.static_type.type = builtin_types[i];
+                tables->symbol_table->insert(symbol_table_arena,
+                                             builtin_names[i], main_scope,
+                                             &builtin_value);
+        }
+
+        return main_scope;
+}
+
 
 static Test tokenise_file_test()
 {
@@ -474,6 +512,2524 @@ static Test precedence_test()
         END_TEST();
 }
 
+// long operator chains and deeply nested displays must parse and type
+// without recursing per level, nesting through parenthesis is capped
+static Test deep_nesting_test()
+{
+        START_TEST();
+        const int chain_length = 20000;
+        const int list_depth = 5000;
+
+        std::string source = "1";
+        for (int i = 1; i < chain_length; ++i) {
+                source += " + 1";
+        }
+        source += "\n";
+        source += std::string(list_depth, '[') + "1" +
+                  std::string(list_depth, ']') + "\n";
+        source += std::string(MAX_EXPRESSION_NESTING + 1, '(') + "1" +
+                  std::string(MAX_EXPRESSION_NESTING + 1, ')') + "\n";
+
+        InputStream input_stream =
+                input_stream_create_from_string(source.c_str());
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        AstNode *root = result.node;
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+
+        AstNode *chain = root->nary.children;
+        type_parse_tree(chain, &ast_arena, &scope_stack, &tables, "tests");
+        ASSERT(chain->static_type.type == TypeInfoType::INTEGER,
+               debug_static_type_to_string(chain->static_type));
+
+        int operators = 0;
+        for (AstNode *node = chain; node->type == AstNodeType::BINARYEXPR;
+             node = node->binary.left) {
+                ++operators;
+        }
+        ASSERT(operators == chain_length - 1, operators);
+
+        AstNode *list = chain->adjacent_child;
+        type_parse_tree(list, &ast_arena, &scope_stack, &tables, "tests");
+        ASSERT(list->static_type.type == TypeInfoType::LIST,
+               debug_static_type_to_string(list->static_type));
+
+        int depth = 0;
+        for (AstNode *node = list; node->type == AstNodeType::LIST;
+             node = node->list.children) {
+                ++depth;
+        }
+        ASSERT(depth == list_depth, depth);
+
+        AstNode *parenthesised = list->adjacent_child;
+        ASSERT(parenthesised->type == AstNodeType::INVALID,
+               "nesting past MAX_EXPRESSION_NESTING should be a syntax error");
+        ASSERT(parser.expression_depth == 0, parser.expression_depth);
+
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+// type errors are collected instead of exiting so one pass finds them all
+static Test diagnostics_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "x: int = 1\n"
+                "y: str = x\n"
+                "z: float = \"s\"\n"
+                "w = undefined_name\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        tables.diagnostics->max_errors = 0;
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        SymbolTableValue builtin_value = {};
+        builtin_value.node = &main_node;
+        builtin_value.static_type.type = TypeInfoType::INTEGER;
+        tables.symbol_table->insert(&symbol_table_arena, "int", main_scope,
+                                    &builtin_value);
+        builtin_value.static_type.type = TypeInfoType::FLOAT;
+        tables.symbol_table->insert(&symbol_table_arena, "float", main_scope,
+                                    &builtin_value);
+        builtin_value.static_type.type = TypeInfoType::STRING;
+        tables.symbol_table->insert(&symbol_table_arena, "str", main_scope,
+                                    &builtin_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "b.py");
+
+        ASSERT(tables.diagnostics->count == 3, tables.diagnostics->count);
+
+        // the last statement is still typed after the errors before it
+        AstNode *statement = result.node->nary.children;
+        while (statement->adjacent_child)
+                statement = statement->adjacent_child;
+        ASSERT(statement->type == AstNodeType::ASSIGNMENT,
+               debug_enum_to_string(AstNodeTypeEnumMembers,
+                                    (int)statement->type));
+        ASSERT(statement->assignment.expression->static_type.type ==
+                       TypeInfoType::ANY,
+               debug_static_type_to_string(
+                       statement->assignment.expression->static_type));
+
+        // reported out of order as they would be from several workers
+        tables.diagnostics->report("a.py", 7, 1, "from another module");
+
+        FILE *output = tmpfile();
+        tables.diagnostics->print(output);
+        fclose(output);
+
+        Diagnostic *list = (Diagnostic *)tables.diagnostics->entries.memory;
+        ASSERT(strcmp(list[0].filename, "a.py") == 0, list[0].filename);
+        ASSERT(list[1].line == 2, list[1].line);
+        ASSERT(list[2].line == 3, list[2].line);
+        ASSERT(list[3].line == 4, list[3].line);
+
+        // the cap counts distinct errors and stops instead of exiting
+        Diagnostics *capped = Diagnostics::create(&symbol_table_arena, 2);
+        capped->report("a.py", 1, 1, "same");
+        capped->report("a.py", 1, 1, "same");
+        ASSERT(capped->count == 1 && !capped->stopped, capped->count);
+        capped->report("a.py", 2, 1, "other");
+        capped->report("a.py", 3, 1, "after the cap");
+        ASSERT(capped->count == 2 && capped->stopped, capped->count);
+        capped->destroy();
+
+        tables.diagnostics->destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+// a large literal display of a few types should get a union with one member
+// per distinct type rather than one per change in type between elements
+static int count_union_members(TypeInfo *type)
+{
+        if (type->type != TypeInfoType::UNION)
+                return 1;
+
+        return count_union_members(type->union_type.left) +
+               count_union_members(type->union_type.right);
+}
+
+static Test literal_display_test()
+{
+        START_TEST();
+        const int element_count = 10000;
+        const char *literals[] = {"1", "\"s\"", "2.5", "None"};
+
+        std::string source = "[";
+        for (int i = 0; i < element_count; ++i) {
+                source += literals[i % array_count(literals)];
+                source += ", ";
+        }
+        source += "x]\n{";
+        for (int i = 0; i < element_count; ++i) {
+                source += std::to_string(i) + ": " +
+                          literals[i % array_count(literals)] + ", ";
+        }
+        source += "\"k\": 1}\n";
+
+        InputStream input_stream =
+                input_stream_create_from_string(source.c_str());
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        // a non literal element still goes through the general path
+        SymbolTableValue x_value = {};
+        x_value.node = &main_node;
+        x_value.static_type.type = TypeInfoType::BOOLEAN;
+        tables.symbol_table->insert(&symbol_table_arena, "x", main_scope,
+                                    &x_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+
+        AstNode *list = result.node->nary.children;
+        type_parse_tree(list, &ast_arena, &scope_stack, &tables, "tests");
+        ASSERT(list->static_type.type == TypeInfoType::LIST,
+               debug_static_type_to_string(list->static_type));
+        int members = count_union_members(list->static_type.list.item_type);
+        ASSERT(members == 5, members);
+
+        AstNode *dict = list->adjacent_child;
+        type_parse_tree(dict, &ast_arena, &scope_stack, &tables, "tests");
+        ASSERT(dict->static_type.type == TypeInfoType::DICT,
+               debug_static_type_to_string(dict->static_type));
+        members = count_union_members(dict->static_type.dict.key_type);
+        ASSERT(members == 2, members);
+        members = count_union_members(dict->static_type.dict.val_type);
+        ASSERT(members == 4, members);
+
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+struct TraversalRecord {
+        AstNode *nodes[64];
+        uint32_t count;
+        bool skip_functions;
+};
+
+static bool traversal_record_visit(AstNode *node, uint32_t, void *user_data)
+{
+        TraversalRecord *record = (TraversalRecord *)user_data;
+        if (record->count < array_count(record->nodes))
+                record->nodes[record->count] = node;
+        ++record->count;
+
+        return !(record->skip_functions &&
+                 node->type == AstNodeType::FUNCTION_DEF);
+}
+
+static Test traversal_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "def f(a):\n"
+                "    return [a, 1 + 2]\n"
+                "x = (1, 2)\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        Arena stack = Arena::init(MEGABYTES(64));
+
+        TraversalRecord original = {};
+        ast_visit(result.node, &stack, traversal_record_visit, &original);
+        ASSERT(original.count > 10 && original.count <= 64, original.count);
+        ASSERT(original.count == ast_count_nodes(result.node, &stack), "");
+        ASSERT(original.nodes[0] == result.node, "");
+        ASSERT(stack.offset == 0, stack.offset);
+
+        TraversalRecord skipped = {};
+        skipped.skip_functions = true;
+        ast_visit(result.node, &stack, traversal_record_visit, &skipped);
+        ASSERT(skipped.count < original.count, skipped.count);
+
+        AstNode *copy = ast_copy_tree(result.node, &ast_arena, &stack);
+        TraversalRecord copied = {};
+        ast_visit(copy, &stack, traversal_record_visit, &copied);
+        ASSERT(copied.count == original.count, copied.count);
+
+        for (uint32_t i = 0; i < copied.count; ++i) {
+                ASSERT(copied.nodes[i] != original.nodes[i], i);
+                ASSERT(copied.nodes[i]->type == original.nodes[i]->type, i);
+                ASSERT(copied.nodes[i]->token.value ==
+                               original.nodes[i]->token.value,
+                       i);
+        }
+
+        stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test serialize_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "def f(a: int) -> int:\n"
+                "    return a + 1\n"
+                "x = [1, 2.5]\n"
+                "y: dict[str, int] = {\"a\": 1}\n"
+                "z = f(2)\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+
+        Arena out = Arena::init(MEGABYTES(64));
+        uint64_t size = serialize_tree(result.node, &out);
+        ASSERT(size > sizeof(SerializedHeader), size);
+
+        Arena loaded_arena = Arena::init(GIGABYTES(1));
+        AstNode *loaded = deserialize_tree(out.memory, size, &loaded_arena,
+                                           tables.symbol_table);
+        ASSERT(loaded, "");
+
+        Arena stack = Arena::init(MEGABYTES(64));
+        TraversalRecord original = {};
+        ast_visit(result.node, &stack, traversal_record_visit, &original);
+        TraversalRecord copied = {};
+        ast_visit(loaded, &stack, traversal_record_visit, &copied);
+        ASSERT(original.count == copied.count, copied.count);
+        ASSERT(original.count <= array_count(original.nodes), original.count);
+
+        for (uint32_t i = 0; i < copied.count; ++i) {
+                AstNode *a = original.nodes[i];
+                AstNode *b = copied.nodes[i];
+                ASSERT(a->type == b->type, i);
+                ASSERT(a->token.value == b->token.value, i);
+                ASSERT(a->token.line == b->token.line, i);
+                ASSERT(a->static_type.type == b->static_type.type, i);
+                ASSERT(b >= (AstNode *)loaded_arena.memory &&
+                               b < (AstNode *)((char *)loaded_arena.memory +
+                                               loaded_arena.offset),
+                       i);
+
+                // symbols resolve to the same entries
+                if (a->static_type.type == TypeInfoType::FUNCTION) {
+                        ASSERT(a->static_type.function.custom_symbol ==
+                                       b->static_type.function.custom_symbol,
+                               i);
+                }
+        }
+
+        // writing the loaded tree again gives the same bytes
+        uint64_t second_size = serialize_tree(loaded, &out);
+        ASSERT(second_size == size, second_size);
+        ASSERT(memcmp(out.memory, (char *)out.memory + size, size) == 0, "");
+
+        // a different schema is rejected
+        ((SerializedHeader *)out.memory)->schema_hash ^= 1;
+        ASSERT(!deserialize_tree(out.memory, size, &loaded_arena, nullptr), "");
+        ASSERT(!deserialize_tree((char *)out.memory + size, size - 1,
+                                 &loaded_arena, nullptr),
+               "");
+
+        stack.destroy();
+        loaded_arena.destroy();
+        out.destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test symbol_table_test()
+{
+        START_TEST();
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        SymbolTable *symbol_table = tables.symbol_table;
+
+        SymbolTableValue value = {};
+        value.static_type.type = TypeInfoType::INTEGER;
+
+        const uint32_t scope_count = 8;
+        const uint32_t name_count = 20000;
+        SymbolTableEntry *scopes[scope_count];
+        for (uint32_t i = 0; i < scope_count; ++i) {
+                scopes[i] = symbol_table->insert(
+                        &symbol_table_arena, "scope" + std::to_string(i),
+                        i ? scopes[i - 1] : nullptr, &value);
+        }
+
+        // enough to grow the slots several times over
+        SymbolTableEntry **entries = (SymbolTableEntry **)symbol_table_arena.alloc(
+                sizeof(SymbolTableEntry *) * scope_count * name_count);
+        for (uint32_t i = 0; i < name_count; ++i) {
+                for (uint32_t j = 0; j < scope_count; ++j) {
+                        entries[i * scope_count + j] = symbol_table->insert(
+                                &symbol_table_arena, "name" + std::to_string(i),
+                                scopes[j], &value);
+                }
+        }
+        ASSERT(symbol_table->shard(scopes[0])->capacity >
+                       SYMBOL_TABLE_SHARD_INITIAL_CAPACITY,
+               symbol_table->shard(scopes[0])->capacity);
+
+        for (uint32_t i = 0; i < name_count; ++i) {
+                std::string name = "name" + std::to_string(i);
+                for (uint32_t j = 0; j < scope_count; ++j) {
+                        SymbolTableEntry *entry =
+                                symbol_table->lookup(name, scopes[j]);
+                        ASSERT(entry == entries[i * scope_count + j], name);
+                        ASSERT(entry->key.scope == scopes[j], name);
+                        ASSERT(name == entry->key.identifier, name);
+                }
+                // the same name in another scope is another symbol
+                ASSERT(entries[i * scope_count] != entries[i * scope_count + 1],
+                       name);
+                ASSERT(!symbol_table->lookup(name, nullptr), name);
+        }
+
+        // inserting again updates the value in place
+        std::string name = "name42";
+        value.static_type.type = TypeInfoType::FLOAT;
+        SymbolTableEntry *reinserted = symbol_table->insert(
+                &symbol_table_arena, name, scopes[3], &value);
+        ASSERT(reinserted == entries[42 * scope_count + 3], "");
+        ASSERT(symbol_table->lookup(name, scopes[3])->value.static_type.type ==
+                       TypeInfoType::FLOAT,
+               "");
+
+        // resolving against a scope stack finds the innermost declaration
+        ASSERT(symbol_table->lookup_in_scopes(name, scopes, scope_count) ==
+                       entries[42 * scope_count + scope_count - 1],
+               "");
+        std::string outer = "scope0";
+        ASSERT(symbol_table->lookup_in_scopes(outer, scopes, scope_count) ==
+                       nullptr,
+               "");
+        SymbolTableEntry *outer_scopes[] = {nullptr, scopes[0]};
+        ASSERT(symbol_table->lookup_in_scopes(outer, outer_scopes, 2) ==
+                       scopes[0],
+               "");
+
+        // each scope holds its own symbols in declaration order
+        ScopeSymbols *symbols = symbol_table->scope_symbols(scopes[0]);
+        ASSERT(symbols->count == name_count + 1, symbols->count);
+        ASSERT(symbols->first == scopes[1], "");
+        uint32_t declared = 0;
+        for (SymbolTableEntry *entry = symbols->first->next_in_scope; entry;
+             entry = entry->next_in_scope, ++declared) {
+                ASSERT(entry == entries[declared * scope_count], declared);
+        }
+        ASSERT(declared == name_count, declared);
+        ASSERT(symbol_table->scope_symbols(nullptr)->first == scopes[0], "");
+        ASSERT(symbol_table->scope_symbols(scopes[scope_count - 1])->slots,
+               "");
+        ASSERT(symbol_table->lookup_member(name, scopes[5]) ==
+                       entries[42 * scope_count + 5],
+               "");
+        ASSERT(!symbol_table->lookup_member(outer, scopes[1]), "");
+
+        // a few members stay inline
+        std::string member = "member";
+        SymbolTableEntry *member_entry = symbol_table->insert(
+                &symbol_table_arena, member, entries[0], &value);
+        ASSERT(!entries[0]->symbols->slots, "");
+        ASSERT(symbol_table->lookup_member(member, entries[0]) == member_entry,
+               "");
+        ASSERT(!symbol_table->lookup_member(name, entries[0]), "");
+
+        std::string unknown = "unknown";
+        ASSERT(!symbol_table->lookup(unknown, scopes[0]), "");
+        ASSERT(!symbol_table->lookup_in_scopes(unknown, scopes, scope_count),
+               "");
+        std::string empty = "";
+        ASSERT(!symbol_table->lookup(empty, scopes[0]), "");
+
+        symbol_table->destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+#define SYMBOL_TABLE_TEST_THREADS 4
+#define SYMBOL_TABLE_TEST_NAMES 5000
+
+struct SymbolTableThread {
+        SymbolTable *symbol_table;
+        SymbolTableEntry *scope;
+        // every thread reads the scope the previous one declares into
+        SymbolTableEntry *other_scope;
+        Arena arena;
+        SymbolTableEntry *entries[SYMBOL_TABLE_TEST_NAMES];
+};
+
+static DWORD WINAPI symbol_table_thread(LPVOID param)
+{
+        SymbolTableThread *thread = (SymbolTableThread *)param;
+        SymbolTableValue value = {};
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_NAMES; ++i) {
+                std::string name = "name" + std::to_string(i);
+                thread->entries[i] = thread->symbol_table->insert(
+                        &thread->arena, name, thread->scope, &value);
+
+                // whatever is found must be the entry that was declared
+                SymbolTableEntry *other =
+                        thread->symbol_table->lookup(name, thread->other_scope);
+                if (other && (other->key.scope != thread->other_scope ||
+                              name != other->key.identifier)) {
+                        return 1;
+                }
+        }
+
+        return 0;
+}
+
+// Threads declaring into their own scopes at once each with their own arena
+static Test symbol_table_threads_test()
+{
+        START_TEST();
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        SymbolTable *symbol_table = tables.symbol_table;
+
+        SymbolTableValue value = {};
+        SymbolTableThread *threads = (SymbolTableThread *)symbol_table_arena.alloc(
+                sizeof(SymbolTableThread) * SYMBOL_TABLE_TEST_THREADS);
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                threads[i].symbol_table = symbol_table;
+                threads[i].scope = symbol_table->insert(
+                        &symbol_table_arena, "module" + std::to_string(i),
+                        nullptr, &value);
+                threads[i].arena = Arena::init(MEGABYTES(64));
+        }
+
+        HANDLE handles[SYMBOL_TABLE_TEST_THREADS];
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                threads[i].other_scope =
+                        threads[(i + SYMBOL_TABLE_TEST_THREADS - 1) %
+                                SYMBOL_TABLE_TEST_THREADS].scope;
+                handles[i] = CreateThread(0, 0, symbol_table_thread,
+                                          &threads[i], 0, 0);
+                ASSERT(handles[i], i);
+        }
+
+        WaitForMultipleObjects(SYMBOL_TABLE_TEST_THREADS, handles, TRUE,
+                               INFINITE);
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                DWORD exit_code = 1;
+                GetExitCodeThread(handles[i], &exit_code);
+                CloseHandle(handles[i]);
+                ASSERT(exit_code == 0, i);
+        }
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                ScopeSymbols *symbols =
+                        symbol_table->scope_symbols(threads[i].scope);
+                ASSERT(symbols->count == SYMBOL_TABLE_TEST_NAMES,
+                       symbols->count);
+
+                for (uint32_t j = 0; j < SYMBOL_TABLE_TEST_NAMES; ++j) {
+                        std::string name = "name" + std::to_string(j);
+                        ASSERT(symbol_table->lookup(name, threads[i].scope) ==
+                                       threads[i].entries[j],
+                               name);
+                }
+        }
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                threads[i].arena.destroy();
+        }
+        symbol_table->destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+#define SYMBOL_TABLE_TEST_READ_NAMES 200
+
+struct SymbolTableReader {
+        SymbolTable *symbol_table;
+        SymbolTableEntry *scope;
+        SymbolTableEntry *entries[SYMBOL_TABLE_TEST_READ_NAMES];
+        volatile LONG *writers_running;
+        uint64_t lookups;
+};
+
+static DWORD WINAPI symbol_table_reader(LPVOID param)
+{
+        SymbolTableReader *reader = (SymbolTableReader *)param;
+
+        while (*reader->writers_running) {
+                for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_READ_NAMES; ++i) {
+                        std::string name = "read" + std::to_string(i);
+                        SymbolTableEntry *entry =
+                                reader->symbol_table->lookup(name, reader->scope);
+                        SymbolTableEntry *member =
+                                reader->symbol_table->lookup_member(
+                                        name, reader->scope);
+                        if (entry != reader->entries[i] ||
+                            member != reader->entries[i]) {
+                                return 1;
+                        }
+                        reader->lookups += 2;
+                }
+        }
+
+        return 0;
+}
+
+static DWORD WINAPI symbol_table_writer(LPVOID param)
+{
+        SymbolTableThread *thread = (SymbolTableThread *)param;
+        SymbolTableValue value = {};
+
+        // new atoms and a new scope every few names so the atom table and
+        // every shard grow while the readers probe them
+        SymbolTableEntry *scope = nullptr;
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_NAMES; ++i) {
+                if (i % 16 == 0) {
+                        scope = thread->symbol_table->insert(
+                                &thread->arena,
+                                "scope" + std::to_string(thread->scope->id) +
+                                        "_" + std::to_string(i),
+                                thread->scope, &value);
+                }
+
+                std::string name = "write" + std::to_string(thread->scope->id) +
+                                   "_" + std::to_string(i);
+                thread->entries[i] = thread->symbol_table->insert(
+                        &thread->arena, name, scope, &value);
+        }
+
+        return 0;
+}
+
+// Lookups don't lock, they have to find every symbol of a scope that is
+// already declared while other threads insert into other scopes in the same
+// shards and grow the tables under them
+static Test symbol_table_lookup_during_insert_test()
+{
+        START_TEST();
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        SymbolTable *symbol_table = tables.symbol_table;
+
+        SymbolTableValue value = {};
+        SymbolTableReader *readers = (SymbolTableReader *)symbol_table_arena.alloc(
+                sizeof(SymbolTableReader) * SYMBOL_TABLE_TEST_THREADS);
+        SymbolTableThread *writers = (SymbolTableThread *)symbol_table_arena.alloc(
+                sizeof(SymbolTableThread) * SYMBOL_TABLE_TEST_THREADS);
+        volatile LONG writers_running = SYMBOL_TABLE_TEST_THREADS;
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                readers[i].symbol_table = symbol_table;
+                readers[i].scope = symbol_table->insert(
+                        &symbol_table_arena, "reader" + std::to_string(i),
+                        nullptr, &value);
+                readers[i].writers_running = &writers_running;
+                readers[i].lookups = 0;
+                for (uint32_t j = 0; j < SYMBOL_TABLE_TEST_READ_NAMES; ++j) {
+                        readers[i].entries[j] = symbol_table->insert(
+                                &symbol_table_arena, "read" + std::to_string(j),
+                                readers[i].scope, &value);
+                }
+
+                writers[i].symbol_table = symbol_table;
+                writers[i].scope = symbol_table->insert(
+                        &symbol_table_arena, "writer" + std::to_string(i),
+                        nullptr, &value);
+                writers[i].arena = Arena::init(MEGABYTES(64));
+        }
+
+        HANDLE handles[SYMBOL_TABLE_TEST_THREADS * 2];
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                handles[i] = CreateThread(0, 0, symbol_table_reader,
+                                          &readers[i], 0, 0);
+                ASSERT(handles[i], i);
+        }
+
+        HANDLE *writer_handles = handles + SYMBOL_TABLE_TEST_THREADS;
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                writer_handles[i] = CreateThread(0, 0, symbol_table_writer,
+                                                 &writers[i], 0, 0);
+                ASSERT(writer_handles[i], i);
+        }
+
+        WaitForMultipleObjects(SYMBOL_TABLE_TEST_THREADS, writer_handles, TRUE,
+                               INFINITE);
+        writers_running = 0;
+        WaitForMultipleObjects(SYMBOL_TABLE_TEST_THREADS, handles, TRUE,
+                               INFINITE);
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS * 2; ++i) {
+                DWORD exit_code = 1;
+                GetExitCodeThread(handles[i], &exit_code);
+                CloseHandle(handles[i]);
+                ASSERT(exit_code == 0, i);
+        }
+
+        for (uint32_t i = 0; i < SYMBOL_TABLE_TEST_THREADS; ++i) {
+                ASSERT(readers[i].lookups, i);
+
+                for (uint32_t j = 0; j < SYMBOL_TABLE_TEST_NAMES; ++j) {
+                        SymbolTableEntry *entry = writers[i].entries[j];
+                        std::string name = entry->key.identifier;
+                        ASSERT(symbol_table->lookup(name, entry->key.scope) ==
+                                       entry,
+                               name);
+                }
+                writers[i].arena.destroy();
+        }
+        symbol_table->destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+struct ResolveRecord {
+        AstNode *identifiers[64];
+        uint32_t count;
+};
+
+static bool resolve_record_visit(AstNode *node, uint32_t, void *user_data)
+{
+        ResolveRecord *record = (ResolveRecord *)user_data;
+        if (node->type == AstNodeType::IDENTIFIER &&
+            record->count < array_count(record->identifiers)) {
+                record->identifiers[record->count++] = node;
+        }
+
+        return true;
+}
+
+static AstNode *resolve_record_find(ResolveRecord *record, const char *name,
+                                    int line)
+{
+        for (uint32_t i = 0; i < record->count; ++i) {
+                AstNode *identifier = record->identifiers[i];
+                if (identifier->token.value == name &&
+                    identifier->token.line == line) {
+                        return identifier;
+                }
+        }
+
+        return nullptr;
+}
+
+// Identifiers are bound to the symbol Python would pick, enclosing classes
+// are skipped and global and nonlocal statements are honoured
+static Test resolve_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "x = 1\n"
+                "y = 1\n"
+                "def f():\n"
+                "    y = 2.5\n"
+                "    x = 2.5\n"
+                "    def g():\n"
+                "        nonlocal y\n"
+                "        global x\n"
+                "        a = x + y\n"
+                "    return x\n"
+                "class C:\n"
+                "    x = \"s\"\n"
+                "    b = x\n"
+                "    def m():\n"
+                "        c = x\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena stack = Arena::init(MEGABYTES(1));
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        uint64_t resolved = resolve_names(result.node, &scope_stack, &stack,
+                                          tables.symbol_table);
+        ASSERT(resolved > 0, resolved);
+        ASSERT(stack.offset == 0, stack.offset);
+
+        std::string x = "x";
+        std::string y = "y";
+        std::string f = "f";
+        std::string class_name = "C";
+        SymbolTableEntry *f_symbol = tables.symbol_table->lookup(f, main_scope);
+        SymbolTableEntry *c_symbol =
+                tables.symbol_table->lookup(class_name, main_scope);
+        SymbolTableEntry *global_x = tables.symbol_table->lookup(x, main_scope);
+        SymbolTableEntry *f_x = tables.symbol_table->lookup(x, f_symbol);
+        SymbolTableEntry *f_y = tables.symbol_table->lookup(y, f_symbol);
+        SymbolTableEntry *class_x = tables.symbol_table->lookup(x, c_symbol);
+        ASSERT(global_x && f_x && f_y && class_x, "");
+
+        ResolveRecord record = {};
+        ast_visit(result.node, &stack, resolve_record_visit, &record);
+
+        AstNode *identifier = resolve_record_find(&record, "x", 9);
+        ASSERT(identifier && identifier->identifier.symbol == global_x, "");
+        identifier = resolve_record_find(&record, "y", 9);
+        ASSERT(identifier && identifier->identifier.symbol == f_y, "");
+        identifier = resolve_record_find(&record, "x", 10);
+        ASSERT(identifier && identifier->identifier.symbol == f_x, "");
+        identifier = resolve_record_find(&record, "x", 13);
+        ASSERT(identifier && identifier->identifier.symbol == class_x, "");
+        identifier = resolve_record_find(&record, "x", 15);
+        ASSERT(identifier && identifier->identifier.symbol == global_x, "");
+
+        // typing reads the bound symbol
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        identifier = resolve_record_find(&record, "x", 15);
+        ASSERT(identifier->static_type.type ==
+                       global_x->value.static_type.type,
+               (int)identifier->static_type.type);
+
+        scope_stack.destroy();
+        stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test scopes_snapshot_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "def f(a: int) -> int:\n"
+                "    return a\n"
+                "class C:\n"
+                "    x = 1\n"
+                "    y = 2.5\n"
+                "    def m(self):\n"
+                "        return 2\n"
+                "v = f(1)\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+
+        Arena out = Arena::init(MEGABYTES(64));
+        uint64_t size = serialize_scopes(tables.symbol_table, &main_scope, 1,
+                                         0x1234, &out);
+        ASSERT(size > sizeof(SerializedScopesHeader), size);
+        ASSERT(serialized_scopes_source_hash(out.memory, size) == 0x1234, "");
+
+        // loaded into tables that have never seen the stub
+        Arena loaded_ast_arena = Arena::init(GIGABYTES(1));
+        Arena loaded_symbol_arena = Arena::init(GIGABYTES(1));
+        Tables loaded_tables = Tables::init(&loaded_symbol_arena);
+        ASSERT(deserialize_scopes(out.memory, size, &loaded_ast_arena,
+                                  &loaded_symbol_arena,
+                                  loaded_tables.symbol_table),
+               "");
+
+        SymbolTableEntry *loaded_main =
+                loaded_tables.symbol_table->lookup(main_identifier, nullptr);
+        ASSERT(loaded_main, "");
+
+        std::string f = "f";
+        std::string v = "v";
+        std::string class_name = "C";
+        SymbolTableEntry *c_symbol =
+                tables.symbol_table->lookup(class_name, main_scope);
+        SymbolTableEntry *loaded_f =
+                loaded_tables.symbol_table->lookup(f, loaded_main);
+        SymbolTableEntry *loaded_v =
+                loaded_tables.symbol_table->lookup(v, loaded_main);
+        SymbolTableEntry *loaded_c =
+                loaded_tables.symbol_table->lookup(class_name, loaded_main);
+        ASSERT(loaded_f && loaded_v && loaded_c, "");
+        ASSERT(loaded_f->value.static_type.type == TypeInfoType::FUNCTION,
+               (int)loaded_f->value.static_type.type);
+        ASSERT(loaded_f->value.static_type.function.custom_symbol == loaded_f,
+               "");
+        ASSERT(loaded_v->value.static_type.type ==
+                       tables.symbol_table->lookup(v, main_scope)
+                               ->value.static_type.type,
+               (int)loaded_v->value.static_type.type);
+        ASSERT(loaded_f->value.node &&
+                       loaded_f->value.node->type == AstNodeType::FUNCTION_DEF,
+               "");
+
+        // members come back in the order they were declared
+        SymbolTableEntry *member =
+                tables.symbol_table->scope_symbols(c_symbol)->first;
+        SymbolTableEntry *loaded_member =
+                loaded_tables.symbol_table->scope_symbols(loaded_c)->first;
+        while (member && loaded_member) {
+                ASSERT(member->key.atom && loaded_member->key.atom, "");
+                ASSERT(strcmp(member->key.identifier,
+                              loaded_member->key.identifier) == 0,
+                       loaded_member->key.identifier);
+                ASSERT(member->value.static_type.type ==
+                               loaded_member->value.static_type.type,
+                       loaded_member->key.identifier);
+
+                member = member->next_in_scope;
+                loaded_member = loaded_member->next_in_scope;
+        }
+        ASSERT(!member && !loaded_member, "");
+
+        // a different schema is rejected
+        ((SerializedHeader *)out.memory)->schema_hash ^= 1;
+        ASSERT(!deserialize_scopes(out.memory, size, &loaded_ast_arena,
+                                   &loaded_symbol_arena,
+                                   loaded_tables.symbol_table),
+               "");
+
+        loaded_symbol_arena.destroy();
+        loaded_ast_arena.destroy();
+        out.destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test module_summary_test()
+{
+        START_TEST();
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        SymbolTableValue scope_value = {};
+        scope_value.static_type.type = TypeInfoType::INTEGER;
+        scope_value.node = &main_node;
+        SymbolTableEntry *module_scope = tables.symbol_table->insert(
+                &symbol_table_arena, "module", 0, &scope_value);
+
+        InputStream input_stream = input_stream_create_from_string(
+                "def f(a: int, d: int = 2) -> int:\n"
+                "    local = a\n"
+                "    return local\n"
+                "class C:\n"
+                "    x: int = 1\n"
+                "    def m(self, b: str) -> str:\n"
+                "        inner = b\n"
+                "        return inner\n"
+                "v: str = \"s\"\n");
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = module_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        scope_stack_push(&scope_stack, module_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        ASSERT(tables.diagnostics->count == 0, tables.diagnostics->count);
+
+        Arena out = Arena::init(MEGABYTES(64));
+        uint64_t scopes_size = serialize_scopes(tables.symbol_table,
+                                                &module_scope, 1, 0, &out);
+        uint64_t size = serialize_summary(tables.symbol_table, module_scope,
+                                          &out);
+        uint64_t second_size = serialize_summary(tables.symbol_table,
+                                                 module_scope, &out);
+        ASSERT(size < scopes_size, size);
+
+        // the same module always has the same summary
+        const char *summary = (const char *)out.memory + scopes_size;
+        ASSERT(second_size == size &&
+                       memcmp(summary, summary + size, size) == 0,
+               "");
+
+        // loaded next to builtins that are declared the same way
+        Arena loaded_ast_arena = Arena::init(GIGABYTES(1));
+        Arena loaded_symbol_arena = Arena::init(GIGABYTES(1));
+        Tables loaded_tables = Tables::init(&loaded_symbol_arena);
+        declare_test_builtins(&loaded_tables, &loaded_symbol_arena);
+
+        ASSERT(deserialize_scopes(summary, size, &loaded_ast_arena,
+                                  &loaded_symbol_arena,
+                                  loaded_tables.symbol_table),
+               "");
+
+        std::string module_name = "module";
+        SymbolTableEntry *loaded_module =
+                loaded_tables.symbol_table->lookup(module_name, nullptr);
+        ASSERT(loaded_module, "");
+
+        std::string f = "f";
+        std::string local = "local";
+        std::string class_name = "C";
+        std::string x = "x";
+        std::string m = "m";
+        std::string inner = "inner";
+        std::string v = "v";
+        SymbolTableEntry *loaded_f =
+                loaded_tables.symbol_table->lookup(f, loaded_module);
+        SymbolTableEntry *loaded_c =
+                loaded_tables.symbol_table->lookup(class_name, loaded_module);
+        SymbolTableEntry *loaded_v =
+                loaded_tables.symbol_table->lookup(v, loaded_module);
+        ASSERT(loaded_f && loaded_c && loaded_v, "");
+
+        // signatures without bodies
+        AstNode *function_def = loaded_f->value.node;
+        ASSERT(function_def->type == AstNodeType::FUNCTION_DEF, "");
+        ASSERT(!function_def->function_def.block, "");
+        ASSERT(function_def->function_def.arguments &&
+                       function_def->function_def.arguments->static_type.type ==
+                               TypeInfoType::INTEGER,
+               "");
+        ASSERT(!loaded_tables.symbol_table->lookup(local, loaded_f), "");
+        ASSERT(!loaded_c->value.node->class_def.block, "");
+        ASSERT(loaded_v->value.static_type.type == TypeInfoType::STRING,
+               (int)loaded_v->value.static_type.type);
+
+        // a value is only kept as there being one, d still has a default
+        AstNode *loaded_value = loaded_v->value.node->declaration.expression;
+        ASSERT(loaded_value && loaded_value->token.value == "", "");
+        CallSignature *loaded_signature =
+                loaded_tables.call_signatures->signature(
+                        loaded_tables.symbol_table, loaded_tables.type_interner,
+                        loaded_f);
+        ASSERT(loaded_signature && loaded_signature->parameter_count == 2,
+               "");
+        ASSERT(loaded_signature->required[0] == 1,
+               loaded_signature->required[0]);
+
+        // class members are kept, what the methods declare isn't
+        SymbolTableEntry *loaded_x =
+                loaded_tables.symbol_table->lookup(x, loaded_c);
+        SymbolTableEntry *loaded_m =
+                loaded_tables.symbol_table->lookup(m, loaded_c);
+        ASSERT(loaded_x && loaded_m, "");
+        ASSERT(loaded_m->value.static_type.type == TypeInfoType::FUNCTION,
+               (int)loaded_m->value.static_type.type);
+        ASSERT(!loaded_tables.symbol_table->lookup(inner, loaded_m), "");
+
+        loaded_tables.call_signatures->destroy();
+        loaded_symbol_arena.destroy();
+        loaded_ast_arena.destroy();
+        out.destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test module_registry_test()
+{
+        START_TEST();
+        ModuleRegistry registry = ModuleRegistry::init(0);
+        Arena module_arena = Arena::init(MEGABYTES(64));
+        Module **modules = (Module **)module_arena.alloc(1000 * sizeof(Module *));
+
+        for (int i = 0; i < 1000; ++i) {
+                modules[i] = (Module *)module_arena.alloc(sizeof(Module));
+                new (modules[i]) Module();
+                modules[i]->name = "package.module" + std::to_string(i);
+                modules[i]->name_hash = atom_hash(modules[i]->name.c_str(),
+                                                  modules[i]->name.size());
+                registry.insert(modules[i]);
+        }
+
+        ASSERT(registry.count == 1000, registry.count);
+        ASSERT(registry.count * 2 <= registry.capacity, registry.capacity);
+
+        for (int i = 0; i < 1000; ++i) {
+                std::string name = "package.module" + std::to_string(i);
+                ASSERT(registry.find(name, atom_hash(name.c_str(), name.size())) ==
+                               modules[i],
+                       i);
+        }
+
+        std::string missing = "package.module1000";
+        ASSERT(!registry.find(missing, atom_hash(missing.c_str(),
+                                                 missing.size())),
+               "");
+
+        // imports are registered by their dotted name, once
+        InputStream input_stream = input_stream_create_from_string(
+                "import a.b.c\n"
+                "import sys\n"
+                "import a.b.c as d\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+        ASSERT(tables.import_list->list_index == 3,
+               tables.import_list->list_index);
+
+        PythonPath path = {};
+        path.file_part = path.path_buffer;
+        Pipeline *pipeline = Pipeline::create(&ast_arena, &tables,
+                                              &symbol_table_arena, main_scope,
+                                              &main_node, &path, 1);
+        Module *sys = pipeline->add_loaded("sys", main_scope);
+        ASSERT(sys->state == ModuleState::TYPED, "");
+
+        Module *abc = pipeline_submit_import(pipeline,
+                                             tables.import_list->list[0]);
+        ASSERT(abc->name == "a.b.c", abc->name.c_str());
+        ASSERT(abc->state == ModuleState::PENDING, "");
+        ASSERT(pipeline_submit_import(pipeline, tables.import_list->list[1]) ==
+                       sys,
+               "");
+        ASSERT(pipeline_submit_import(pipeline, tables.import_list->list[2]) ==
+                       abc,
+               "");
+        ASSERT(pipeline->module_count == 1, pipeline->module_count);
+
+        pipeline->destroy();
+        tables.import_list->destroy();
+        symbol_table_arena.destroy();
+        ast_arena.destroy();
+        module_arena.destroy();
+        registry.destroy();
+
+        END_TEST();
+}
+
+static void add_import(Module *module, Module *imported)
+{
+        module->imports[module->import_count++] = imported;
+}
+
+// the pipeline tests run on modules written here, imports are looked up
+// next to them
+#define TEST_MODULE_DIRECTORY "tests/pipeline/"
+
+static void write_test_module(const char *name, const char *source)
+{
+        CreateDirectoryA(TEST_MODULE_DIRECTORY, 0);
+
+        char filename[256];
+        snprintf(filename, sizeof(filename), TEST_MODULE_DIRECTORY "%s.py",
+                 name);
+
+        FILE *file = nullptr;
+        fopen_s(&file, filename, "wb");
+        fwrite(source, 1, strlen(source), file);
+        fclose(file);
+}
+
+static void remove_test_module(const char *name)
+{
+        char filename[256];
+        snprintf(filename, sizeof(filename), TEST_MODULE_DIRECTORY "%s.py",
+                 name);
+        remove(filename);
+}
+
+static void test_module_path(PythonPath *path)
+{
+        strncpy_s(path->path_buffer, sizeof(path->path_buffer),
+                  TEST_MODULE_DIRECTORY, strlen(TEST_MODULE_DIRECTORY));
+        path->file_part = path->path_buffer + strlen(TEST_MODULE_DIRECTORY);
+        path->length_from_file_part =
+                path->path_buffer + sizeof(path->path_buffer) - path->file_part;
+}
+
+static Module *find_test_module(Pipeline *pipeline, const char *name)
+{
+        for (uint32_t i = 0; i < pipeline->module_count; ++i) {
+                if (pipeline->modules[i]->name == name)
+                        return pipeline->modules[i];
+        }
+
+        return nullptr;
+}
+
+static Test wave_schedule_test()
+{
+        START_TEST();
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        std::string main_identifier = "main";
+        SymbolTableEntry *main_scope = tables.symbol_table->insert(
+                &symbol_table_arena, main_identifier, 0, &main_symbol_value);
+
+        PythonPath path = {};
+        path.file_part = path.path_buffer;
+        Pipeline *pipeline = Pipeline::create(&ast_arena, &tables,
+                                              &symbol_table_arena, main_scope,
+                                              &main_node, &path, 1);
+        Module *sys = pipeline->add_loaded("sys", main_scope);
+
+        // 0 <- 1 <- 3 <-> 2 <- 4 then a chain importing 4
+        const uint32_t chain_length = 3000;
+        const uint32_t module_count = 5 + chain_length;
+        Module *modules[module_count];
+        for (uint32_t i = 0; i < module_count; ++i) {
+                std::string name = "m" + std::to_string(i);
+                modules[i] = pipeline->submit(name, name.c_str(), main_scope);
+                modules[i]->imports =
+                        (Module **)ast_arena.alloc(2 * sizeof(Module *));
+        }
+
+        add_import(modules[1], modules[0]);
+        add_import(modules[2], modules[3]);
+        add_import(modules[3], modules[2]);
+        add_import(modules[3], modules[1]);
+        add_import(modules[4], modules[2]);
+        add_import(modules[4], sys);
+        for (uint32_t i = 5; i < module_count; ++i) {
+                add_import(modules[i], modules[i - 1]);
+        }
+
+        WaveSchedule *schedule = &pipeline->schedule;
+
+        // typed while the modules importing it are still being parsed
+        pipeline_module_parsed(pipeline, modules[0]);
+        ASSERT(schedule->released == 1, schedule->released);
+        ASSERT(pipeline_next_module_to_type(pipeline) == modules[0], "");
+
+        // 2 waits for 3 to be parsed, 1 for 0 to be summarised
+        pipeline_module_parsed(pipeline, modules[2]);
+        pipeline_module_parsed(pipeline, modules[1]);
+        ASSERT(!modules[2]->scheduled && modules[1]->scheduled, "");
+        ASSERT(schedule->next == schedule->released, "");
+        pipeline_module_parsed(pipeline, modules[3]);
+        ASSERT(modules[2]->scheduled && modules[3]->scheduled, "");
+
+        // the chain's importers first so the last one parsed completes it
+        for (uint32_t i = module_count - 1; i >= 4; --i) {
+                pipeline_module_parsed(pipeline, modules[i]);
+                ASSERT(modules[i]->scheduled == (i == 4), i);
+        }
+
+        uint32_t expected_waves[] = {0, 1, 2, 2, 3};
+        for (int i = 0; i < array_count(expected_waves); ++i) {
+                ASSERT(modules[i]->wave == expected_waves[i], i);
+        }
+        for (uint32_t i = 5; i < module_count; ++i) {
+                ASSERT(modules[i]->scheduled && modules[i]->wave == i - 1, i);
+        }
+        ASSERT(schedule->pending.offset == 0, schedule->pending.offset);
+
+        // the cycle is released together once what it imports is typed
+        ASSERT(schedule->next == schedule->released, "");
+        pipeline_module_summarised(pipeline, modules[0]);
+        ASSERT(pipeline_next_module_to_type(pipeline) == modules[1], "");
+        pipeline_module_summarised(pipeline, modules[1]);
+        ASSERT(schedule->released - schedule->next == 2,
+               schedule->released - schedule->next);
+
+        pipeline->destroy();
+        symbol_table_arena.destroy();
+        ast_arena.destroy();
+
+        END_TEST();
+}
+
+// each module is handed to a type worker only once the ones it imports
+// are typed, the type worker asserts it too
+static Test pipeline_order_test()
+{
+        START_TEST();
+        write_test_module("order_c", "base: int = 1\n");
+        write_test_module("order_b", "import order_c\n"
+                                     "value: int = 2\n");
+        write_test_module("order_a", "import order_b\n"
+                                     "total: int = 3\n"
+                                     "wrong: str = 4\n");
+
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        PythonPath path = {};
+        test_module_path(&path);
+        Pipeline *pipeline = Pipeline::create(&ast_arena, &tables,
+                                              &symbol_table_arena, main_scope,
+                                              &main_node, &path, 2);
+        const char *input = TEST_MODULE_DIRECTORY "order_a.py";
+        Module *a = pipeline->submit(input, input, main_scope);
+        pipeline->run();
+
+        Module *b = find_test_module(pipeline, "order_b");
+        Module *c = find_test_module(pipeline, "order_c");
+        ASSERT(pipeline->module_count == 3, pipeline->module_count);
+        ASSERT(b && c, "");
+        ASSERT(c->wave < b->wave && b->wave < a->wave, b->wave);
+        ASSERT(a->state == ModuleState::TYPED &&
+                       b->state == ModuleState::TYPED &&
+                       c->state == ModuleState::TYPED,
+               "");
+        ASSERT(a->summarised && b->summarised && c->summarised, "");
+
+        Module **order = pipeline->schedule.order;
+        ASSERT(order[0] == c && order[1] == b && order[2] == a, "");
+
+        ASSERT(tables.diagnostics->count == 1, tables.diagnostics->count);
+        Diagnostic *diagnostic =
+                (Diagnostic *)tables.diagnostics->entries.memory;
+        ASSERT(diagnostic->line == 3, diagnostic->message);
+
+        pipeline->destroy();
+        symbol_table_arena.destroy();
+        ast_arena.destroy();
+        remove_test_module("order_a");
+        remove_test_module("order_b");
+        remove_test_module("order_c");
+
+        END_TEST();
+}
+
+// An imported module's tree is released once its bodies are checked, what
+// imports it reads the summary declared in its place. The checked modules,
+// the ones typed on demand and the members of an import cycle keep theirs
+static Test pipeline_release_test()
+{
+        START_TEST();
+        write_test_module("release_lib", "class Box:\n"
+                                         "    size: int = 1\n"
+                                         "def make(a: int) -> int:\n"
+                                         "    return a\n");
+        write_test_module("release_cycle_a", "import release_cycle_b\n"
+                                             "a: int = 1\n");
+        write_test_module("release_cycle_b", "import release_cycle_a\n"
+                                             "b: int = 2\n");
+        write_test_module("release_main", "import release_lib\n"
+                                          "import release_cycle_a\n"
+                                          "total: int = 3\n");
+        const char *input = TEST_MODULE_DIRECTORY "release_main.py";
+
+        for (int lazy = 0; lazy < 2; ++lazy) {
+                Arena ast_arena = Arena::init(GIGABYTES(2));
+                Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+                Tables tables = Tables::init(&symbol_table_arena);
+                SymbolTableEntry *main_scope =
+                        declare_test_builtins(&tables, &symbol_table_arena);
+
+                PythonPath path = {};
+                test_module_path(&path);
+                Pipeline *pipeline = Pipeline::create(
+                        &ast_arena, &tables, &symbol_table_arena, main_scope,
+                        &main_node, &path, 2);
+                pipeline->lazy = lazy;
+                Module *checked = pipeline->submit(input, input, main_scope);
+                pipeline->run();
+
+                Module *lib = find_test_module(pipeline, "release_lib");
+                Module *cycle_a = find_test_module(pipeline, "release_cycle_a");
+                Module *cycle_b = find_test_module(pipeline, "release_cycle_b");
+                ASSERT(lib && cycle_a && cycle_b, lazy);
+                ASSERT(tables.diagnostics->count == 0,
+                       tables.diagnostics->count);
+                ASSERT(lib->state == ModuleState::TYPED, lazy);
+
+                ASSERT(checked->arena.memory && checked->root, lazy);
+                ASSERT(cycle_a->arena.memory && cycle_a->root, lazy);
+                ASSERT(cycle_b->arena.memory && cycle_b->root, lazy);
+
+                if (lazy) {
+                        ASSERT(lib->lazy && lib->arena.memory && lib->root, "");
+                        ASSERT(!lib->summary_arena.memory, "");
+                } else {
+                        ASSERT(!lib->arena.memory && !lib->root, "");
+                        ASSERT(lib->summary_arena.memory, "");
+
+                        std::string make_name = "make";
+                        SymbolTableEntry *make = tables.symbol_table->lookup(
+                                make_name, lib->scope);
+                        ASSERT(make && arena_contains(&lib->summary_arena,
+                                                      make->value.node),
+                               "");
+
+                        // typed the way an importer typed on demand would
+                        InputStream input_stream =
+                                input_stream_create_from_string(
+                                        "import release_lib\n"
+                                        "size: int = release_lib.Box.size\n"
+                                        "release_lib.make(1)\n"
+                                        "wrong: str = release_lib.Box.size\n");
+                        TokenArray token_array =
+                                token_array_create_from_input_stream(
+                                        &ast_arena, &input_stream);
+
+                        Parser parser = {};
+                        parser.token_arr = &token_array;
+                        parser.tables = &tables;
+                        parser.symbol_table_arena = &symbol_table_arena;
+                        parser.ast_arena = &ast_arena;
+                        parser.scope = main_scope;
+                        ParseResult result = parse_statements(&parser);
+                        ASSERT(result.error.type == ParseErrorType::NONE, "");
+                        tables.import_list->list[0]->import_target.module =
+                                lib->scope;
+
+                        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+                        scope_stack_push(&scope_stack, main_scope);
+                        type_parse_tree(result.node, &ast_arena, &scope_stack,
+                                        &tables, "tests");
+                        scope_stack.destroy();
+
+                        // a call is typed as the function's signature
+                        AstNode *call = result.node->block.children
+                                                ->adjacent_child->adjacent_child;
+                        ASSERT(call->type == AstNodeType::FUNCTION_CALL,
+                               (int)call->type);
+                        TypeInfo call_type = call->static_type;
+                        ASSERT(call_type.type == TypeInfoType::FUNCTION &&
+                                       call_type.function.return_type->type ==
+                                               TypeInfoType::INTEGER,
+                               (int)call_type.type);
+
+                        // only wrong's
+                        ASSERT(tables.diagnostics->count == 1,
+                               tables.diagnostics->count);
+                        Diagnostic *diagnostic =
+                                (Diagnostic *)tables.diagnostics->entries.memory;
+                        ASSERT(diagnostic->line == 4, diagnostic->message);
+                }
+
+                pipeline->destroy();
+                symbol_table_arena.destroy();
+                ast_arena.destroy();
+        }
+
+        remove_test_module("release_lib");
+        remove_test_module("release_cycle_a");
+        remove_test_module("release_cycle_b");
+        remove_test_module("release_main");
+
+        END_TEST();
+}
+
+static Test type_interner_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "a: list[int] = [1]\n"
+                "b: list[int] = [2, 3]\n"
+                "c: dict[str, list[int]] = {\"k\": [4]}\n"
+                "d: list[int | str] = [1, \"s\"]\n"
+                "e: list[int | str] = [\"t\", 2]\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        TypeInterner *interner = tables.type_interner;
+
+        // builtins come first so their ids follow TypeInfoType
+        for (int i = 0; i < (int)TypeInfoType::SIZE; ++i) {
+                ASSERT(interner->id_of(&tables.builtin_types[i]) ==
+                               (TypeId)i + 1,
+                       i);
+        }
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        ASSERT(tables.diagnostics->count == 0, tables.diagnostics->count);
+
+        const char *names[] = {"a", "b", "c", "d", "e"};
+        TypeInfo types[array_count(names)];
+        for (int i = 0; i < array_count(names); ++i) {
+                std::string name = names[i];
+                SymbolTableEntry *entry =
+                        tables.symbol_table->lookup(name, main_scope);
+                ASSERT(entry, names[i]);
+                types[i] = entry->value.static_type;
+        }
+
+        // list[int] is one type wherever it's written
+        TypeInfo *list_of_int = interner->intern(&types[0]);
+        TypeInfo *int_type = &tables.builtin_types[(int)TypeInfoType::INTEGER];
+        ASSERT(types[0].type == TypeInfoType::LIST, "");
+        ASSERT(types[0].list.item_type == int_type, "");
+        ASSERT(interner->intern(&types[1]) == list_of_int, "");
+        ASSERT(types[2].dict.val_type == list_of_int, "");
+        ASSERT(types[2].dict.key_type ==
+                       &tables.builtin_types[(int)TypeInfoType::STRING],
+               "");
+        ASSERT(types[3].list.item_type->type == TypeInfoType::UNION, "");
+        ASSERT(types[3].list.item_type == types[4].list.item_type, "");
+
+        // as is the union built for a display of the same literals
+        Arena stack = Arena::init(MEGABYTES(1));
+        TypeInfo *display_types[2] = {};
+        AstNode *statement = result.node->file.children;
+        for (int i = 0; statement; ++i, statement = statement->adjacent_child) {
+                if (i < 3)
+                        continue;
+
+                TraversalRecord record = {};
+                ast_visit(statement, &stack, traversal_record_visit, &record);
+                ASSERT(record.count <= array_count(record.nodes), record.count);
+                for (uint32_t j = 0; j < record.count; ++j) {
+                        if (record.nodes[j]->type == AstNodeType::LIST)
+                                display_types[i - 3] =
+                                        record.nodes[j]->static_type.list.item_type;
+                }
+        }
+
+        ASSERT(display_types[0] && display_types[1], "");
+        ASSERT(display_types[0]->type == TypeInfoType::UNION, "");
+        ASSERT(display_types[0] == display_types[1], "");
+        ASSERT(interner->id_of(display_types[0]), "");
+
+        TypeInfo copy = *list_of_int;
+        ASSERT(interner->intern(&copy) == list_of_int, "");
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, types[0], types[1]), "");
+
+        stack.destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static TypeInfo *union_of(TypeInterner *interner, TypeInfo *left,
+                          TypeInfo *right)
+{
+        TypeInfo union_type = {};
+        union_type.type = TypeInfoType::UNION;
+        union_type.union_type.left = left;
+        union_type.union_type.right = right;
+        return interner->intern(&union_type);
+}
+
+static Test union_set_test()
+{
+        START_TEST();
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        TypeInterner *interner = tables.type_interner;
+        TypeInfo *builtins = tables.builtin_types;
+        TypeInfo *integer = &builtins[(int)TypeInfoType::INTEGER];
+        TypeInfo *string = &builtins[(int)TypeInfoType::STRING];
+        TypeInfo *floating = &builtins[(int)TypeInfoType::FLOAT];
+
+        // the order members are written in doesn't matter
+        TypeInfo *int_str = union_of(interner, integer, string);
+        ASSERT(int_str->type == TypeInfoType::UNION, "");
+        ASSERT(union_of(interner, string, integer) == int_str, "");
+        ASSERT(union_of(interner, int_str, integer) == int_str, "");
+
+        // nor does how they're nested
+        TypeInfo *int_str_float = union_of(interner, int_str, floating);
+        ASSERT(union_of(interner, integer, union_of(interner, floating, string)) ==
+                       int_str_float,
+               "");
+
+        // a union of one type is that type
+        ASSERT(union_of(interner, integer, integer) == integer, "");
+
+        TypeInfo list_type = {};
+        list_type.type = TypeInfoType::LIST;
+        list_type.list.item_type = integer;
+        TypeInfo *list_of_int = interner->intern(&list_type);
+        list_type.list.item_type = string;
+        TypeInfo *list_of_str = interner->intern(&list_type);
+        TypeInfo *lists = union_of(interner, list_of_int, list_of_str);
+        ASSERT(union_of(interner, list_of_str, list_of_int) == lists, "");
+        UnionSet *set = interner->union_set(interner->id_of(lists));
+        ASSERT(set->member_count == 2 && !set->primitive_types,
+               set->member_count);
+
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, *int_str_float, *int_str),
+               "");
+        ASSERT(!static_types_is_rhs_equal_lhs(&tables, *int_str, *int_str_float),
+               "");
+        ASSERT(!static_types_is_rhs_equal_lhs(&tables, *lists, *int_str), "");
+
+        // unions aren't limited in how many members they have
+        TypeInfo *wide = integer;
+        TypeInfo *previous = integer;
+        for (int i = 0; i < 300; ++i) {
+                list_type.list.item_type = previous;
+                previous = interner->intern(&list_type);
+                wide = union_of(interner, wide, previous);
+        }
+        set = interner->union_set(interner->id_of(wide));
+        ASSERT(set->member_count == 300, set->member_count);
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, *wide, *wide), "");
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, *wide,
+                                             *union_of(interner, previous,
+                                                       integer)),
+               "");
+
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test subtype_cache_test()
+{
+        START_TEST();
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        TypeInterner *interner = tables.type_interner;
+        SubtypeCache *cache = tables.subtype_cache;
+        TypeInfo *builtins = tables.builtin_types;
+
+        // dict[str, list[int | str]]
+        TypeInfo *int_str = union_of(interner,
+                                     &builtins[(int)TypeInfoType::INTEGER],
+                                     &builtins[(int)TypeInfoType::STRING]);
+        TypeInfo list_type = {};
+        list_type.type = TypeInfoType::LIST;
+        list_type.list.item_type = int_str;
+        TypeInfo dict_type = {};
+        dict_type.type = TypeInfoType::DICT;
+        dict_type.dict.key_type = &builtins[(int)TypeInfoType::STRING];
+        dict_type.dict.val_type = interner->intern(&list_type);
+        TypeInfo *dict = interner->intern(&dict_type);
+
+        // list[int]
+        list_type.list.item_type = &builtins[(int)TypeInfoType::INTEGER];
+        TypeInfo *list_of_int = interner->intern(&list_type);
+
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, *dict, *dict), "");
+        LONG misses = cache->misses;
+        for (int i = 0; i < 10; ++i) {
+                ASSERT(static_types_is_rhs_equal_lhs(&tables, *dict, *dict), i);
+        }
+        ASSERT(cache->misses == misses, cache->misses);
+        ASSERT(cache->hits >= 10, cache->hits);
+
+        // failed comparisons are remembered too
+        TypeInfo *list_of_int_str = dict_type.dict.val_type;
+        ASSERT(!static_types_is_rhs_equal_lhs(&tables, *list_of_int_str,
+                                              *list_of_int),
+               "");
+        bool result = true;
+        ASSERT(cache->find(interner->id_of(list_of_int_str),
+                           interner->id_of(list_of_int), &result),
+               "");
+        ASSERT(!result, "");
+
+        // types that aren't interned are still compared
+        TypeInfo loose = {};
+        loose.type = TypeInfoType::LIST;
+        loose.list.item_type = &list_type;
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, loose, loose), "");
+
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test class_hierarchy_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "class A:\n"
+                "    x: int = 1\n"
+                "class B(A):\n"
+                "    y: int = 2\n"
+                "class C(A):\n"
+                "    x: str = \"c\"\n"
+                "class D(B, C):\n"
+                "    z: int = 3\n"
+                "class E(A, B):\n"
+                "    w: int = 4\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        ClassHierarchy *hierarchy = tables.class_hierarchy;
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+
+        // only E has no consistent order, A can't come before B
+        ASSERT(tables.diagnostics->count == 1, tables.diagnostics->count);
+
+        const char *names[] = {"A", "B", "C", "D", "E"};
+        SymbolTableEntry *classes[array_count(names)];
+        for (int i = 0; i < array_count(names); ++i) {
+                std::string name = names[i];
+                classes[i] = tables.symbol_table->lookup(name, main_scope);
+                ASSERT(classes[i], names[i]);
+        }
+        SymbolTableEntry *a = classes[0];
+        SymbolTableEntry *b = classes[1];
+        SymbolTableEntry *c = classes[2];
+        SymbolTableEntry *d = classes[3];
+
+        ClassInfo *d_info = hierarchy->info(d);
+        ASSERT(d_info && !d_info->inconsistent, "");
+        SymbolTableEntry *expected_mro[] = {d, b, c, a};
+        ASSERT(d_info->mro_count == array_count(expected_mro),
+               d_info->mro_count);
+        for (int i = 0; i < array_count(expected_mro); ++i) {
+                ASSERT(d_info->mro[i] == expected_mro[i], i);
+        }
+        ASSERT(hierarchy->info(classes[4])->inconsistent, "");
+
+        ASSERT(hierarchy->is_subclass(d, a), "");
+        ASSERT(hierarchy->is_subclass(d, c), "");
+        ASSERT(hierarchy->is_subclass(b, a), "");
+        ASSERT(!hierarchy->is_subclass(a, d), "");
+        ASSERT(!hierarchy->is_subclass(b, c), "");
+
+        // C comes before A in D's mro so its x is the one found
+        std::string x = "x";
+        std::string y = "y";
+        std::string missing = "missing";
+        SymbolTableEntry *d_x = hierarchy->lookup_member(tables.symbol_table,
+                                                         x, d);
+        ASSERT(d_x && d_x->key.scope == c, "");
+        SymbolTableEntry *d_y = hierarchy->lookup_member(tables.symbol_table,
+                                                         y, d);
+        ASSERT(d_y && d_y->key.scope == b, "");
+        ASSERT(!hierarchy->lookup_member(tables.symbol_table, y, a), "");
+        ASSERT(!hierarchy->lookup_member(tables.symbol_table, missing, d), "");
+
+        TypeInfo a_type = a->value.static_type;
+        TypeInfo d_type = d->value.static_type;
+        ASSERT(static_types_is_rhs_equal_lhs(&tables, a_type, d_type), "");
+        ASSERT(!static_types_is_rhs_equal_lhs(&tables, d_type, a_type), "");
+
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+// A class bound before its bases are typed, say while its module's import
+// cycle is typed, is bound again once they are. A class deriving from one
+// with an unknown base has an unknown base too
+static Test class_hierarchy_rebind_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "class A:\n"
+                "    x: int = 1\n"
+                "class B(A):\n"
+                "    y: int = 2\n"
+                "class C(B):\n"
+                "    z: int = 3\n"
+                "n: int = 1\n"
+                "class D(n):\n"
+                "    w: int = 4\n"
+                "class E(D):\n"
+                "    v: int = 5\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        ClassHierarchy *hierarchy = tables.class_hierarchy;
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        const char *names[] = {"A", "B", "C", "D", "E"};
+        SymbolTableEntry *classes[array_count(names)];
+        for (int i = 0; i < array_count(names); ++i) {
+                std::string name = names[i];
+                classes[i] = tables.symbol_table->lookup(name, main_scope);
+                ASSERT(classes[i], names[i]);
+        }
+        SymbolTableEntry *a = classes[0];
+        SymbolTableEntry *b = classes[1];
+        SymbolTableEntry *c = classes[2];
+        SymbolTableEntry *e = classes[4];
+
+        // nothing is typed yet so every base is unknown
+        ClassInfo *early_c = hierarchy->info(c);
+        ASSERT(early_c && early_c->unknown_base && early_c->mro_count == 1, "");
+        ASSERT(hierarchy->is_subclass(b, c), "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        ASSERT(tables.diagnostics->count == 0, tables.diagnostics->count);
+
+        ClassInfo *c_info = hierarchy->info(c);
+        ASSERT(c_info != early_c && !c_info->unknown_base, "");
+        SymbolTableEntry *expected_mro[] = {c, b, a};
+        ASSERT(c_info->mro_count == array_count(expected_mro),
+               c_info->mro_count);
+        for (int i = 0; i < array_count(expected_mro); ++i) {
+                ASSERT(c_info->mro[i] == expected_mro[i], i);
+        }
+        ASSERT(hierarchy->info(c) == c_info, "");
+
+        // whoever still holds the early info reads it unchanged
+        ASSERT(early_c->mro_count == 1, early_c->mro_count);
+
+        ASSERT(hierarchy->is_subclass(c, a), "");
+        ASSERT(!hierarchy->is_subclass(b, c), "");
+        ASSERT(!hierarchy->is_subclass(a, b), "");
+
+        std::string x = "x";
+        SymbolTableEntry *c_x = hierarchy->lookup_member(tables.symbol_table,
+                                                         x, c);
+        ASSERT(c_x && c_x->key.scope == a, "");
+
+        // n is never a class, E only knows of it through D
+        ClassInfo *e_info = hierarchy->info(e);
+        ASSERT(e_info && e_info->unknown_base && e_info->mro_count == 2,
+               e_info->mro_count);
+        ASSERT(hierarchy->info(e) == e_info, "");
+        ASSERT(hierarchy->is_subclass(e, a), "");
+
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test call_signature_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "def f(a: int, /, b: str, c: int = 1, *, d: int, e: str = \"e\"):\n"
+                "    return a\n"
+                "class K:\n"
+                "    def __init__(self, x: int):\n"
+                "        self.x = x\n"
+                "f(1, \"b\", d=2)\n"
+                "f(1, b=\"b\", c=2, d=3, e=\"x\")\n"
+                "f(a=1, b=\"b\", d=2)\n"
+                "f(1, \"b\", 2, 3)\n"
+                "f(1, \"b\", d=\"s\")\n"
+                "f(1, \"b\", b=\"c\", d=2)\n"
+                "f(1, \"b\", d=2, z=3)\n"
+                "K(1)\n"
+                "K()\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+
+        // a by keyword and missing, one positional too many and d missing,
+        // then one each for the type, b given twice, z and K's x
+        ASSERT(tables.diagnostics->count == 8, tables.diagnostics->count);
+
+        std::string f = "f";
+        SymbolTableEntry *function = tables.symbol_table->lookup(f, main_scope);
+        CallSignature *signature = function->call_signature;
+        ASSERT(signature, "");
+        ASSERT(signature->parameter_count == 5, signature->parameter_count);
+        ASSERT(signature->positional_only_count == 1,
+               signature->positional_only_count);
+        ASSERT(signature->keyword_only_index == 3,
+               signature->keyword_only_index);
+        // a, b and d have no default
+        ASSERT(signature->required[0] == 0xb, signature->required[0]);
+        ASSERT(!signature->method && !signature->star &&
+                       !signature->double_star,
+               "");
+        ASSERT(signature->parameter_types[4]->type == TypeInfoType::STRING,
+               debug_static_type_to_string(*signature->parameter_types[4]));
+
+        std::string e = "e";
+        std::string k = "K";
+        ASSERT(signature->keyword_index(tables.symbol_table->find_atom(e)) ==
+                       4,
+               "");
+        ASSERT(signature->keyword_index(tables.symbol_table->find_atom(k)) ==
+                       UINT32_MAX,
+               "");
+        ASSERT(tables.call_signatures->signature(tables.symbol_table,
+                                                 tables.type_interner,
+                                                 function) == signature,
+               "");
+
+        std::string init = "__init__";
+        SymbolTableEntry *k_class = tables.symbol_table->lookup(k, main_scope);
+        SymbolTableEntry *k_init =
+                tables.symbol_table->lookup_member(init, k_class);
+        ASSERT(k_init && k_init->call_signature &&
+                       k_init->call_signature->method,
+               "");
+        ASSERT(tables.call_signatures->count == 2,
+               tables.call_signatures->count);
+
+        tables.diagnostics->destroy();
+        tables.call_signatures->destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+// Calling something that isn't callable is reported with its type and the
+// call typed as returning ANY, a subscript is called through the item type
+static Test call_not_callable_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "xs: list[int] = [1]\n"
+                "xs[0]()\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+
+        ASSERT(tables.diagnostics->count == 1, tables.diagnostics->count);
+        Diagnostic *diagnostic =
+                (Diagnostic *)tables.diagnostics->entries.memory;
+        ASSERT(diagnostic->line == 2, diagnostic->message);
+        ASSERT(strcmp(diagnostic->message,
+                      "Object of type INTEGER is not callable") == 0,
+               diagnostic->message);
+
+        AstNode *call = result.node->nary.children->adjacent_child;
+        ASSERT(call->type == AstNodeType::FUNCTION_CALL,
+               debug_enum_to_string(AstNodeTypeEnumMembers, (int)call->type));
+        ASSERT(call->static_type.type == TypeInfoType::FUNCTION &&
+                       call->static_type.function.return_type->type ==
+                               TypeInfoType::ANY,
+               "");
+
+        tables.diagnostics->destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test two_phase_typing_test()
+{
+        START_TEST();
+        InputStream input_stream = input_stream_create_from_string(
+                "def first(a: int) -> int:\n"
+                "    second(a, \"s\")\n"
+                "    second(a, a)\n"
+                "    return a\n"
+                "class Foo:\n"
+                "    def method(self, b: str) -> str:\n"
+                "        return b\n"
+                "def second(a: int, b: str) -> int:\n"
+                "    return a\n");
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+
+        // every signature is known before any body is typed
+        type_signatures(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        std::string second_name = "second";
+        SymbolTableEntry *second =
+                tables.symbol_table->lookup(second_name, main_scope);
+        ASSERT(second, "");
+        TypeInfo *second_return = second->value.static_type.function.return_type;
+        ASSERT(second_return && second_return->type == TypeInfoType::INTEGER,
+               "");
+
+        Arena deferred_bodies = Arena::init(MEGABYTES(1));
+        tables.deferred_bodies = &deferred_bodies;
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        tables.deferred_bodies = nullptr;
+
+        // the method is deferred along with the functions
+        uint64_t deferred_count = deferred_bodies.offset / sizeof(DeferredBody);
+        ASSERT(deferred_count == 3, deferred_count);
+
+        // typed last to first, the order they run in doesn't matter
+        DeferredBody *deferred = (DeferredBody *)deferred_bodies.memory;
+        for (uint64_t i = deferred_count; i > 0; --i) {
+                DeferredBody *body = &deferred[i - 1];
+                scope_stack.clear();
+                scope_stack_push(&scope_stack, main_scope);
+                if (body->scope != main_scope) {
+                        scope_stack_push(&scope_stack, body->scope);
+                }
+
+                type_parse_tree(body->function_def, &ast_arena, &scope_stack,
+                                &tables, "tests");
+        }
+
+        // only the call passing an int for second's str parameter
+        ASSERT(tables.diagnostics->count == 1, tables.diagnostics->count);
+        Diagnostic *diagnostic = (Diagnostic *)tables.diagnostics->entries.memory;
+        ASSERT(diagnostic->line == 3, diagnostic->message);
+        ASSERT(deferred[0].function_def->function_def.block->static_type.type ==
+                       TypeInfoType::INTEGER,
+               "");
+
+        deferred_bodies.destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static Test lazy_declaration_test()
+{
+        START_TEST();
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        SymbolTableValue main_symbol_value = {};
+        main_symbol_value.static_type.type = TypeInfoType::INTEGER;
+        main_symbol_value.node = &main_node;
+
+        SymbolTableEntry *library_scope = tables.symbol_table->insert(
+                &symbol_table_arena, "library", 0, &main_symbol_value);
+
+        // nothing here is typed unless the checked module reaches it, the
+        // bad annotations and initial value are never looked at
+        InputStream library_stream = input_stream_create_from_string(
+                "class Base:\n"
+                "    count: int = 0\n"
+                "class Foo(Base):\n"
+                "    def method(self, a: Missing) -> int:\n"
+                "        return a\n"
+                "def unused(a: Missing) -> int:\n"
+                "    return a\n"
+                "name: str = 1\n");
+        TokenArray library_tokens = token_array_create_from_input_stream(
+                &ast_arena, &library_stream);
+
+        Parser parser = {};
+        parser.token_arr = &library_tokens;
+        parser.tables = &tables;
+        parser.symbol_table_arena = &symbol_table_arena;
+        parser.ast_arena = &ast_arena;
+        parser.scope = library_scope;
+
+        ParseResult library = parse_statements(&parser);
+        ASSERT(library.error.type == ParseErrorType::NONE, "");
+
+        declare_lazily(library.node, library_scope, &ast_arena, &tables,
+                       "library");
+        tables.lazy_declarations->builtins = main_scope;
+        ASSERT(tables.lazy_declarations->declared == 6,
+               tables.lazy_declarations->declared);
+
+        InputStream input_stream = input_stream_create_from_string(
+                "import library\n"
+                "x: int = library.Foo.count\n"
+                "y: str = library.name\n");
+        TokenArray token_array =
+                token_array_create_from_input_stream(&ast_arena, &input_stream);
+        parser.token_arr = &token_array;
+        parser.scope = main_scope;
+
+        ParseResult result = parse_statements(&parser);
+        ASSERT(result.error.type == ParseErrorType::NONE, "");
+
+        // bound the way the pipeline binds an import of a lazy module
+        ASSERT(tables.import_list->list_index == 1,
+               tables.import_list->list_index);
+        tables.import_list->list[0]->import_target.module = library_scope;
+
+        Arena scope_stack = Arena::init(sizeof(void *) * 1000);
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+
+        ASSERT(tables.diagnostics->count == 0, tables.diagnostics->count);
+        // Foo, its base, the member found through it and name
+        ASSERT(tables.lazy_declarations->typed == 4,
+               tables.lazy_declarations->typed);
+
+        std::string foo_name = "Foo";
+        SymbolTableEntry *foo =
+                tables.symbol_table->lookup(foo_name, library_scope);
+        ClassInfo *foo_info = tables.class_hierarchy->info(foo);
+        ASSERT(foo_info && foo_info->mro_count == 2 && !foo_info->unknown_base,
+               "");
+
+        std::string unused_name = "unused";
+        SymbolTableEntry *unused =
+                tables.symbol_table->lookup(unused_name, library_scope);
+        ASSERT(unused->lazy_declaration && !unused->lazy_declaration->typed,
+               "");
+
+        // typed declarations are remembered
+        scope_stack.clear();
+        scope_stack_push(&scope_stack, main_scope);
+        type_parse_tree(result.node, &ast_arena, &scope_stack, &tables,
+                        "tests");
+        ASSERT(tables.lazy_declarations->typed == 4,
+               tables.lazy_declarations->typed);
+
+        tables.lazy_declarations->destroy();
+        scope_stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+static AstNode *parse_function_for_fingerprint(Tables *tables,
+                                               Arena *ast_arena,
+                                               Arena *symbol_table_arena,
+                                               SymbolTableEntry *scope,
+                                               const char *source)
+{
+        InputStream input_stream = input_stream_create_from_string(source);
+        TokenArray token_array =
+                token_array_create_from_input_stream(ast_arena, &input_stream);
+
+        Parser parser = {};
+        parser.token_arr = &token_array;
+        parser.tables = tables;
+        parser.symbol_table_arena = symbol_table_arena;
+        parser.ast_arena = ast_arena;
+        parser.scope = scope;
+        ParseResult result = parse_statements(&parser);
+        if (result.error.type != ParseErrorType::NONE) {
+                return nullptr;
+        }
+
+        std::string name = "f";
+        SymbolTableEntry *function = tables->symbol_table->lookup(name, scope);
+        return function ? function->value.node : nullptr;
+}
+
+static Test body_fingerprint_test()
+{
+        START_TEST();
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Arena stack = Arena::init(sizeof(void *) * 1000);
+        Tables tables = Tables::init(&symbol_table_arena);
+
+        SymbolTableValue scope_value = {};
+        scope_value.node = &main_node;
+        const char *sources[] = {
+                "def f(a: int) -> int:\n"
+                "    return a + 1\n",
+                // moved down with a comment in the way
+                "x = 1\n"
+                "\n"
+                "# f\n"
+                "def f(a: int) -> int:\n"
+                "    return a + 1\n",
+                "def f(a: int) -> int:\n"
+                "    return a + 2\n",
+                "def f(a: int) -> int:\n"
+                "    return (a + 1)\n",
+                "def f(a: int) -> int:\n"
+                "    if a:\n"
+                "        return a\n"
+                "    return 1\n",
+                "def f(a: int) -> int:\n"
+                "    if a:\n"
+                "        pass\n"
+                "    return a\n"
+                "    return 1\n",
+        };
+        uint64_t fingerprints[array_count(sources)];
+        for (int i = 0; i < array_count(sources); ++i) {
+                std::string scope_name = "module" + std::to_string(i);
+                SymbolTableEntry *scope = tables.symbol_table->insert(
+                        &symbol_table_arena, scope_name, 0, &scope_value);
+                AstNode *function = parse_function_for_fingerprint(
+                        &tables, &ast_arena, &symbol_table_arena, scope,
+                        sources[i]);
+                ASSERT(function && function->type == AstNodeType::FUNCTION_DEF,
+                       i);
+                fingerprints[i] = body_fingerprint(function, &stack);
+        }
+
+        ASSERT(fingerprints[0] == fingerprints[1], "");
+        for (int i = 2; i < array_count(sources); ++i) {
+                ASSERT(fingerprints[i] != fingerprints[0], i);
+        }
+        // the same statements nested differently
+        ASSERT(fingerprints[4] != fingerprints[5], "");
+
+        stack.destroy();
+        ast_arena.destroy();
+        symbol_table_arena.destroy();
+
+        END_TEST();
+}
+
+// Two checked modules sharing a scope, rechecking one types again only the
+// bodies of either that read what the edit changed
+static Test pipeline_recheck_test()
+{
+        START_TEST();
+        const char *use_source = "class Derived(Base):\n"
+                                 "    pass\n"
+                                 "def use() -> int:\n"
+                                 "    y: str = limit\n"
+                                 "    return 1\n"
+                                 "def get() -> int:\n"
+                                 "    w: int = Derived.b\n"
+                                 "    return 1\n"
+                                 "def other() -> int:\n"
+                                 "    z: int = 2\n"
+                                 "    return z\n";
+        write_test_module("recheck_lib", "limit: int = 1\n"
+                                         "class Base:\n"
+                                         "    a: int = 1\n"
+                                         "def own() -> int:\n"
+                                         "    x: int = 1\n"
+                                         "    return x\n");
+        write_test_module("recheck_use", use_source);
+
+        Arena ast_arena = Arena::init(GIGABYTES(2));
+        Arena symbol_table_arena = Arena::init(GIGABYTES(1));
+        Tables tables = Tables::init(&symbol_table_arena);
+        tables.diagnostics->max_errors = 0;
+        SymbolTableEntry *main_scope =
+                declare_test_builtins(&tables, &symbol_table_arena);
+
+        PythonPath path = {};
+        test_module_path(&path);
+        Pipeline *pipeline = Pipeline::create(&ast_arena, &tables,
+                                              &symbol_table_arena, main_scope,
+                                              &main_node, &path, 1);
+        pipeline->incremental = true;
+
+        // the library first so the other module's class can derive from it
+        const char *lib_name = TEST_MODULE_DIRECTORY "recheck_lib.py";
+        const char *use_name = TEST_MODULE_DIRECTORY "recheck_use.py";
+        Module *lib = pipeline->submit(lib_name, lib_name, main_scope);
+        Module *use = pipeline->submit(use_name, use_name, main_scope);
+        pipeline->run();
+
+        ASSERT(lib->records.body_count == 1 && use->records.body_count == 3,
+               use->records.body_count);
+        record_signatures(lib, &tables);
+        record_signatures(use, &tables);
+
+        // y and Derived.b
+        ASSERT(tables.diagnostics->count == 2, tables.diagnostics->count);
+
+        // only own's body changed
+        write_test_module("recheck_lib", "limit: int = 1\n"
+                                         "class Base:\n"
+                                         "    a: int = 1\n"
+                                         "def own() -> int:\n"
+                                         "    x: int = 2\n"
+                                         "    return x\n");
+        RecheckStats stats = pipeline_recheck(pipeline, lib);
+        ASSERT(stats.changed_signatures == 0, stats.changed_signatures);
+        ASSERT(stats.body_count == 4, stats.body_count);
+        ASSERT(stats.bodies_typed == 1, stats.bodies_typed);
+        ASSERT(tables.diagnostics->count == 2, tables.diagnostics->count);
+
+        // limit's type changes and Base gains b, use reads limit and get
+        // reads Derived which derives from Base, other reads neither
+        write_test_module("recheck_lib", "limit: str = \"s\"\n"
+                                         "class Base:\n"
+                                         "    a: int = 1\n"
+                                         "    b: int = 2\n"
+                                         "def own() -> int:\n"
+                                         "    x: int = 2\n"
+                                         "    return x\n");
+        stats = pipeline_recheck(pipeline, lib);
+        ASSERT(stats.changed_signatures > 0, stats.changed_signatures);
+        ASSERT(stats.body_count == 4, stats.body_count);
+        ASSERT(stats.bodies_typed == 2, stats.bodies_typed);
+        ASSERT(tables.diagnostics->count == 0, tables.diagnostics->count);
+
+        pipeline->destroy();
+        symbol_table_arena.destroy();
+        ast_arena.destroy();
+        remove_test_module("recheck_lib");
+        remove_test_module("recheck_use");
+
+        END_TEST();
+}
+
 static Test assignment_test() {
 
 }
@@ -502,6 +3058,32 @@ int main()
         TEST(ifelse_test);
         TEST(functiondef_test);
         TEST(precedence_test)
+        TEST(deep_nesting_test)
+        TEST(diagnostics_test)
+        TEST(literal_display_test)
+        TEST(traversal_test)
+        TEST(serialize_test)
+        TEST(symbol_table_test)
+        TEST(symbol_table_threads_test)
+        TEST(symbol_table_lookup_during_insert_test)
+        TEST(resolve_test)
+        TEST(scopes_snapshot_test)
+        TEST(module_registry_test)
+        TEST(wave_schedule_test)
+        TEST(pipeline_order_test)
+        TEST(pipeline_release_test)
+        TEST(type_interner_test)
+        TEST(union_set_test)
+        TEST(subtype_cache_test)
+        TEST(class_hierarchy_test)
+        TEST(class_hierarchy_rebind_test)
+        TEST(two_phase_typing_test)
+        TEST(lazy_declaration_test)
+        TEST(body_fingerprint_test)
+        TEST(pipeline_recheck_test)
+        TEST(module_summary_test)
+        TEST(call_signature_test)
+        TEST(call_not_callable_test)
 #endif
 
         printf("ALL TESTS PASSED\n");
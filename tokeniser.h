@@ -17,6 +17,7 @@
 // and other tokens where it matters
 // TODO add from token
 #define TOKEN_TYPE(e, s)
+schema
 #define ALL_TOKEN_TYPES \
         TOKEN_TYPE(OR = 0, "or") \
         TOKEN_TYPE(AND = 1, "and") \
@@ -107,7 +108,7 @@ enum class TokenType {
 static const char *TOKEN_STRINGS[] = {ALL_TOKEN_TYPES};
 #undef TOKEN_TYPE
 
-struct Token {
+schema struct Token {
         enum TokenType type = TokenType::OR;
         uint32_t line = 0;
         uint32_t column = 0;
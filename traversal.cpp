@@ -0,0 +1,158 @@
+#include <stdint.h>
+#include <assert.h>
+
+#include "traversal.h"
+#include "debug.h"
+
+static PayloadDefinition *ast_node_payload(AstNodeType type)
+{
+        // the first entry is empty and stands in for anything out of range
+        if ((uint32_t)type >= array_count(AstNodeTypePayloads)) {
+                return &AstNodeTypePayloads[0];
+        }
+
+        return &AstNodeTypePayloads[(uint32_t)type];
+}
+
+// Every child link of a node, each one heads a list joined by adjacent_child.
+// All payloads share the address of the anonymous union in AstNode
+static uint32_t ast_node_child_slots(AstNode *node,
+                                     AstNode **slots[MAX_CHILD_SLOTS])
+{
+        PayloadDefinition *payload = ast_node_payload(node->type);
+        assert(payload->child_count <= MAX_CHILD_SLOTS);
+
+        for (uint32_t i = 0; i < payload->child_count; ++i) {
+                slots[i] = (AstNode **)((char *)&node->nary +
+                                        payload->child_offsets[i]);
+        }
+
+        return payload->child_count;
+}
+
+static inline void ast_visit_push(Arena *stack, AstNode *node, uint32_t depth)
+{
+        AstVisitFrame *frame = (AstVisitFrame *)stack->alloc(sizeof(*frame));
+        frame->node = node;
+        frame->depth = depth;
+}
+
+static inline void ast_visit_push_children(Arena *stack, AstNode *node,
+                                           uint32_t depth)
+{
+        AstNode **slots[MAX_CHILD_SLOTS];
+        uint32_t slot_count = ast_node_child_slots(node, slots);
+
+        // last slot first so the children come off the stack in order
+        for (uint32_t i = slot_count; i > 0; --i) {
+                if (*slots[i - 1]) {
+                        ast_visit_push(stack, *slots[i - 1], depth);
+                }
+        }
+}
+
+// Pre-order walk of root and everything below it but not root's siblings.
+// The stack arena is used from its current offset and left as it was, the
+// links of a node are read after visiting it so the visitor can rewrite them
+static void ast_visit(AstNode *root, Arena *stack, AstVisitFunc visit,
+                      void *user_data)
+{
+        if (!root) {
+                return;
+        }
+
+        uint64_t base = stack->offset;
+
+        if (visit(root, 0, user_data)) {
+                ast_visit_push_children(stack, root, 1);
+        }
+
+        while (stack->offset > base) {
+                stack->offset -= sizeof(AstVisitFrame);
+                AstVisitFrame frame =
+                        *(AstVisitFrame *)((char *)stack->memory + stack->offset);
+
+                bool visit_children = visit(frame.node, frame.depth, user_data);
+
+                // pushed first so the whole subtree is done before the sibling
+                if (frame.node->adjacent_child) {
+                        ast_visit_push(stack, frame.node->adjacent_child,
+                                       frame.depth);
+                }
+
+                if (visit_children) {
+                        ast_visit_push_children(stack, frame.node,
+                                                frame.depth + 1);
+                }
+        }
+}
+
+static bool ast_count_visit(AstNode *, uint32_t, void *user_data)
+{
+        ++*(uint64_t *)user_data;
+        return true;
+}
+
+static uint64_t ast_count_nodes(AstNode *root, Arena *stack)
+{
+        uint64_t count = 0;
+        ast_visit(root, stack, ast_count_visit, &count);
+
+        return count;
+}
+
+static inline void ast_copy_push(Arena *stack, AstNode *node, AstNode **link)
+{
+        AstCopyFrame *frame = (AstCopyFrame *)stack->alloc(sizeof(*frame));
+        frame->node = node;
+        frame->link = link;
+}
+
+// the copy still links to the original's children until they're copied
+static inline AstNode *ast_copy_node(AstNode *node, Arena *ast_arena,
+                                     Arena *stack)
+{
+        AstNode *copy = (AstNode *)ast_arena->alloc(sizeof(AstNode));
+        new (copy) AstNode(*node);
+
+        AstNode **slots[MAX_CHILD_SLOTS];
+        uint32_t slot_count = ast_node_child_slots(copy, slots);
+        for (uint32_t i = 0; i < slot_count; ++i) {
+                if (*slots[i]) {
+                        ast_copy_push(stack, *slots[i], slots[i]);
+                }
+        }
+
+        return copy;
+}
+
+// Deep copies root and everything below it into ast_arena, the copy has no
+// siblings. Types are copied as they are so copy before typing, a node
+// shared by two parents is copied twice
+static AstNode *ast_copy_tree(AstNode *root, Arena *ast_arena, Arena *stack)
+{
+        if (!root) {
+                return nullptr;
+        }
+
+        uint64_t base = stack->offset;
+
+        AstNode *copy = ast_copy_node(root, ast_arena, stack);
+        copy->adjacent_child = nullptr;
+
+        while (stack->offset > base) {
+                stack->offset -= sizeof(AstCopyFrame);
+                AstCopyFrame frame =
+                        *(AstCopyFrame *)((char *)stack->memory + stack->offset);
+
+                AstNode *node_copy = ast_copy_node(frame.node, ast_arena, stack);
+                *frame.link = node_copy;
+
+                if (frame.node->adjacent_child) {
+                        ast_copy_push(stack, frame.node->adjacent_child,
+                                      &node_copy->adjacent_child);
+                }
+        }
+
+        return copy;
+}
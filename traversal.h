@@ -0,0 +1,36 @@
+#ifndef TRAVERSAL_H_
+#define TRAVERSAL_H_
+
+#include <stdint.h>
+
+#include "meta.h"
+#include "utils.h"
+#include "parser.h"
+
+// no payload has more child links than a function definition
+#define MAX_CHILD_SLOTS 8
+
+// Called for each node before its children, returning false skips the
+// children but not the node's siblings
+typedef bool (*AstVisitFunc)(AstNode *node, uint32_t depth, void *user_data);
+
+struct AstVisitFrame {
+        AstNode *node;
+        uint32_t depth;
+};
+
+struct AstCopyFrame {
+        AstNode *node;
+        // where the copy of node is linked in
+        AstNode **link;
+};
+
+static PayloadDefinition *ast_node_payload(AstNodeType type);
+static uint32_t ast_node_child_slots(AstNode *node,
+                                     AstNode **slots[MAX_CHILD_SLOTS]);
+static void ast_visit(AstNode *root, Arena *stack, AstVisitFunc visit,
+                      void *user_data);
+static uint64_t ast_count_nodes(AstNode *root, Arena *stack);
+static AstNode *ast_copy_tree(AstNode *root, Arena *ast_arena, Arena *stack);
+
+#endif // TRAVERSAL_H_
@@ -13,12 +13,13 @@
 // TODO: inheritence
 // TODO: abstract classes / interfaces
 // TODO strict initilisation e.g. classes must be initilised before use variables too
-static void fail_typing_with_debug(AstNode *node, const char *message,
-                                   const char *filename)
+// Records the error and returns, the caller types the failing node as ANY so
+// checking carries on and the rest of the errors in the run are found
+static void fail_typing_with_debug(Tables *tables, AstNode *node,
+                                   const char *message, const char *filename)
 {
-        fprintf(stderr, "File: %s, TypeError: line: %d, col: %d\n%s", filename,
-                node->token.line, node->token.column, message);
-        exit(1);
+        tables->diagnostics->report(filename, node->token.line,
+                                    node->token.column, message);
 }
 
 static inline void scope_stack_push(Arena *scope_stack,
@@ -53,167 +54,200 @@ static bool static_type_is_num(TypeInfo type_info)
         }
 }
 
-static bool static_type_is_parameterised(TypeInfo type_info)
+// The id the subtype cache knows type by, 0 when it isn't interned
+static TypeId type_cache_id(Tables *tables, TypeInfo *type)
 {
-        if (type_info.type == TypeInfoType::CLASS)
-                return false;
-        if ((int)type_info.type >= (int)(TypeInfoType::LIST))
-                return true;
-        else
-                return false;
+        TypeInterner *interner = tables->type_interner;
+        if (type->type == TypeInfoType::UNION && type->union_type.left &&
+            type->union_type.right) {
+                return interner->id_of(interner->intern(type));
+        }
+
+        return interner->find(type);
 }
 
 // The order of arguments matters for union types
 // an annotation of [int | str] shouldn't match a list of [1, 1.0, "hello"] but
 // if the list is type is compared against the list the type will match the lists union type
-static bool static_types_is_rhs_equal_lhs(TypeInfo lhs, TypeInfo rhs)
+static bool static_types_is_rhs_equal_lhs(Tables *tables, TypeInfo lhs,
+                                          TypeInfo rhs)
 {
-        if (lhs.type == TypeInfoType::ANY || rhs.type == TypeInfoType::ANY)
-                return true;
-        if (lhs.type != rhs.type)
-                return false;
-
-        if (lhs.type == TypeInfoType::CLASS) {
-                if (lhs.class_type.custom_symbol ==
-                    rhs.class_type.custom_symbol) {
-                        return true;
-                }
+        // only parameterised types are worth the lookup
+        if (lhs.type < TypeInfoType::LIST || lhs.type != rhs.type ||
+            lhs.type == TypeInfoType::UNKNOWN) {
+                return static_types_compare_structurally(tables, lhs, rhs);
+        }
 
-                AstNode *lhs_class_node =
-                        lhs.class_type.custom_symbol->value.node;
-                AstNode *rhs_class_node =
-                        rhs.class_type.custom_symbol->value.node;
-                assert(lhs_class_node->type == AstNodeType::CLASS_DEF);
-                assert(rhs_class_node->type == AstNodeType::CLASS_DEF);
+        TypeId lhs_id = type_cache_id(tables, &lhs);
+        TypeId rhs_id = type_cache_id(tables, &rhs);
+        if (!lhs_id || !rhs_id) {
+                return static_types_compare_structurally(tables, lhs, rhs);
+        }
 
-                // check the rhs inherits from the left or implements the left
+        bool result;
+        if (tables->subtype_cache->find(lhs_id, rhs_id, &result)) {
+                return result;
+        }
 
-                AstNode *rhs_arg = rhs_class_node->class_def.arguments;
+        result = static_types_compare_structurally(tables, lhs, rhs);
+        tables->subtype_cache->insert(lhs_id, rhs_id, result);
 
-                while (rhs_arg) {
-                        assert(rhs_arg->static_type.type !=
-                               TypeInfoType::UNKNOWN);
-                        if (rhs_arg->static_type.type == TypeInfoType::CLASS &&
-                            rhs_arg->static_type.class_type.custom_symbol ==
-                                    lhs.class_type.custom_symbol)
-                                return true;
+        return result;
+}
 
+static bool static_types_compare_structurally(Tables *tables, TypeInfo lhs,
+                                              TypeInfo rhs)
+{
+        // nested list and dict types are walked in a loop instead of
+        // recursing once per level of nesting
+        while (true) {
+                if (lhs.type == TypeInfoType::ANY || rhs.type == TypeInfoType::ANY)
+                        return true;
+                if (lhs.type != rhs.type)
                         return false;
+                // interned types are the same when their children are
+                if (type_infos_are_identical(&lhs, &rhs))
+                        return true;
+
+                // the rhs is the same class as the left or derives from it
+                if (lhs.type == TypeInfoType::CLASS) {
+                        return tables->class_hierarchy->is_subclass(
+                                rhs.class_type.custom_symbol,
+                                lhs.class_type.custom_symbol);
                 }
-        }
 
-        if (lhs.type == TypeInfoType::UNION) {
-                TypeInfo visited_types_in_union[100] = {};
-                assert(lhs.union_type.left);
-                assert(lhs.union_type.right);
-                assert(rhs.union_type.left);
-                assert(rhs.union_type.right);
-                return unions_are_equal(lhs, rhs,
-                                        visited_types_in_union, 100);
-        }
+                if (lhs.type == TypeInfoType::UNION) {
+                        assert(lhs.union_type.left);
+                        assert(lhs.union_type.right);
+                        assert(rhs.union_type.left);
+                        assert(rhs.union_type.right);
+                        return union_types_are_equal(tables, lhs, rhs);
+                }
 
-        else if (lhs.type == TypeInfoType::LIST) {
-                return static_types_is_rhs_equal_lhs(
-                        *lhs.list.item_type, *rhs.list.item_type);
-        }
+                else if (lhs.type == TypeInfoType::LIST) {
+                        lhs = *lhs.list.item_type;
+                        rhs = *rhs.list.item_type;
+                }
 
-        else if (lhs.type == TypeInfoType::DICT) {
-                bool are_keys_same_type = static_types_is_rhs_equal_lhs(
-                        *lhs.dict.key_type, *rhs.dict.key_type);
-                bool are_vals_same_type = static_types_is_rhs_equal_lhs(
-                        *lhs.dict.val_type, *rhs.dict.val_type);
+                else if (lhs.type == TypeInfoType::DICT) {
+                        if (!static_types_is_rhs_equal_lhs(tables,
+                                                           *lhs.dict.key_type,
+                                                           *rhs.dict.key_type))
+                                return false;
 
-                return are_keys_same_type && are_vals_same_type;
-        }
+                        lhs = *lhs.dict.val_type;
+                        rhs = *rhs.dict.val_type;
+                }
 
-        else {
-                return true;
+                else {
+                        return true;
+                }
         }
 }
 
-// TODO bounds checks on lists
-static bool find_types_in_list(TypeInfo *list, size_t list_size,
-                                      TypeInfo type)
+// The members of an interned type, a type that isn't a union is its only
+// member
+struct UnionView {
+        uint32_t primitive_types;
+        const TypeId *members;
+        uint32_t member_count;
+        TypeId single;
+};
+
+static void union_view_of(TypeInterner *interner, TypeInfo *type,
+                          UnionView *view)
 {
-        for (int i = 0; i < list_size; ++i) {
-                if (static_types_is_rhs_equal_lhs(list[i], type))
-                        return true;
+        *view = {};
+
+        if (type->type == TypeInfoType::UNION) {
+                UnionSet *set = interner->union_set(interner->id_of(type));
+                view->primitive_types = set->primitive_types;
+                view->members = set->members;
+                view->member_count = set->member_count;
+        } else if (type->type < TypeInfoType::LIST) {
+                view->primitive_types = 1u << (int)type->type;
+        } else {
+                view->single = interner->id_of(type);
+                view->members = &view->single;
+                view->member_count = 1;
         }
-
-        return false;
 }
 
-static void traverse_union_and_populate_list(TypeInfo union_type,
-                                             TypeInfo *visited_list,
-                                             uint32_t *list_index)
+// every member of the union on the rhs has to match a member on the lhs.
+// Primitive members are one mask test, the rest are found by merging the
+// sorted ids and only the ones that aren't the same type on both sides are
+// compared structurally
+static bool union_types_are_equal(Tables *tables, TypeInfo lhs, TypeInfo rhs)
 {
-        if (union_type.type != TypeInfoType::UNION) {
-                visited_list[(*list_index)++] = union_type;
-                return;
-        }
+        TypeInterner *interner = tables->type_interner;
+        UnionView lhs_view;
+        UnionView rhs_view;
+        union_view_of(interner, interner->intern(&lhs), &lhs_view);
+        union_view_of(interner, interner->intern(&rhs), &rhs_view);
+
+        uint32_t any = 1u << (int)TypeInfoType::ANY;
+        if (lhs_view.primitive_types & any)
+                return true;
+        if (rhs_view.primitive_types & ~any & ~lhs_view.primitive_types)
+                return false;
 
-        if (union_type.union_type.left)
-                traverse_union_and_populate_list(*union_type.union_type.left,
-                                                 visited_list, list_index);
+        uint32_t l = 0;
+        for (uint32_t r = 0; r < rhs_view.member_count; ++r) {
+                TypeId member = rhs_view.members[r];
+                while (l < lhs_view.member_count && lhs_view.members[l] < member)
+                        ++l;
 
-        if (union_type.union_type.right)
-                traverse_union_and_populate_list(*union_type.union_type.right,
-                                                 visited_list, list_index);
-}
+                if (l < lhs_view.member_count && lhs_view.members[l] == member)
+                        continue;
 
-static bool compare_union_with_visited_list(TypeInfo union_type,
-                                            TypeInfo *visited_list,
-                                            uint32_t list_size)
-{
-        if (union_type.type != TypeInfoType::UNION) {
-                if (!find_types_in_list(visited_list, list_size, union_type)) {
-                        return false;
-                } else {
-                        return true;
+                bool matched = false;
+                for (uint32_t i = 0; i < lhs_view.member_count && !matched; ++i) {
+                        matched = static_types_is_rhs_equal_lhs(
+                                tables, *interner->get(lhs_view.members[i]),
+                                *interner->get(member));
                 }
-        }
-
-        if (!union_type.union_type.left) {
-                return compare_union_with_visited_list(
-                        *union_type.union_type.right, visited_list, list_size);
-        }
 
-        if (!union_type.union_type.right) {
-                return compare_union_with_visited_list(
-                        *union_type.union_type.left, visited_list, list_size);
+                if (!matched)
+                        return false;
         }
 
-        return compare_union_with_visited_list(*union_type.union_type.right,
-                                               visited_list, list_size) &&
-               compare_union_with_visited_list(*union_type.union_type.left,
-                                               visited_list, list_size);
+        return true;
 }
 
-// traverse the union on the lhs and make sure that there are no types on the
-// rhs union that do not appear on the left
-static bool unions_are_equal(TypeInfo lhs, TypeInfo rhs,
-                             TypeInfo *visited_list, size_t list_size)
+// Used get pointers to types that need to persist such as for the type inside
+// a list. They're interned so every list[int] shares one TypeInfo rather than
+// each getting its own copy
+static TypeInfo *type_intern(Tables *tables, TypeInfo type)
 {
-        uint32_t list_index = 0;
-        traverse_union_and_populate_list(lhs, visited_list, &list_index);
-        assert(list_index < list_size);
-        return compare_union_with_visited_list(rhs, visited_list, list_index);
+        return tables->type_interner->intern(&type);
 }
 
-// Used get pointers to types that need to persist such as for the type inside a list
-static TypeInfo *type_info_make_persistent(Arena *arena, Tables *tables,
-                                           TypeInfo type)
+// The union spine of a display is built in place as its elements are added,
+// once they all are it's interned from the innermost union out
+static TypeInfo *type_intern_union_spine(Tables *tables, TypeInfo *type)
 {
-        if (type.type == TypeInfoType::CLASS) {
-                return &type.class_type.custom_symbol->value.static_type;
-        } else if (static_type_is_parameterised(type)) {
-                TypeInfo *result =
-                        (TypeInfo *)arena->alloc(sizeof(*result));
-                *result = type;
-                return result;
-        } else {
-                return &tables->builtin_types[(int)type.type];
+        if (!type) {
+                return nullptr;
+        }
+
+        Arena *stack = tables->type_stack;
+        uint64_t base = stack->offset;
+        while (type->type == TypeInfoType::UNION) {
+                *(TypeInfo **)stack->alloc(sizeof(TypeInfo *)) = type;
+                type = type->union_type.right;
+        }
+
+        TypeInfo *interned = tables->type_interner->intern(type);
+        while (stack->offset > base) {
+                stack->offset -= sizeof(TypeInfo *);
+                TypeInfo spine =
+                        **(TypeInfo **)((char *)stack->memory + stack->offset);
+                spine.union_type.left = type_intern(tables, *spine.union_type.left);
+                spine.union_type.right = interned;
+                interned = tables->type_interner->intern(&spine);
         }
+
+        return interned;
 }
 
         //TODO implement for debugging
@@ -229,7 +263,7 @@ static TypeInfo **generate_union_and_update_type_to_unionise(
         Arena *arena, Tables *tables, TypeInfo prev_type,
         TypeInfo current_type, TypeInfo **type_to_unionise)
 {
-        if (!static_types_is_rhs_equal_lhs(prev_type, current_type)) {
+        if (!static_types_is_rhs_equal_lhs(tables, prev_type, current_type)) {
                 // alloc union
                 TypeInfo *prev_unionised_type = *type_to_unionise;
                 *type_to_unionise = (TypeInfo *)arena->alloc(sizeof(TypeInfo));
@@ -243,13 +277,11 @@ static TypeInfo **generate_union_and_update_type_to_unionise(
                                 prev_unionised_type->union_type.right;
                 } else {
                         (*type_to_unionise)->union_type.left =
-                                type_info_make_persistent(
-                                        arena, tables, prev_type);
+                                type_intern(tables, prev_type);
                 }
 
                 (*type_to_unionise)->union_type.right =
-                        type_info_make_persistent(arena, tables,
-                                                  current_type);
+                        type_intern(tables, current_type);
 
                 // update the type_to_unionse_ptr
                 type_to_unionise = &(*type_to_unionise)->union_type.right;
@@ -274,32 +306,66 @@ static bool node_type_is_callable(AstNode *node) {
         }
 }
 
-static bool find_symbol_definition_and_type(Arena *scope_stack,
-                                            AstNode *node,
-                                            SymbolTable *symbol_table)
+// a symbol of a module checked on demand has its declaration typed the
+// first time it's read
+static inline TypeInfo symbol_static_type(Tables *tables,
+                                          SymbolTableEntry *symbol)
 {
-        SymbolTableEntry *result = nullptr;
-
-        for (int i = (scope_stack->offset / sizeof(SymbolTableEntry *)) - 1;
-             i >= 0; --i) {
-                assert(scope_stack->offset % sizeof(SymbolTableEntry *) == 0);
-                if (result) {
-                        break;
-                }
+        LazyDeclaration *declaration = symbol->lazy_declaration;
+        if (declaration && !declaration->typed) {
+                type_declaration_on_demand(tables, symbol);
+        }
 
-                result = symbol_table->lookup(
-                        node->token.value,
-                        ((SymbolTableEntry **)(scope_stack->memory))[i]);
+        if (tables->symbol_reads) {
+                SymbolTableEntry **read = (SymbolTableEntry **)
+                        tables->symbol_reads->alloc(sizeof(*read));
+                *read = symbol;
         }
 
+        return symbol->value.static_type;
+}
+
+static bool find_symbol_definition_and_type(Arena *scope_stack,
+                                            AstNode *node,
+                                            Tables *tables)
+{
+        assert(scope_stack->offset % sizeof(SymbolTableEntry *) == 0);
+        SymbolTableEntry *result = tables->symbol_table->lookup_in_scopes(
+                node->token.value, (SymbolTableEntry **)scope_stack->memory,
+                scope_stack->offset / sizeof(SymbolTableEntry *));
+
         if (result) {
-                node->static_type = result->value.static_type;
+                node->identifier.symbol = result;
+                node->static_type = symbol_static_type(tables, result);
                 return true;
         } else {
                 return false;
         }
 }
 
+// The scope of the module name is bound to by an import, null if it isn't
+// or the module isn't checked on demand. Only "import a" and "import a.b as
+// c" bind a name to the module itself
+static SymbolTableEntry *imported_module_scope(AstNode *name)
+{
+        if (name->type != AstNodeType::IDENTIFIER || !name->identifier.symbol) {
+                return nullptr;
+        }
+
+        AstNode *import_target = name->identifier.symbol->value.node;
+        if (!import_target || import_target->type != AstNodeType::IMPORT_TARGET) {
+                return nullptr;
+        }
+
+        AstNodeImportTarget *target = &import_target->import_target;
+        AstNode *bound = target->as ? target->as : target->dotted_name;
+        if (bound->type == AstNodeType::BINARYEXPR) {
+                return nullptr;
+        }
+
+        return target->module;
+}
+
 // required since funcitions have their own type we want to check their return value
 static bool is_any_type(TypeInfo type_info) {
         if (type_info.type == TypeInfoType::FUNCTION) {
@@ -317,44 +383,844 @@ static bool is_any_type(TypeInfo type_info) {
         return false;
 }
 
-static int type_parse_tree(AstNode *node, Arena *parse_arena,
-                           Arena *scope_stack, Tables *tables,
-                           const char *filename)
+static void type_unary_expression(AstNode *node)
+{
+        AstNode *child = node->unary.child;
+
+        if (child)
+                node->static_type = child->static_type;
+        else
+                node->static_type.type = TypeInfoType::NONE;
+}
+
+static void type_binary_expression(AstNode *node, Tables *tables,
+                                   const char *filename)
+{
+        AstNode *left = node->binary.left;
+        AstNode *right = node->binary.right;
+
+        node->static_type.type = TypeInfoType::BOOLEAN;
+
+        if (node->token.is_comparrison_op()) {
+                if (static_types_is_rhs_equal_lhs(tables, left->static_type,
+                                                  right->static_type)) {
+                        return;
+                }
+
+                else if (static_type_is_num(left->static_type) &&
+                         static_type_is_num(right->static_type)) {
+                        return;
+                }
+
+                fail_typing_with_debug(tables, node,
+                                       "Can't compare different types",
+                                       filename);
+                return;
+        }
+
+        switch (node->token.type) {
+        case TokenType::FLOOR_DIV:
+                if (!static_type_is_num(left->static_type) ||
+                    !static_type_is_num(right->static_type)) {
+                        fail_typing_with_debug(
+                                tables, node, "Mismatched Types in expression",
+                                filename);
+                        node->static_type.type = TypeInfoType::ANY;
+                        break;
+                }
+
+                node->static_type.type = TypeInfoType::INTEGER;
+                break;
+
+        case TokenType::DIVISION:
+                if (!static_type_is_num(left->static_type) ||
+                    !static_type_is_num(right->static_type)) {
+                        fail_typing_with_debug(
+                                tables, node, "Mismatched Types in expression",
+                                filename);
+                        node->static_type.type = TypeInfoType::ANY;
+                        break;
+                }
+
+                node->static_type.type = TypeInfoType::FLOAT;
+                break;
+
+        default:
+                if (left->static_type.type == right->static_type.type) {
+                        node->static_type = right->static_type;
+                } else if (static_type_is_num(left->static_type) &&
+                           static_type_is_num(right->static_type)) {
+                        if (left->static_type.type == TypeInfoType::FLOAT ||
+                            right->static_type.type == TypeInfoType::FLOAT) {
+                                node->static_type.type = TypeInfoType::FLOAT;
+                        } else {
+                                node->static_type.type = TypeInfoType::INTEGER;
+                        }
+                }
+        }
+}
+
+// Literal terminals are typed straight from their token type without going
+// through the symbol table or the work stack
+static bool literal_token_to_type(TokenType token_type, TypeInfoType *type)
+{
+        switch (token_type) {
+        case TokenType::INT_LIT:
+                *type = TypeInfoType::INTEGER;
+                return true;
+        case TokenType::FLOAT_LIT:
+                *type = TypeInfoType::FLOAT;
+                return true;
+        case TokenType::STRING_LIT:
+                *type = TypeInfoType::STRING;
+                return true;
+        case TokenType::BOOL_TRUE:
+        case TokenType::BOOL_FALSE:
+                *type = TypeInfoType::BOOLEAN;
+                return true;
+        case TokenType::NONE:
+                *type = TypeInfoType::NONE;
+                return true;
+        default:
+                return false;
+        }
+}
+
+static bool type_literal(AstNode *node)
+{
+        if (node->type != AstNodeType::TERMINAL)
+                return false;
+
+        TypeInfoType type;
+        if (!literal_token_to_type(node->token.type, &type))
+                return false;
+
+        node->static_type.type = type;
+        return true;
+}
+
+// Builds the item type of one kind of element in a display. Literal elements
+// only set a bit in a mask so a display of thousands of literals of a few
+// types makes one union node per distinct type, everything else goes through
+// the general union builder
+struct DisplayTypeBuilder {
+        TypeInfo *result;
+        TypeInfo **type_to_modify;
+        TypeInfo *prev_type;
+        // bit per non parameterised TypeInfoType
+        uint32_t literal_types;
+        uint32_t general_types;
+};
+
+static void display_type_add_element(DisplayTypeBuilder *builder,
+                                     Arena *parse_arena, Tables *tables,
+                                     AstNode *element, TypeInfo *element_type)
+{
+        if (element->type == AstNodeType::TERMINAL) {
+                TypeInfoType literal_type;
+                if (literal_token_to_type(element->token.type, &literal_type)) {
+                        builder->literal_types |= 1u << (int)literal_type;
+                        return;
+                }
+        }
+
+        if (element_type->type < TypeInfoType::LIST)
+                builder->general_types |= 1u << (int)element_type->type;
+
+        if (!builder->prev_type) {
+                builder->type_to_modify = &builder->result;
+                builder->result = element_type;
+        } else {
+                builder->type_to_modify =
+                        generate_union_and_update_type_to_unionise(
+                                parse_arena, tables, *builder->prev_type,
+                                *element_type, builder->type_to_modify);
+        }
+
+        builder->prev_type = element_type;
+}
+
+static TypeInfo *display_type_finish(DisplayTypeBuilder *builder,
+                                     Arena *parse_arena, Tables *tables)
+{
+        uint32_t literal_types = builder->literal_types & ~builder->general_types;
+
+        for (int i = 0; literal_types; ++i, literal_types >>= 1) {
+                if (!(literal_types & 1))
+                        continue;
+
+                TypeInfo *literal_type = &tables->builtin_types[i];
+                if (!builder->prev_type) {
+                        builder->type_to_modify = &builder->result;
+                        builder->result = literal_type;
+                } else {
+                        builder->type_to_modify =
+                                generate_union_and_update_type_to_unionise(
+                                        parse_arena, tables,
+                                        *builder->prev_type, *literal_type,
+                                        builder->type_to_modify);
+                }
+
+                builder->prev_type = literal_type;
+        }
+
+        return type_intern_union_spine(tables, builder->result);
+}
+
+static void type_dict_display(AstNode *node, Arena *parse_arena,
+                              Tables *tables)
+{
+        node->static_type.type = TypeInfoType::DICT;
+        AstNode *child = node->nary.children;
+
+        if (!child) {
+                node->static_type.dict.key_type =
+                        &tables->builtin_types[(int)TypeInfoType::ANY];
+                node->static_type.dict.val_type =
+                        &tables->builtin_types[(int)TypeInfoType::ANY];
+                return;
+        }
+
+        DisplayTypeBuilder key_builder = {};
+        DisplayTypeBuilder val_builder = {};
+
+        // union types together that are not the same
+        while (child) {
+                display_type_add_element(&key_builder, parse_arena, tables,
+                                         child->kvpair.key,
+                                         child->static_type.kvpair.key_type);
+                display_type_add_element(&val_builder, parse_arena, tables,
+                                         child->kvpair.value,
+                                         child->static_type.kvpair.val_type);
+                child = child->adjacent_child;
+        }
+
+        node->static_type.dict.key_type =
+                display_type_finish(&key_builder, parse_arena, tables);
+        node->static_type.dict.val_type =
+                display_type_finish(&val_builder, parse_arena, tables);
+
+        child = node->nary.children;
+        // update every child in the list to the final union type
+        while (child) {
+                child->static_type.kvpair.key_type =
+                        node->static_type.dict.key_type;
+                child->static_type.kvpair.val_type =
+                        node->static_type.dict.val_type;
+                child = child->adjacent_child;
+        }
+
+        assert(node->static_type.dict.key_type != nullptr);
+        assert(node->static_type.dict.val_type != nullptr);
+}
+
+static void type_list_display(AstNode *node, Arena *parse_arena,
+                              Tables *tables)
+{
+        node->static_type.type = TypeInfoType::LIST;
+        AstNode *child = node->nary.children;
+
+        if (!child) {
+                node->static_type.list.item_type =
+                        &tables->builtin_types[(int)TypeInfoType::ANY];
+                return;
+        }
+
+        // essentially an iterative implementation of reccursively generating a union
+        // tree like structure based on wether or not the last type is
+        // equal to the current one if they are not then create union and
+        // move the ptr to the right branch
+        //
+        // TODO i dont like this it feels hacky i think there is a better way to do it
+        DisplayTypeBuilder builder = {};
+        while (child) {
+                display_type_add_element(&builder, parse_arena, tables, child,
+                                         &child->static_type);
+                child = child->adjacent_child;
+        }
+
+        node->static_type.list.item_type =
+                display_type_finish(&builder, parse_arena, tables);
+
+        child = node->nary.children;
+        while (child) {
+                child->static_type = *node->static_type.list.item_type;
+                child = child->adjacent_child;
+        }
+
+        assert(node->static_type.list.item_type != nullptr);
+}
+
+static void type_attribute_ref(AstNode *node, Tables *tables,
+                               const char *filename)
+{
+        AstNode *attribute = node->attribute_ref.attribute;
+        AstNode *name = node->attribute_ref.name;
+
+        SymbolTableEntry *module = imported_module_scope(name);
+
+        // if any we can't know if the name is a valid attribute ref
+        if (!module && is_any_type(name->static_type)) {
+                attribute->static_type.type = TypeInfoType::ANY;
+                return;
+        }
+
+        // find symbol in the module, or in the class or the classes it
+        // inherits from
+        SymbolTableEntry *result =
+                module ? tables->symbol_table->lookup_member(
+                                 attribute->token.value, module) :
+                         tables->class_hierarchy->lookup_member(
+                                 tables->symbol_table, attribute->token.value,
+                                 name->static_type.class_type.custom_symbol);
+
+        if (!result) {
+                char buffer[1024];
+                snprintf(buffer, sizeof(buffer),
+                         "Cannot resolve name %s in attribute reference for %s",
+                         attribute->token.value.c_str(),
+                         name->token.value.c_str());
+                fail_typing_with_debug(tables, name, buffer, filename);
+                attribute->static_type.type = TypeInfoType::ANY;
+                node->static_type = attribute->static_type;
+                return;
+        }
+
+        attribute->static_type = symbol_static_type(tables, result);
+        node->static_type = attribute->static_type;
+}
+
+static bool node_is_typed_with_stack(AstNode *node)
+{
+        switch (node->type) {
+        case AstNodeType::UNARY:
+        case AstNodeType::BINARYEXPR:
+        case AstNodeType::UNION:
+        case AstNodeType::ATTRIBUTE_REF:
+        case AstNodeType::KVPAIR:
+        case AstNodeType::LIST:
+        case AstNodeType::DICT:
+                return true;
+        default:
+                return false;
+        }
+}
+
+static inline void type_work_item_push(Arena *type_stack, AstNode *node)
 {
         if (!node) {
-                return 0;
+                return;
         }
 
+        // literal children are typed in place, for large literal displays
+        // this skips a push, pop and dispatch per element
+        if (type_literal(node))
+                return;
+
+        TypeWorkItem *item =
+                (TypeWorkItem *)type_stack->alloc(sizeof(*item));
+        item->node = node;
+        item->children_pushed = false;
+}
+
+static inline TypeWorkItem *type_work_item_peek(Arena *type_stack)
+{
+        return (TypeWorkItem *)((char *)type_stack->memory +
+                                type_stack->offset - sizeof(TypeWorkItem));
+}
+
+static inline void type_work_item_pop(Arena *type_stack)
+{
+        type_stack->offset -= sizeof(TypeWorkItem);
+}
+
+// types a node from the already typed types of its children
+static void type_expression_node(AstNode *node, Arena *parse_arena,
+                                 Tables *tables, const char *filename)
+{
         switch (node->type) {
-        case AstNodeType::TERMINAL: {
-                enum TokenType token_type = node->token.type;
-                if (token_type == TokenType::INT_LIT) {
-                        node->static_type.type = TypeInfoType::INTEGER;
+        case AstNodeType::UNARY:
+                type_unary_expression(node);
+                break;
+
+        case AstNodeType::BINARYEXPR:
+                type_binary_expression(node, tables, filename);
+                break;
+
+        case AstNodeType::UNION:
+                node->static_type.type = TypeInfoType::UNION;
+                node->static_type.union_type.left =
+                        type_intern(tables, node->union_type.left->static_type);
+                node->static_type.union_type.right =
+                        type_intern(tables, node->union_type.right->static_type);
+                break;
+
+        case AstNodeType::ATTRIBUTE_REF:
+                type_attribute_ref(node, tables, filename);
+                break;
+
+        case AstNodeType::KVPAIR:
+                node->static_type.type = TypeInfoType::KVPAIR;
+                node->static_type.kvpair.key_type =
+                        type_intern(tables, node->kvpair.key->static_type);
+                node->static_type.kvpair.val_type =
+                        type_intern(tables, node->kvpair.value->static_type);
+                break;
+
+        case AstNodeType::LIST:
+                type_list_display(node, parse_arena, tables);
+                break;
+
+        case AstNodeType::DICT:
+                type_dict_display(node, parse_arena, tables);
+                break;
+
+        default:
+                break;
+        }
+}
+
+static void type_expression_with_stack(AstNode *root, Arena *parse_arena,
+                                       Arena *scope_stack, Tables *tables,
+                                       const char *filename)
+{
+        Arena *type_stack = tables->type_stack;
+        uint64_t base = type_stack->offset;
+        type_work_item_push(type_stack, root);
+
+        while (type_stack->offset > base) {
+                TypeWorkItem *item = type_work_item_peek(type_stack);
+                AstNode *node = item->node;
+
+                if (!node_is_typed_with_stack(node)) {
+                        type_work_item_pop(type_stack);
+                        type_parse_tree(node, parse_arena, scope_stack, tables,
+                                        filename);
+                        continue;
+                }
+
+                if (!item->children_pushed) {
+                        item->children_pushed = true;
+                        uint64_t first_child = type_stack->offset;
+
+                        switch (node->type) {
+                        case AstNodeType::UNARY:
+                                type_work_item_push(type_stack, node->unary.child);
+                                break;
+                        case AstNodeType::BINARYEXPR:
+                                type_work_item_push(type_stack, node->binary.left);
+                                type_work_item_push(type_stack, node->binary.right);
+                                break;
+                        case AstNodeType::UNION:
+                                type_work_item_push(type_stack, node->union_type.left);
+                                type_work_item_push(type_stack, node->union_type.right);
+                                break;
+                        case AstNodeType::ATTRIBUTE_REF:
+                                type_work_item_push(type_stack, node->attribute_ref.name);
+                                break;
+                        case AstNodeType::KVPAIR:
+                                type_work_item_push(type_stack, node->kvpair.key);
+                                type_work_item_push(type_stack, node->kvpair.value);
+                                break;
+                        default: {
+                                AstNode *child = node->nary.children;
+                                while (child) {
+                                        type_work_item_push(type_stack, child);
+                                        child = child->adjacent_child;
+                                }
+                        } break;
+                        }
+
+                        // children were pushed in source order, reverse them so
+                        // they are popped and typed left to right
+                        TypeWorkItem *low = (TypeWorkItem *)((char *)type_stack->memory +
+                                                             first_child);
+                        TypeWorkItem *high = type_work_item_peek(type_stack);
+                        while (low < high) {
+                                TypeWorkItem temp = *low;
+                                *low++ = *high;
+                                *high-- = temp;
+                        }
+
+                        continue;
+                }
+
+                type_work_item_pop(type_stack);
+                type_expression_node(node, parse_arena, tables, filename);
+        }
+}
+
+// The parameters, their annotations and defaults, and the return type, all
+// a call needs from the function without looking at its body
+static void type_function_signature(AstNode *node,
+                                    SymbolTableEntry *function_symbol,
+                                    Arena *parse_arena, Arena *scope_stack,
+                                    Tables *tables, const char *filename)
+{
+        scope_stack_push(scope_stack, function_symbol);
+        for (AstNode *argument = node->function_def.arguments; argument;
+             argument = argument->adjacent_child) {
+                type_parse_tree(argument, parse_arena, scope_stack, tables,
+                                filename);
+        }
+        scope_stack_pop(scope_stack);
+
+        TypeInfoFunction *function =
+                &function_symbol->value.static_type.function;
+        function->custom_symbol = function_symbol;
+
+        AstNode *return_type = node->function_def.return_type;
+        if (!return_type) {
+                function->return_type =
+                        &tables->builtin_types[(int)TypeInfoType::ANY];
+                return;
+        }
+
+        type_parse_tree(return_type, parse_arena, scope_stack, tables,
+                        filename);
+        function->return_type = type_intern(tables, return_type->static_type);
+}
+
+// First of the two passes over a module, records the signatures of its
+// functions and methods and binds its classes so the bodies typed after can
+// use anything the module declares wherever it's declared
+static void type_signatures(AstNode *root, Arena *parse_arena,
+                            Arena *scope_stack, Tables *tables,
+                            const char *filename)
+{
+        if (!root) {
+                return;
+        }
+
+        assert(root->type == AstNodeType::FILE ||
+               root->type == AstNodeType::BLOCK);
+
+        for (AstNode *child = root->file.children; child;
+             child = child->adjacent_child) {
+                if (child->type == AstNodeType::FUNCTION_DEF) {
+                        SymbolTableEntry *function_symbol =
+                                tables->symbol_table->lookup(
+                                        child->function_def.name->token.value,
+                                        scope_stack_peek(scope_stack));
+                        type_function_signature(child, function_symbol,
+                                                parse_arena, scope_stack,
+                                                tables, filename);
+                } else if (child->type == AstNodeType::CLASS_DEF) {
+                        SymbolTableEntry *class_scope =
+                                tables->symbol_table->lookup(
+                                        child->class_def.name->token.value,
+                                        scope_stack_peek(scope_stack));
+
+                        scope_stack_push(scope_stack, class_scope);
+                        for (AstNode *argument = child->class_def.arguments;
+                             argument; argument = argument->adjacent_child) {
+                                type_parse_tree(argument, parse_arena,
+                                                scope_stack, tables, filename);
+                        }
+                        tables->class_hierarchy->info(class_scope);
+
+                        type_signatures(child->class_def.block, parse_arena,
+                                        scope_stack, tables, filename);
+                        scope_stack_pop(scope_stack);
+                }
+        }
+}
+
+// Attaches a LazyDeclaration to everything root declares that can be
+// reached from another module, its functions, classes, annotated names and
+// the same inside its classes. Nothing is typed until it's looked up
+static void declare_lazily(AstNode *root, SymbolTableEntry *scope,
+                           Arena *arena, Tables *tables, const char *filename)
+{
+        if (!root) {
+                return;
+        }
+
+        assert(root->type == AstNodeType::FILE ||
+               root->type == AstNodeType::BLOCK);
+
+        for (AstNode *child = root->file.children; child;
+             child = child->adjacent_child) {
+                AstNode *name;
+                if (child->type == AstNodeType::FUNCTION_DEF) {
+                        name = child->function_def.name;
+                } else if (child->type == AstNodeType::CLASS_DEF) {
+                        name = child->class_def.name;
+                } else if (child->type == AstNodeType::DECLARATION) {
+                        name = child->declaration.name;
+                } else {
+                        continue;
+                }
 
-                } else if (token_type == TokenType::FLOAT_LIT) {
-                        node->static_type.type = TypeInfoType::FLOAT;
+                SymbolTableEntry *symbol =
+                        tables->symbol_table->lookup(name->token.value, scope);
 
-                } else if (token_type == TokenType::STRING_LIT) {
-                        node->static_type.type = TypeInfoType::STRING;
+                // annotated attribute targets have no symbol, a redefinition
+                // keeps the first
+                if (!symbol || symbol->lazy_declaration) {
+                        continue;
+                }
 
-                } else if (token_type == TokenType::BOOL_TRUE ||
-                           token_type == TokenType::BOOL_FALSE) {
+                LazyDeclaration *declaration =
+                        (LazyDeclaration *)arena->alloc(sizeof(LazyDeclaration));
+                new (declaration) LazyDeclaration();
+                declaration->node = child;
+                declaration->scope = scope;
+                declaration->arena = arena;
+                declaration->filename = filename;
+                symbol->lazy_declaration = declaration;
+                InterlockedIncrement(&tables->lazy_declarations->declared);
+
+                if (child->type == AstNodeType::CLASS_DEF) {
+                        declare_lazily(child->class_def.block, symbol, arena,
+                                       tables, filename);
+                }
+        }
+}
 
-                        node->static_type.type = TypeInfoType::BOOLEAN;
+// Types what a lookup needs from the symbol's declaration, a function's
+// signature, a class's bases or a name's annotation. Bodies and initial
+// values aren't checked
+static void type_declaration_on_demand(Tables *tables, SymbolTableEntry *symbol)
+{
+        LazyDeclaration *declaration = symbol->lazy_declaration;
+        LazyDeclarations *lazy = tables->lazy_declarations;
+
+        // the type stack is per thread so it tells whether this thread
+        // already holds the lock
+        bool reentered = lazy->owner == tables->type_stack;
+        if (!reentered) {
+                AcquireSRWLockExclusive(&lazy->lock);
+                lazy->owner = tables->type_stack;
+        }
 
-                } else if (token_type == TokenType::NONE) {
-                        node->static_type.type = TypeInfoType::NONE;
+        if (!declaration->typed && !declaration->typing &&
+            lazy->depth < LAZY_MAX_DEPTH) {
+                declaration->typing = true;
 
+                // builtins then the scopes from the module's down to the
+                // declaration's, walked innermost first
+                Arena *scope_stack = &lazy->scope_stacks[lazy->depth++];
+                scope_stack->clear();
+                scope_stack_push(scope_stack, lazy->builtins);
+
+                uint64_t base = scope_stack->offset;
+                for (SymbolTableEntry *scope = declaration->scope; scope;
+                     scope = scope->key.scope) {
+                        scope_stack_push(scope_stack, scope);
+                }
+
+                SymbolTableEntry **scopes =
+                        (SymbolTableEntry **)((char *)scope_stack->memory +
+                                              base);
+                uint64_t count = (scope_stack->offset - base) /
+                                 sizeof(SymbolTableEntry *);
+                for (uint64_t i = 0; i < count / 2; ++i) {
+                        SymbolTableEntry *scope = scopes[i];
+                        scopes[i] = scopes[count - 1 - i];
+                        scopes[count - 1 - i] = scope;
                 }
+
+                AstNode *node = declaration->node;
+                const char *filename = declaration->filename;
+                switch (node->type) {
+                case AstNodeType::FUNCTION_DEF: {
+                        type_function_signature(node, symbol,
+                                                declaration->arena,
+                                                scope_stack, tables, filename);
+                } break;
+
+                case AstNodeType::CLASS_DEF: {
+                        scope_stack_push(scope_stack, symbol);
+                        for (AstNode *argument = node->class_def.arguments;
+                             argument; argument = argument->adjacent_child) {
+                                type_parse_tree(argument, declaration->arena,
+                                                scope_stack, tables, filename);
+                        }
+                        tables->class_hierarchy->info(symbol);
+                } break;
+
+                case AstNodeType::DECLARATION: {
+                        AstNode *annotation = node->declaration.annotation;
+                        type_parse_tree(annotation, declaration->arena,
+                                        scope_stack, tables, filename);
+                        symbol->value.static_type = annotation->static_type;
+                } break;
+
+                default:
+                        break;
+                }
+
+                --lazy->depth;
+                declaration->typing = false;
+                InterlockedExchange(&declaration->typed, 1);
+                InterlockedIncrement(&lazy->typed);
+        }
+
+        if (!reentered) {
+                lazy->owner = nullptr;
+                ReleaseSRWLockExclusive(&lazy->lock);
+        }
+}
+
+// Types a call's arguments and matches them to the parameters in one pass,
+// positional arguments take the parameters in order and a keyword is found
+// by its atom. Each parameter given a value has its bit set, a required one
+// left unset is missing. Without a signature the arguments are only typed
+static void type_call_arguments(AstNode *call, CallSignature *signature,
+                                bool bound, Arena *parse_arena,
+                                Arena *scope_stack, Tables *tables,
+                                const char *filename)
+{
+        Arena *stack = tables->type_stack;
+        uint64_t base = stack->offset;
+        uint64_t *assigned = nullptr;
+        uint32_t position = 0;
+
+        if (signature) {
+                assigned = (uint64_t *)stack->alloc(signature->required_words *
+                                                    sizeof(uint64_t));
+                memset(assigned, 0, signature->required_words * sizeof(uint64_t));
+
+                if (signature->method && signature->parameter_count &&
+                    (bound || signature->class_method)) {
+                        assigned[0] |= 1;
+                        position = 1;
+                }
+        }
+
+        // an unpacked argument could give a value to any parameter
+        bool unpacked = false;
+        char msg[1024];
+        int i = 1;
+        for (AstNode *argument = call->function_call.args; argument;
+             argument = argument->adjacent_child, ++i) {
+                type_parse_tree(argument, parse_arena, scope_stack, tables,
+                                filename);
+
+                if (!signature) {
+                        continue;
+                }
+
+                uint32_t index;
+                if (argument->type == AstNodeType::STARRED) {
+                        unpacked = true;
+                        continue;
+                } else if (argument->type == AstNodeType::KWARG) {
+                        std::string &name = argument->kwarg.name->token.value;
+                        index = signature->keyword_index(
+                                tables->symbol_table->find_atom(name));
+
+                        // **kwargs takes whatever doesn't name a parameter
+                        if (index == UINT32_MAX) {
+                                if (!signature->double_star) {
+                                        snprintf(msg, sizeof(msg),
+                                                 "Unexpected keyword argument %s in call",
+                                                 name.c_str());
+                                        fail_typing_with_debug(tables, argument,
+                                                               msg, filename);
+                                }
+                                continue;
+                        }
+
+                        if (index < signature->positional_only_count) {
+                                if (!signature->double_star) {
+                                        snprintf(msg, sizeof(msg),
+                                                 "Positional only argument %s passed by keyword in call",
+                                                 name.c_str());
+                                        fail_typing_with_debug(tables, argument,
+                                                               msg, filename);
+                                }
+                                continue;
+                        }
+                } else {
+                        // *args takes whatever is left over
+                        if (position >= signature->keyword_only_index) {
+                                if (!signature->star) {
+                                        fail_typing_with_debug(
+                                                tables, argument,
+                                                "Number of positional arguments don't match in call",
+                                                filename);
+                                }
+                                continue;
+                        }
+
+                        index = position++;
+                }
+
+                uint64_t bit = 1ull << (index % 64);
+                if (assigned[index / 64] & bit) {
+                        snprintf(msg, sizeof(msg),
+                                 "Multiple values for argument %s in call",
+                                 tables->symbol_table->atoms
+                                         .get(signature->parameter_atoms[index])
+                                         ->chars);
+                        fail_typing_with_debug(tables, argument, msg, filename);
+                        continue;
+                }
+                assigned[index / 64] |= bit;
+
+                if (!static_types_is_rhs_equal_lhs(
+                            tables, *signature->parameter_types[index],
+                            argument->static_type)) {
+                        snprintf(msg, sizeof(msg),
+                                 "argument at position %d doesnt match type in function definition",
+                                 i);
+                        fail_typing_with_debug(tables, argument, msg, filename);
+                }
+        }
+
+        // only the first missing parameter is reported
+        for (uint32_t word = 0;
+             signature && !unpacked && word < signature->required_words;
+             ++word) {
+                uint64_t missing = signature->required[word] & ~assigned[word];
+                if (!missing) {
+                        continue;
+                }
+
+                uint32_t index = word * 64;
+                for (; !(missing & 1); missing >>= 1) {
+                        ++index;
+                }
+
+                snprintf(msg, sizeof(msg), "Missing argument %s in call",
+                         tables->symbol_table->atoms
+                                 .get(signature->parameter_atoms[index])
+                                 ->chars);
+                fail_typing_with_debug(tables, call, msg, filename);
+                break;
+        }
+
+        stack->offset = base;
+}
+
+static int type_parse_tree(AstNode *node, Arena *parse_arena,
+                           Arena *scope_stack, Tables *tables,
+                           const char *filename)
+{
+        if (!node) {
+                return 0;
+        }
+
+        switch (node->type) {
+        case AstNodeType::TERMINAL: {
+                type_literal(node);
         } break;
         case AstNodeType::IDENTIFIER: {
-                if (!find_symbol_definition_and_type(scope_stack, node,
-                                                tables->symbol_table)) {
+                // bound ahead of time by resolve_names, anything it couldn't
+                // bind still searches the scope stack
+                if (node->identifier.symbol) {
+                        node->static_type = symbol_static_type(
+                                tables, node->identifier.symbol);
+                } else if (!find_symbol_definition_and_type(scope_stack, node,
+                                                            tables)) {
                         char buffer[1024];
                         snprintf(buffer, sizeof(buffer),
                                 "No valid identifier %s",
                                 node->token.value.c_str());
-                        fail_typing_with_debug(node, buffer, filename);
+                        fail_typing_with_debug(tables, node, buffer, filename);
+                        node->static_type.type = TypeInfoType::ANY;
                 }
         } break;
 
@@ -368,8 +1234,10 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 if (node->static_type.type == TypeInfoType::LIST) {
                         if (!parameter || parameter->adjacent_child) {
                                 fail_typing_with_debug(
-                                        node,
+                                        tables, node,
                                         "list type annotation accepts exactly 1 type parameter", filename);
+                                node->static_type.type = TypeInfoType::ANY;
+                                break;
                         }
 
                         type_parse_tree(parameter,
@@ -377,22 +1245,21 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                                         tables, filename);
 
                         node->static_type.list.item_type =
-                                &parameter->static_type;
+                                type_intern(tables, parameter->static_type);
                 } else if (node->static_type.type == TypeInfoType::DICT) {
 
                         AstNode *key_param = parameter;
-                        AstNode *val_param = parameter->adjacent_child;
-
-                        if (!key_param || !val_param) {
-                                fprintf(stderr,
-                                        "TypeError: Dict Type annotation takes exactly 2 type parameters");
-                                exit(1);
-                        }
+                        AstNode *val_param =
+                                parameter ? parameter->adjacent_child : nullptr;
 
-                        if (val_param->adjacent_child) {
-                                fprintf(stderr,
-                                        "TypeError: Dict Type annotation takes exactly 2 type parameters");
-                                exit(1);
+                        if (!key_param || !val_param ||
+                            val_param->adjacent_child) {
+                                fail_typing_with_debug(
+                                        tables, node,
+                                        "Dict Type annotation takes exactly 2 type parameters",
+                                        filename);
+                                node->static_type.type = TypeInfoType::ANY;
+                                break;
                         }
 
                         type_parse_tree(key_param, parse_arena, scope_stack,
@@ -401,9 +1268,9 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                                         tables, filename);
 
                         node->static_type.dict.key_type =
-                                &key_param->static_type;
+                                type_intern(tables, key_param->static_type);
                         node->static_type.dict.val_type =
-                                &val_param->static_type;
+                                type_intern(tables, val_param->static_type);
                 } else {
                         while (parameter) {
                                 type_parse_tree(parameter, parse_arena,
@@ -415,14 +1282,8 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
         } break;
 
         case AstNodeType::UNARY: {
-                AstNode *child = node->unary.child;
-                type_parse_tree(child, parse_arena, scope_stack, tables,
-                                filename);
-
-                if (child)
-                        node->static_type = child->static_type;
-                else
-                        node->static_type.type = TypeInfoType::NONE;
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
 
                 if (node->token.type == TokenType::RETURN)
                         return 1;
@@ -430,69 +1291,8 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
         } break;
 
         case AstNodeType::BINARYEXPR: {
-                AstNode *left = node->binary.left;
-                AstNode *right = node->binary.right;
-
-                type_parse_tree(left, parse_arena, scope_stack, tables, filename);
-                type_parse_tree(right, parse_arena, scope_stack, tables, filename);
-
-                node->static_type.type = TypeInfoType::BOOLEAN;
-
-                if (node->token.is_comparrison_op()) {
-                        if (static_types_is_rhs_equal_lhs(
-                                    left->static_type, right->static_type)) {
-                                return 0;
-                        }
-
-                        else if (static_type_is_num(left->static_type) &&
-                                 static_type_is_num(right->static_type)) {
-                                return 0;
-                        }
-
-                        fail_typing_with_debug(node,
-                                               "Can't compare different types",
-                                               filename);
-                }
-
-                switch (node->token.type) {
-                case TokenType::FLOOR_DIV:
-                        if (!static_type_is_num(left->static_type) ||
-                            !static_type_is_num(right->static_type))
-                                fail_typing_with_debug(
-                                        node, "Mismatched Types in expression",
-                                        filename);
-
-                        node->static_type.type = TypeInfoType::INTEGER;
-                        break;
-
-                case TokenType::DIVISION:
-                        if (!static_type_is_num(left->static_type) ||
-                            !static_type_is_num(right->static_type))
-                                fail_typing_with_debug(
-                                        node, "Mismatched Types in expression",
-                                        filename);
-
-                        node->static_type.type = TypeInfoType::FLOAT;
-                        break;
-
-                default:
-                        if (left->static_type.type == right->static_type.type) {
-                                node->static_type = right->static_type;
-                        } else if (static_type_is_num(left->static_type) &&
-                                   static_type_is_num(right->static_type)) {
-                                if (left->static_type.type ==
-                                            TypeInfoType::FLOAT ||
-                                    right->static_type.type ==
-                                            TypeInfoType::FLOAT) {
-                                        node->static_type.type =
-                                                TypeInfoType::FLOAT;
-                                } else {
-                                        node->static_type.type =
-                                                TypeInfoType::INTEGER;
-                                }
-                        }
-                }
-
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
         } break;
 
         case AstNodeType::NARY: {
@@ -521,40 +1321,39 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                                 node->function_def.name->token.value,
                                 scope_stack_peek(scope_stack));
 
-                scope_stack_push(scope_stack, function_symbol);
-                type_parse_tree(node->function_def.arguments, parse_arena,
-                                scope_stack, tables, filename);
+                // recorded ahead of time by type_signatures unless the
+                // function is somewhere it doesn't look
+                if (!function_symbol->value.static_type.function.return_type) {
+                        type_function_signature(node, function_symbol,
+                                                parse_arena, scope_stack,
+                                                tables, filename);
+                }
+
+                if (tables->deferred_bodies) {
+                        DeferredBody *body = (DeferredBody *)
+                                tables->deferred_bodies->alloc(
+                                        sizeof(DeferredBody));
+                        body->function_def = node;
+                        body->scope = scope_stack_peek(scope_stack);
+                        return 0;
+                }
 
+                scope_stack_push(scope_stack, function_symbol);
                 int return_flag = type_parse_tree(node->function_def.block,
                                                   parse_arena, scope_stack,
                                                   tables, filename);
-
                 scope_stack_pop(scope_stack);
 
                 AstNode *return_type = node->function_def.return_type;
-                if (!return_type) {
-                        function_symbol->value.static_type.function
-                                .custom_symbol = function_symbol;
-                        function_symbol->value.static_type.function.return_type =
-                                &tables->builtin_types[(int)TypeInfoType::ANY];
-
-                        return return_flag;
-                }
-
-
-                type_parse_tree(return_type, parse_arena,
-                                scope_stack, tables, filename);
-
-                if (!static_types_is_rhs_equal_lhs(
-                            return_type->static_type,
+                if (return_type &&
+                    !static_types_is_rhs_equal_lhs(
+                            tables, return_type->static_type,
                             node->function_def.block->static_type))
                         fail_typing_with_debug(
-                                node,
+                                tables, node,
                                 "Function definition block must match annotated return type in all paths",
                                 filename);
 
-                function_symbol->value.static_type.function.return_type = &return_type->static_type;
-
                 return return_flag;
 
         } break;
@@ -563,101 +1362,15 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 break;
 
         case AstNodeType::DICT: {
-                node->static_type.type = TypeInfoType::DICT;
-                AstNode *child = node->nary.children;
-                TypeInfo **key_type_to_modify =
-                        &node->static_type.dict.key_type;
-                TypeInfo **val_type_to_modify =
-                        &node->static_type.dict.val_type;
-                // find the correct type for the collection
-                type_parse_tree(child, parse_arena, scope_stack, tables,
-                                filename);
-
-                TypeInfo *prev_key_type = child->static_type.kvpair.key_type;
-                TypeInfo *prev_val_type = child->static_type.kvpair.val_type;
-
-                *key_type_to_modify = child->static_type.kvpair.key_type;
-                *val_type_to_modify = child->static_type.kvpair.val_type;
-                child = child->adjacent_child;
-
-                // union types together that are not the same
-                while (child) {
-                        type_parse_tree(child, parse_arena, scope_stack, tables,
-                                        filename);
-
-                        TypeInfo *child_key_type =
-                                child->static_type.kvpair.key_type;
-                        TypeInfo *child_val_type =
-                                child->static_type.kvpair.val_type;
-
-                        key_type_to_modify =
-                                generate_union_and_update_type_to_unionise(
-                                        parse_arena, tables, *prev_key_type,
-                                        *child_key_type, key_type_to_modify);
-
-                        val_type_to_modify =
-                                generate_union_and_update_type_to_unionise(
-                                        parse_arena, tables, *prev_val_type,
-                                        *child_val_type, val_type_to_modify);
-
-                        prev_key_type = child_key_type;
-                        prev_val_type = child_val_type;
-                        child = child->adjacent_child;
-                }
-
-                child = node->nary.children;
-                // update every child in the list to the final union type
-                while (child) {
-                        child->static_type.kvpair.key_type =
-                                node->static_type.dict.key_type;
-                        child->static_type.kvpair.val_type =
-                                node->static_type.dict.val_type;
-                        child = child->adjacent_child;
-                }
-
-                assert(node->static_type.dict.key_type != nullptr);
-                assert(node->static_type.dict.val_type != nullptr);
-
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
         } break;
 
         case AstNodeType::DICTCOMP:
                 break;
         case AstNodeType::LIST: {
-                node->static_type.type = TypeInfoType::LIST;
-                AstNode *child = node->nary.children;
-                TypeInfo **type_to_modify = &node->static_type.list.item_type;
-
-                type_parse_tree(child, parse_arena, scope_stack, tables,
-                                filename);
-
-                TypeInfo *prev_type = &child->static_type;
-                *type_to_modify = &child->static_type;
-                child = child->adjacent_child;
-                // essentially an iterative implementation of reccursively generating a union
-                // tree like structure based on wether or not the last type is
-                // equal to the current one if they are not then create union and
-                // move the ptr to the right branch
-                //
-                // TODO i dont like this it feels hacky i think there is a better way to do it
-                while (child) {
-                        type_parse_tree(child, parse_arena, scope_stack, tables,
-                                        filename);
-                        type_to_modify =
-                                generate_union_and_update_type_to_unionise(
-                                        parse_arena, tables, *prev_type,
-                                        child->static_type, type_to_modify);
-
-                        prev_type = &child->static_type;
-                        child = child->adjacent_child;
-                }
-
-                child = node->nary.children;
-                while (child) {
-                        child->static_type = *node->static_type.list.item_type;
-                        child = child->adjacent_child;
-                }
-
-                assert(node->static_type.list.item_type != nullptr);
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
         } break;
 
         case AstNodeType::LISTCOMP:
@@ -672,9 +1385,9 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                                 scope_stack, tables, filename);
 
                 if (!static_types_is_rhs_equal_lhs(
-                            node->assignment.expression->static_type,
+                            tables, node->assignment.expression->static_type,
                             node->assignment.left->static_type))
-                        fail_typing_with_debug(node,
+                        fail_typing_with_debug(tables, node,
                                                "Mismatched types in assignment",
                                                filename);
 
@@ -699,10 +1412,10 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                                 }
 
                                 if (!static_types_is_rhs_equal_lhs(
-                                            node->static_type,
+                                            tables, node->static_type,
                                             child->static_type)) {
                                         fail_typing_with_debug(
-                                                node,
+                                                tables, node,
                                                 "Block must have same return type in all paths",
                                                 filename);
                                 }
@@ -730,10 +1443,10 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                         //
                         //TODO put this into function call
                         if (!static_types_is_rhs_equal_lhs(
-                                    annotation->static_type,
+                                    tables, annotation->static_type,
                                     expression->static_type))
                                 fail_typing_with_debug(
-                                        annotation,
+                                        tables, annotation,
                                         "Declaration expression must match annotated type",
                                         filename);
                 }
@@ -742,7 +1455,10 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                         node->declaration.name->token.value,
                         scope_stack_peek(scope_stack));
 
-                entry->value.static_type = annotation->static_type;
+                // annotated attribute targets e.g. "a.b: int" have no entry
+                if (entry)
+                        entry->value.static_type = annotation->static_type;
+
                 node->static_type = annotation->static_type;
 
         } break;
@@ -767,11 +1483,11 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 }
 
                 if (!static_types_is_rhs_equal_lhs(
-                            node->static_type,
+                            tables, node->static_type,
                             node->if_stmt.or_else->static_type))
                         fail_typing_with_debug(
-                                node,
-                                "In if statement branch, all branches must have the same return type\n",
+                                tables, node,
+                                "In if statement branch, all branches must have the same return type",
                                 filename);
 
                 return return_flag;
@@ -804,11 +1520,11 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 }
 
                 if (!static_types_is_rhs_equal_lhs(
-                            node->static_type,
+                            tables, node->static_type,
                             node->while_loop.or_else->static_type)) {
                         fail_typing_with_debug(
-                                node->while_loop.or_else,
-                                "In while else branch, all branches must have the same return type\n", filename);
+                                tables, node->while_loop.or_else,
+                                "In while else branch, all branches must have the same return type", filename);
                 }
 
                 return return_flag;
@@ -834,8 +1550,24 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
 
                 scope_stack_push(scope_stack, class_scope);
 
-                type_parse_tree(node->class_def.arguments, parse_arena,
-                                scope_stack, tables, filename);
+                for (AstNode *argument = node->class_def.arguments; argument;
+                     argument = argument->adjacent_child) {
+                        type_parse_tree(argument, parse_arena, scope_stack,
+                                        tables, filename);
+                }
+
+                // bound once the bases are typed
+                ClassInfo *class_info =
+                        tables->class_hierarchy->info(class_scope);
+                if (class_info && class_info->inconsistent) {
+                        char msg[1024];
+                        snprintf(msg, sizeof(msg),
+                                 "Cannot create a consistent method resolution order for class %s",
+                                 node->class_def.name->token.value.c_str());
+                        fail_typing_with_debug(tables, node->class_def.name,
+                                               msg, filename);
+                }
+
                 type_parse_tree(node->class_def.block, parse_arena, scope_stack,
                                 tables, filename);
 
@@ -849,8 +1581,6 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 type_parse_tree(node->function_call.expression, parse_arena,
                                 scope_stack, tables, filename);
 
-                AstNode *call_arg = node->function_call.args;
-
                 SymbolTableEntry *function_symbol;
                 AstNode *expression_node = node->function_call.expression;
                 TypeInfo expression_type = expression_node->static_type;
@@ -864,21 +1594,19 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                                 expression_node =
                                         expression_node->attribute_ref.attribute;
                                 expression_type = expression_node->static_type;
-                        } else if (expression_node->type ==
-                                   AstNodeType::SLICE) {
-                                // need to extract node based off slice type
                         } else {
-                                // not a callable object
+                                // not a callable object, a subscript is
+                                // already typed as the item it selects
                                 char msg[1024];
                                 snprintf(msg, sizeof(msg),
                                          "Object of type %s is not callable",
                                          debug_enum_to_string(
-                                                 AstNodeTypeEnumMembers,
-                                                 (int)node->function_call
-                                                         .expression->type));
+                                                 TypeInfoTypeEnumMembers,
+                                                 (int)expression_type.type));
                                 fail_typing_with_debug(
-                                        node->function_call.expression, msg,
-                                        filename);
+                                        tables, node->function_call.expression,
+                                        msg, filename);
+                                expression_type.type = TypeInfoType::ANY;
                         }
                 }
 
@@ -928,40 +1656,35 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 assert(expression_type.type == TypeInfoType::FUNCTION ||
                        expression_type.type == TypeInfoType::CLASS);
 
-                AstNode *function_node = function_symbol->value.node;
-                AstNode *definition_arg = function_node->function_def.arguments;
-
-                int i = 1;
-                //TODO find definitions for base clas callable in abc.py
-                while (call_arg && definition_arg) {
-                        type_parse_tree(call_arg, parse_arena, scope_stack,
-                                        tables, filename);
-
-                        if (!static_types_is_rhs_equal_lhs(
-                                    definition_arg->static_type,
-                                    call_arg->static_type)) {
-                                fprintf_s(
-                                        stderr,
-                                        "TypeError: line: %d, col: %d in function call arguments\n"
-                                        "argument at position %d doesnt match type in function definition",
-                                        call_arg->token.line,
-                                        call_arg->token.column, i);
-                                exit(1);
+                // a class is called through its __init__ with self bound to
+                // the new instance, a method called through an attribute has
+                // self bound unless it's looked up on the class itself
+                bool bound = false;
+                AstNode *callee = node->function_call.expression;
+                if (expression_type.type == TypeInfoType::CLASS) {
+                        std::string init = "__init__";
+                        function_symbol = tables->class_hierarchy->lookup_member(
+                                tables->symbol_table, init, function_symbol);
+                        if (function_symbol) {
+                                symbol_static_type(tables, function_symbol);
                         }
-
-                        call_arg = call_arg->adjacent_child;
-                        definition_arg = definition_arg->adjacent_child;
-                        ++i;
+                        bound = true;
+                } else if (callee->type == AstNodeType::ATTRIBUTE_REF) {
+                        AstNode *object = callee->attribute_ref.name;
+                        SymbolTableEntry *object_symbol =
+                                object->type == AstNodeType::IDENTIFIER ?
+                                        object->identifier.symbol :
+                                        nullptr;
+                        bound = !object_symbol || !object_symbol->value.node ||
+                                object_symbol->value.node->type !=
+                                        AstNodeType::CLASS_DEF;
                 }
 
-                if (definition_arg) 
-                        fail_typing_with_debug(
-                                definition_arg,
-                                "Number of positional arguments don't match in call", filename);
-                if (call_arg)
-                        fail_typing_with_debug(
-                                call_arg,
-                                "Number of positional arguments don't match in call", filename);
+                CallSignature *signature = tables->call_signatures->signature(
+                        tables->symbol_table, tables->type_interner,
+                        function_symbol);
+                type_call_arguments(node, signature, bound, parse_arena,
+                                    scope_stack, tables, filename);
 
                 node->static_type = node->function_call.expression->static_type;
 
@@ -983,9 +1706,9 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
 
                 if (subscript_expr->token.value == "list") {
                         node->static_type = subscript_expr->static_type;
-                        node->static_type.list.item_type =
-                                &node->subscript.slices->slice.named_expr
-                                         ->static_type;
+                        node->static_type.list.item_type = type_intern(
+                                tables, node->subscript.slices->slice.named_expr
+                                                ->static_type);
                 } else if (subscript_expr->token.value == "dict") {
                         AstNode *key_expr =
                                 node->subscript.slices->slice.named_expr;
@@ -993,9 +1716,9 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
 
                         node->static_type = subscript_expr->static_type;
                         node->static_type.dict.key_type =
-                                &key_expr->static_type;
+                                type_intern(tables, key_expr->static_type);
                         node->static_type.dict.val_type =
-                                &val_expr->static_type;
+                                type_intern(tables, val_expr->static_type);
 
                 } else if (subscript_expr->static_type.type ==
                            TypeInfoType::LIST) {
@@ -1009,36 +1732,8 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
         } break;
 
         case AstNodeType::ATTRIBUTE_REF: {
-                type_parse_tree(node->attribute_ref.name, parse_arena,
-                                scope_stack, tables, filename);
-
-                AstNode *attribute = node->attribute_ref.attribute;
-                AstNode *name = node->attribute_ref.name;
-
-                // if any we can't know if the name is a valid attribute ref
-                if (is_any_type(name->static_type)) {
-                        attribute->static_type.type = TypeInfoType::ANY;
-                        return 0;
-                }
-
-                // find symbol in class
-                SymbolTableEntry *result = tables->symbol_table->lookup(
-                        attribute->token.value,
-                        name->static_type.class_type.custom_symbol);
-
-                if (!result) {
-                        char buffer[1024];
-                        snprintf(
-                                buffer, sizeof(buffer),
-                                "Cannot resolve name %s in attribute reference for %s",
-                                attribute->token.value.c_str(),
-                                name->token.value.c_str());
-                        fail_typing_with_debug(name, buffer, filename);
-                }
-
-                attribute->static_type = result->value.static_type;
-                node->static_type = attribute->static_type;
-
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
         } break;
 
         case AstNodeType::TRY:
@@ -1048,16 +1743,13 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
         case AstNodeType::STARRED:
                 break;
         case AstNodeType::KVPAIR: {
-                node->static_type.type = TypeInfoType::KVPAIR;
-                type_parse_tree(node->kvpair.key, parse_arena, scope_stack,
-                                tables, filename);
-                type_parse_tree(node->kvpair.value, parse_arena, scope_stack,
-                                tables, filename);
-
-                node->static_type.kvpair.key_type =
-                        &node->kvpair.key->static_type;
-                node->static_type.kvpair.val_type =
-                        &node->kvpair.value->static_type;
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
+        } break;
+        case AstNodeType::KWARG: {
+                type_parse_tree(node->kwarg.expression, parse_arena,
+                                scope_stack, tables, filename);
+                node->static_type = node->kwarg.expression->static_type;
         } break;
         case AstNodeType::IMPORT:
                 break;
@@ -1075,17 +1767,8 @@ static int type_parse_tree(AstNode *node, Arena *parse_arena,
                 break;
 
         case AstNodeType::UNION: {
-                type_parse_tree(node->union_type.left, parse_arena, scope_stack,
-                                tables, filename);
-                type_parse_tree(node->union_type.right, parse_arena,
-                                scope_stack, tables, filename);
-
-                node->static_type.type = TypeInfoType::UNION;
-                node->static_type.union_type.left =
-                        &node->union_type.left->static_type;
-                node->static_type.union_type.right =
-                        &node->union_type.right->static_type;
-
+                type_expression_with_stack(node, parse_arena, scope_stack,
+                                           tables, filename);
         } break;
 
         case AstNodeType::RAISE: {
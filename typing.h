@@ -66,27 +66,61 @@ introspect struct TypeInfoFunction {
         SymbolTableEntry *custom_symbol;
 };
 
-struct TypeInfo {
+// Index of a type interned by TypeInterner plus one, 0 is no type
+typedef uint32_t TypeId;
+
+schema struct TypeInfo {
         TypeInfoType type;
 
         union {
-                TypeInfoList list;
-                TypeInfoUnion union_type;
-                TypeInfoDict dict;
-                TypeInfoKVpair kvpair;
-                TypeInfoClass class_type;
-                TypeInfoFunction function;
+                payload(TypeInfoType::LIST) TypeInfoList list;
+                payload(TypeInfoType::UNION) TypeInfoUnion union_type;
+                payload(TypeInfoType::DICT) TypeInfoDict dict;
+                payload(TypeInfoType::KVPAIR) TypeInfoKVpair kvpair;
+                payload(TypeInfoType::CLASS) TypeInfoClass class_type;
+                payload(TypeInfoType::FUNCTION) TypeInfoFunction function;
         };
 
         TypeInfo *next;
 };
 
+// Expression subtrees (operator chains, unions, nested list and dict
+// displays) are typed in post order from an explicit stack instead of
+// recursing once per level
+struct TypeWorkItem {
+        AstNode *node;
+        bool children_pushed;
+};
+
+// A function body left to be typed later, scope is the one the function is
+// declared in
+struct DeferredBody {
+        AstNode *function_def;
+        SymbolTableEntry *scope;
+};
+
 static bool is_num_type(TypeInfo type_info);
 static int type_parse_tree(AstNode *node, Arena *parse_arena,
                            Arena *scope_stack, Tables *tables,
                            const char *filename);
-static bool unions_are_equal(TypeInfo union_a, TypeInfo union_b,
-                             TypeInfo *visited_list, size_t list_size);
-static bool static_types_is_rhs_equal_lhs(TypeInfo lhs, TypeInfo rhs);
+static void type_function_signature(AstNode *node,
+                                    SymbolTableEntry *function_symbol,
+                                    Arena *parse_arena, Arena *scope_stack,
+                                    Tables *tables, const char *filename);
+static void type_signatures(AstNode *root, Arena *parse_arena,
+                            Arena *scope_stack, Tables *tables,
+                            const char *filename);
+static void declare_lazily(AstNode *root, SymbolTableEntry *scope,
+                           Arena *arena, Tables *tables, const char *filename);
+static void type_declaration_on_demand(Tables *tables,
+                                       SymbolTableEntry *symbol);
+static bool union_types_are_equal(Tables *tables, TypeInfo lhs, TypeInfo rhs);
+static bool static_types_is_rhs_equal_lhs(Tables *tables, TypeInfo lhs,
+                                          TypeInfo rhs);
+static bool static_types_compare_structurally(Tables *tables, TypeInfo lhs,
+                                              TypeInfo rhs);
+static void type_expression_with_stack(AstNode *root, Arena *parse_arena,
+                                       Arena *scope_stack, Tables *tables,
+                                       const char *filename);
 
 #endif // TYPING_H_